@@ -67,6 +67,13 @@ struct UTF8
 		}
 	};
 
+	/// \brief Get the table mapping the first UTF-8 character byte to the length of the character in bytes
+	static const CharLengthTab& charLengthTab()
+	{
+		static const CharLengthTab rt;
+		return rt;
+	}
+
 	/// \brief Get the size of the current character in bytes (variable length encoding)
 	/// \param [in] buf buffer for the character data
 	/// \param [in,out] bufpos position in 'buf'
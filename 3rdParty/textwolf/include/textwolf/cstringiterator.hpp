@@ -72,6 +72,22 @@ public:
 		return *this;
 	}
 
+	/// \brief Get the bytes of the string from the current position on
+	/// \param [out] size number of bytes available
+	/// \return pointer to the current position
+	inline const char* span( std::size_t& size) const
+	{
+		size = (m_pos < m_size)?(m_size - m_pos):0;
+		return m_src + m_pos;
+	}
+
+	/// \brief Skip a number of bytes (not more than returned by span(std::size_t&))
+	/// \param [in] n number of bytes to skip
+	inline void advance( std::size_t n)
+	{
+		m_pos += n;
+	}
+
 	/// \brief Return current char position
 	inline unsigned int pos() const	{return m_pos;}
 
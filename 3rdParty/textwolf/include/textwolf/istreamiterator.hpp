@@ -143,6 +143,30 @@ public:
 		return *this;
 	}
 
+	/// \brief Get the bytes read into the buffer from the current position on
+	/// \param [out] size number of bytes available without reading from the stream
+	/// \return pointer to the current position
+	inline const char* span( std::size_t& size) const
+	{
+		size = (m_readpos < m_readsize)?(m_readsize - m_readpos):0;
+		return m_buf + m_readpos;
+	}
+
+	/// \brief Skip a number of bytes (not more than returned by span(std::size_t&))
+	/// \param [in] n number of bytes to skip
+	inline void advance( std::size_t n)
+	{
+		if (n == 0) return;
+		if (m_readpos+n >= m_readsize)
+		{
+			fillbuf();
+		}
+		else
+		{
+			m_readpos += n;
+		}
+	}
+
 	int operator - (const IStreamIterator& o) const
 	{
 		return (int)m_readpos - o.m_readpos;
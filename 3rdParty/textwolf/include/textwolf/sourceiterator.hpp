@@ -83,6 +83,22 @@ public:
 		return *this;
 	}
 
+	/// \brief Get the bytes of the current chunk from the current position on
+	/// \param [out] size number of bytes available
+	/// \return pointer to the current position
+	inline const char* span( std::size_t& size) const
+	{
+		size = (m_end > m_itr)?(m_end - m_itr):0;
+		return m_itr;
+	}
+
+	/// \brief Skip a number of bytes (not more than returned by span(std::size_t&))
+	/// \param [in] n number of bytes to skip
+	inline void advance( std::size_t n)
+	{
+		m_itr += n;
+	}
+
 	/// \brief Get the iterator difference in bytes
 	inline std::size_t operator-( const SrcIterator& b) const
 	{
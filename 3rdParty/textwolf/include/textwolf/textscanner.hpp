@@ -30,6 +30,13 @@ struct Traits<char*>
 	{
 		return itr-start;
 	}
+	static inline const char* span( char const*, std::size_t& size)
+	{
+		size = 0;
+		return 0;
+	}
+	static inline void advance( char*&, std::size_t)
+	{}
 };
 
 template <>
@@ -39,6 +46,14 @@ struct Traits<SrcIterator>
 	{
 		return itr.position();
 	}
+	static inline const char* span( const SrcIterator& itr, std::size_t& size)
+	{
+		return itr.span( size);
+	}
+	static inline void advance( SrcIterator& itr, std::size_t n)
+	{
+		itr.advance( n);
+	}
 };
 
 template <>
@@ -48,6 +63,14 @@ struct Traits<IStreamIterator>
 	{
 		return itr.position();
 	}
+	static inline const char* span( const IStreamIterator& itr, std::size_t& size)
+	{
+		return itr.span( size);
+	}
+	static inline void advance( IStreamIterator& itr, std::size_t n)
+	{
+		itr.advance( n);
+	}
 };
 
 template <>
@@ -57,6 +80,14 @@ struct Traits<CStringIterator>
 	{
 		return itr.pos();
 	}
+	static inline const char* span( const CStringIterator& itr, std::size_t& size)
+	{
+		return itr.span( size);
+	}
+	static inline void advance( CStringIterator& itr, std::size_t n)
+	{
+		itr.advance( n);
+	}
 };
 
 
@@ -213,13 +244,40 @@ public:
 		}
 	}
 
+	/// \brief Get the map of ASCII characters to control character identifiers
+	static const ControlCharMap& controlCharMap()
+	{
+		static const ControlCharMap rt;
+		return rt;
+	}
+
 	/// \brief Get the control character representation of the current character
 	/// \return the control character
 	inline ControlCharacter control()
 	{
-		static ControlCharMap controlCharMap;
+		static const ControlCharMap& controlCharMap_ = controlCharMap();
 		getcur();
-		return controlCharMap[ (unsigned char)cur];
+		return controlCharMap_[ (unsigned char)cur];
+	}
+
+	/// \brief Get the bytes of the source from the current position on that are available without reading ahead
+	/// \param [out] size number of bytes available, 0 if the current character has already been read partially or if the source iterator does not provide access to its buffer
+	/// \return pointer to the current position
+	inline const char* span( std::size_t& size) const
+	{
+		if (state)
+		{
+			size = 0;
+			return 0;
+		}
+		return Traits<Iterator>::span( input, size);
+	}
+
+	/// \brief Skip a number of bytes of the source returned by span(std::size_t&)
+	/// \param [in] n number of bytes to skip
+	inline void skipspan( std::size_t n)
+	{
+		Traits<Iterator>::advance( input, n);
 	}
 
 	/// \brief Get the ASCII character representation of the current character
@@ -321,6 +321,26 @@ public:
 		}
 	}
 
+	/// \brief Check if elements of a type can be selected in the scope of the last tag opened or in its descendant scopes
+	/// \param[in] typemask bit mask of the element types to check (bit (1<<type) set for every XMLScannerBase::ElementType checked)
+	/// \return true if a waiting token of the scope or a token active in all descendant scopes matches one of the types
+	/// \remark This function works only if called after iterating through the result with the iterator created with XMLPathSelect::push(..) for an OpenTag
+	/// \note This function is a helper function for skipping the subtrees of a document without any elements selected
+	bool scopeSelects( unsigned short typemask) const
+	{
+		std::size_t ti = context.scope.range.tokenidx_to, te = tokens.size();
+		for (; ti<te; ++ti)
+		{
+			if ((tokens[ ti].core.mask.pos & typemask) != 0) return true;
+		}
+		ti = 0; te = follows.size();
+		for (; ti<te; ++ti)
+		{
+			if ((tokens[ follows[ ti]].core.mask.pos & typemask) != 0) return true;
+		}
+		return false;
+	}
+
 public:
 	/// \brief Constructor
 	/// \param[in] p_atm read only ML path select automaton reference
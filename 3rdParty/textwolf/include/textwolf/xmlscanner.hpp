@@ -14,9 +14,11 @@
 #include "textwolf/charset_interface.hpp"
 #include "textwolf/exception.hpp"
 #include "textwolf/textscanner.hpp"
+#include "textwolf/charset_utf8.hpp"
 #include "textwolf/traits.hpp"
 #include <map>
 #include <cstddef>
+#include <cstring>
 
 namespace textwolf {
 
@@ -510,6 +512,84 @@ private:
 		copychar_impl( traits::TypeCheck::is_same<InputCharSet,OutputCharSet>::type());
 	}
 
+	/// \brief Get the length of the longest prefix of a span of UTF-8 source bytes consisting of complete characters of a token
+	/// \param [in] isTok set of valid token characters
+	/// \param [in] acceptAmp true if '&' is accepted as token character too (entities are not parsed)
+	/// \param [in] acceptEoln true if end of line characters are accepted, false if the span ends before them (end of line translation)
+	/// \param [in] src pointer to the span
+	/// \param [in] size size of the span in bytes
+	/// \return the length of the prefix in bytes
+	static std::size_t utf8TokenSpanLength( const IsTokenCharMap& isTok, bool acceptAmp, bool acceptEoln, const char* src, std::size_t size)
+	{
+		static const typename InputReader::ControlCharMap& controlCharMap = InputReader::controlCharMap();
+		static const charset::UTF8::CharLengthTab& charLengthTab = charset::UTF8::charLengthTab();
+		std::size_t pos = 0;
+		while (pos < size)
+		{
+			unsigned char chr = (unsigned char)src[ pos];
+			ControlCharacter ch = controlCharMap[ chr];
+			if (!isTok[ (unsigned char)ch] && !(acceptAmp && ch == Amp)) break;
+			if (chr < 128)
+			{
+				if (!acceptEoln && (chr == '\r' || chr == '\n')) break;
+				++pos;
+			}
+			else
+			{
+				//... the bytes of a character are taken as they are without validation like in charset::UTF8::fetchbytes, a byte that is not the first byte of a character is taken as a character of its own
+				std::size_t chrlen = charLengthTab[ chr];
+				if (chrlen == 0) chrlen = 1;
+				if (chrlen > size - pos) break;
+				pos += chrlen;
+			}
+		}
+		return pos;
+	}
+
+	bool copyspan_impl( const IsTokenCharMap& isTok, const traits::TypeCheck::YES&, const traits::TypeCheck::YES&)
+	{
+		std::size_t size;
+		const char* src = m_src.span( size);
+		std::size_t len = utf8TokenSpanLength( isTok, false, false, src, size);
+		if (!len) return false;
+		m_outputBuf.append( src, len);
+		m_src.skipspan( len);
+		return true;
+	}
+
+	template <class SameCharSet, class InputIsUTF8>
+	bool copyspan_impl( const IsTokenCharMap&, const SameCharSet&, const InputIsUTF8&)
+	{
+		return false;
+	}
+
+	/// \brief Direct copy of the token characters following the current position available in the source buffer to the output, if the input and output character set is UTF-8
+	/// \remark Stops before entities and end of line characters that need translation
+	/// \param [in] isTok set of valid token characters
+	/// \return true if characters were copied
+	bool copyspan( const IsTokenCharMap& isTok)
+	{
+		return copyspan_impl( isTok, traits::TypeCheck::is_same<InputCharSet,OutputCharSet>::type(), traits::TypeCheck::is_same<InputCharSet,charset::UTF8>::type());
+	}
+
+	void skipspan_impl( const IsTokenCharMap& isTok, const traits::TypeCheck::YES&)
+	{
+		std::size_t size;
+		const char* src = m_src.span( size);
+		std::size_t len = utf8TokenSpanLength( isTok, true, true, src, size);
+		if (len) m_src.skipspan( len);
+	}
+
+	void skipspan_impl( const IsTokenCharMap&, const traits::TypeCheck::NO&)
+	{}
+
+	/// \brief Skip the token characters and entities following the current position available in the source buffer, if the input character set is UTF-8
+	/// \param [in] isTok set of valid token characters
+	void skipspan( const IsTokenCharMap& isTok)
+	{
+		skipspan_impl( isTok, traits::TypeCheck::is_same<InputCharSet,charset::UTF8>::type());
+	}
+
 	/// \brief Map a hexadecimal digit to its value
 	/// \param [in] ch hexadecimal digit to map to its decimal value
 	static unsigned char HEX( unsigned char ch)
@@ -745,9 +825,6 @@ private:
 		}
 		for (;;)
 		{
-			/// \todo When source and dest encoding are equal, then do not decode
-			///	the value in parsing and encode it when printing. Use some sort
-			///	of enable_if do redirect to a simple buffer copy.
 			ControlCharacter ch;
 			while (isTok[ (unsigned char)(ch=m_src.control())])
 			{
@@ -780,6 +857,11 @@ private:
 					tokstate.eolnState = TokState::SRC;
 				}
 				m_src.skip();
+				//... when source and destination encoding are equal, then the characters following are copied without decoding and encoding them
+				if (copyspan( isTok))
+				{
+					tokstate.eolnState = TokState::SRC;
+				}
 			}
 			if (ch == Amp)
 			{
@@ -840,18 +922,119 @@ private:
 	/// \return true on success
 	bool skipToken( const IsTokenCharMap& isTok)
 	{
+		if (tokstate.id == TokState::Start)
+		{
+			m_tokenpos = m_src.getPosition();
+			m_outputBuf.clear();
+		}
 		do
 		{
 			ControlCharacter ch;
 			while (isTok[ (unsigned char)(ch=m_src.control())] || ch == Amp)
 			{
 				m_src.skip();
+				skipspan( isTok);
 			}
 		}
 		while (m_src.control() == Any);
 		return true;
 	}
 
+	void rawSkipSpanToLt( const traits::TypeCheck::YES&)
+	{
+		std::size_t size;
+		const char* src = m_src.span( size);
+		if (!size) return;
+		const char* lt = (const char*)std::memchr( src, '<', size);
+		m_src.skipspan( lt ? (std::size_t)(lt - src) : size);
+	}
+
+	void rawSkipSpanToLt( const traits::TypeCheck::NO&)
+	{}
+
+	/// \brief Skip the source up to the next '<' without processing the characters before
+	/// \return false if the end of text was reached
+	bool rawSkipToLt()
+	{
+		for (;;)
+		{
+			//... the UTF-8 source is searched for '<' in the spans available in the buffer of the source iterator
+			rawSkipSpanToLt( traits::TypeCheck::is_same<InputCharSet,charset::UTF8>::type());
+			ControlCharacter ch = m_src.control();
+			if (ch == Lt) return true;
+			if (ch == EndOfText) return false;
+			m_src.skip();
+		}
+	}
+
+	/// \brief Skip the source up to and including the next occurrence of an ASCII string
+	/// \param [in] str string to search for
+	/// \return false if the end of text was reached
+	bool rawSkipPast( const char* str)
+	{
+		std::size_t len = std::strlen( str);
+		std::size_t matched = 0;
+		while (matched < len)
+		{
+			if (m_src.control() == EndOfText) return false;
+			unsigned char aa = m_src.ascii();
+			//... on a mismatch continue with the longest suffix of the part matched that is a prefix of the string
+			while (matched > 0 && (unsigned char)str[ matched] != aa)
+			{
+				std::size_t kk = matched-1;
+				for (; kk > 0 && 0!=std::memcmp( str, str + matched - kk, kk); --kk){}
+				matched = kk;
+			}
+			if ((unsigned char)str[ matched] == aa) ++matched;
+			m_src.skip();
+		}
+		return true;
+	}
+
+	/// \brief Skip the rest of a tag after its name up to its end, with quoted attribute values skipped as a whole
+	/// \return Gt if the '>' of the end of the tag has been skipped, Slash if the current character is the '/' of an immediate close tag, EndOfText if the end of text was reached
+	ControlCharacter rawSkipTagRest()
+	{
+		unsigned char quote = 0;
+		for (;;)
+		{
+			ControlCharacter ch = m_src.control();
+			if (ch == EndOfText) return EndOfText;
+			if (quote)
+			{
+				if (m_src.ascii() == quote) quote = 0;
+			}
+			else if (ch == Sq || ch == Dq)
+			{
+				quote = m_src.ascii();
+			}
+			else if (ch == Slash)
+			{
+				return Slash;
+			}
+			else if (ch == Gt)
+			{
+				m_src.skip();
+				return Gt;
+			}
+			m_src.skip();
+		}
+	}
+
+	/// \brief Skip the characters of the source that match the name of the last open tag returned (still in the output buffer)
+	/// \return true if the name matches completely and is not followed by another tag name character
+	bool rawMatchTagName()
+	{
+		static const IsTagCharMap tagC;
+		TextScanner<CStringIterator,OutputCharSet> name( CStringIterator( getItemPtr(), getItemSize()));
+		for (; *name; ++name)
+		{
+			if (m_src.chr() != *name) return false;
+			m_src.skip();
+		}
+		return !tagC[ (unsigned char)m_src.control()];
+	}
+
 	/// \brief Parse a token that must be the same as a given string
 	/// \param [in] str string expected
 	/// \return true on success
@@ -1193,6 +1376,89 @@ public:
 		return rt;
 	}
 
+	/// \brief Skip the content and the descendants of the element of the open tag just returned with a raw scan for its end tag, without parsing them
+	/// \remark Only allowed directly after nextItem(unsigned short) returned OpenTag. The next element returned by nextItem(unsigned short) is the CloseTag of the element, or CloseTagIm if the open tag closes itself
+	/// \remark Nested elements with the same name are counted. Comments, CDATA sections and processing instructions are skipped as a whole, document type definitions in the element are not supported
+	/// \remark Not resumable when interrupted by the end of a chunk of a source fed chunk by chunk
+	/// \param [out] contentsize number of bytes of the source between the open tag and the end tag of the element
+	/// \return true on success, false on error (unexpected end of text or not called after an open tag)
+	bool skipElement( std::size_t& contentsize)
+	{
+		contentsize = 0;
+		ControlCharacter tagend;
+		switch (state)
+		{
+			case TAGCLIM:
+				//... the scanner returns CloseTagIm for the '/>' of the open tag next
+				return true;
+			case TAGAISK:
+				tagend = rawSkipTagRest();
+				//... if the open tag closes itself, the scanner returns CloseTagIm for the '/>' at the current position next
+				if (tagend == Slash) return true;
+				break;
+			case CONTENT:
+				tagend = Gt;
+				break;
+			default:
+				error = ErrInternal;
+				return false;
+		}
+		std::size_t startpos = m_src.getPosition();
+		int depth = 0;
+		while (tagend == Gt)
+		{
+			if (!rawSkipToLt()) break;
+			std::size_t ltpos = m_src.getPosition();
+			m_src.skip();
+			ControlCharacter ch = m_src.control();
+			if (ch == Slash)
+			{
+				m_src.skip();
+				std::size_t namepos = m_src.getPosition();
+				if (rawMatchTagName())
+				{
+					if (depth == 0)
+					{
+						//... the scanner returns the CloseTag with the name still in the output buffer, the current character is the one following the name
+						contentsize = ltpos - startpos;
+						m_tokenpos = namepos;
+						state = CLOSETAG;
+						tokstate.init( TokState::ParsingDone);
+						return true;
+					}
+					--depth;
+				}
+			}
+			else if (ch == Exclam)
+			{
+				m_src.skip();
+				ch = m_src.control();
+				if (!rawSkipPast( ch == Dash ? "-->" : ch == Osb ? "]]>" : ">")) break;
+			}
+			else if (ch == Questm)
+			{
+				m_src.skip();
+				if (!rawSkipPast( "?>")) break;
+			}
+			else if (rawMatchTagName())
+			{
+				tagend = rawSkipTagRest();
+				if (tagend == Slash)
+				{
+					//... nested immediate close tag
+					m_src.skip();
+					tagend = Gt;
+				}
+				else
+				{
+					++depth;
+				}
+			}
+		}
+		error = ErrUnexpectedEndOfText;
+		return false;
+	}
+
 	/// \class End
 	/// \brief end of input tag
 	struct End {};
@@ -1250,6 +1516,7 @@ public:
 		Element element;				///< currently visited element
 		ThisXMLScanner* input;				///< XML scanner
 
+	public:
 		/// \brief Skip to the next element
 		/// \param [in] mask element types that should be printed to the output buffer (1 -> print, 0 -> mask out, just return the element as event)
 		/// \return iterator pointing to the next element
@@ -1264,6 +1531,7 @@ public:
 			return *this;
 		}
 
+	private:
 		/// \brief Compare iterator with another
 		/// \param [in] iter iterator to compare with
 		/// \return true if they are equal
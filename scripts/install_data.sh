@@ -13,15 +13,14 @@ mkdir -p $STORAGEPATH
 
 createData() {
 	cd $DATAPATH
-	wget http://dumps.wikimedia.your.org/enwiki/latest/enwiki-latest-pages-articles.xml.bz2
-	bunzip2 enwiki-latest-pages-articles.xml.bz2
+	wget http://dumps.wikimedia.your.org/enwiki/latest/enwiki-latest-pages-articles-multistream.xml.bz2
+	wget http://dumps.wikimedia.your.org/enwiki/latest/enwiki-latest-pages-articles-multistream-index.txt.bz2
 	
 	mkdir -p xml
 	mkdir -p nlpxml
 	mkdir -p storage
 	
-	strusWikimediaToXml -n 0 -P 10000 -R ./redirects.txt enwiki-latest-pages-articles.xml
-	strusWikimediaToXml -B -n 0 -P 10000 -t "$MAXNOFHTREADS" -L ./redirects.txt enwiki-latest-pages-articles.xml xml
+	strusWikimediaToXml -B -n 0 -P 10000 -t "$MAXNOFHTREADS" --index enwiki-latest-pages-articles-multistream-index.txt.bz2 --onepass -R ./redirects.bin enwiki-latest-pages-articles-multistream.xml.bz2 xml
 
 	for ext in err mis wtf org txt; do find xml -name "*.$ext" | xargs rm; done
 }
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Pool of threads writing and removing the output files of the conversion asynchronously in batches
+/// \file asyncFileWriter.cpp
+#include "asyncFileWriter.hpp"
+#include "strus/base/string_format.hpp"
+#include <iostream>
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define _TXT(XX) XX
+
+using namespace strus;
+
+AsyncFileWriter::AsyncFileWriter( int nofThreads, std::size_t capacity, bool sync)
+	:m_queues(),m_capacity(capacity),m_queuedBytes(0),m_nofPending(0),m_sync(sync),m_terminate(false)
+{
+	if (nofThreads <= 0) throw std::runtime_error( _TXT("number of writer threads must be positive"));
+	try
+	{
+		int ti = 0;
+		for (; ti < nofThreads; ++ti)
+		{
+			m_queues.push_back( new WriterQueue());
+			m_queues.back()->thread = new strus::thread( &AsyncFileWriter::run, this, m_queues.back());
+		}
+	}
+	catch (...)
+	{
+		close();
+		std::vector<WriterQueue*>::iterator qi = m_queues.begin(), qe = m_queues.end();
+		for (; qi != qe; ++qi) delete *qi;
+		throw;
+	}
+}
+
+AsyncFileWriter::~AsyncFileWriter()
+{
+	close();
+	std::vector<WriterQueue*>::iterator qi = m_queues.begin(), qe = m_queues.end();
+	for (; qi != qe; ++qi) delete *qi;
+}
+
+void AsyncFileWriter::write( int key, const std::string& filename, const std::string& content)
+{
+	push( key, Operation::Write, filename, content);
+}
+
+void AsyncFileWriter::remove( int key, const std::string& filename)
+{
+	push( key, Operation::Remove, filename, std::string());
+}
+
+void AsyncFileWriter::push( int key, Operation::Type type, const std::string& filename, const std::string& content)
+{
+	WriterQueue& queue = *m_queues[ (unsigned int)key % m_queues.size()];
+	strus::unique_lock lock( m_mutex);
+	while (m_queuedBytes > 0 && m_queuedBytes + content.size() > m_capacity)
+	{
+		m_cv_notFull.wait( lock);
+	}
+	if (m_terminate) throw std::runtime_error( _TXT("write to closed file writer"));
+	queue.ops.push_back( Operation());
+	queue.ops.back().type = type;
+	queue.ops.back().filename = filename;
+	queue.ops.back().content = content;
+	m_queuedBytes += content.size();
+	++m_nofPending;
+	queue.cv_notEmpty.notify_one();
+}
+
+void AsyncFileWriter::flush()
+{
+	strus::unique_lock lock( m_mutex);
+	while (m_nofPending > 0)
+	{
+		m_cv_notFull.wait( lock);
+	}
+}
+
+void AsyncFileWriter::close()
+{
+	{
+		strus::unique_lock lock( m_mutex);
+		m_terminate = true;
+		std::vector<WriterQueue*>::iterator qi = m_queues.begin(), qe = m_queues.end();
+		for (; qi != qe; ++qi) (*qi)->cv_notEmpty.notify_all();
+	}
+	std::vector<WriterQueue*>::iterator qi = m_queues.begin(), qe = m_queues.end();
+	for (; qi != qe; ++qi)
+	{
+		if ((*qi)->thread)
+		{
+			(*qi)->thread->join();
+			delete (*qi)->thread;
+			(*qi)->thread = 0;
+		}
+	}
+}
+
+std::string AsyncFileWriter::statistics() const
+{
+	std::string rt;
+	std::vector<WriterQueue*>::const_iterator qi = m_queues.begin(), qe = m_queues.end();
+	for (int qidx=1; qi != qe; ++qi,++qidx)
+	{
+		rt.append( strus::string_format( "writer thread %d wrote %d files in %d batches\n", qidx, (*qi)->nofFiles, (*qi)->nofBatches));
+	}
+	return rt;
+}
+
+void AsyncFileWriter::run( WriterQueue* queue)
+{
+	std::vector<Operation> batch;
+	batch.reserve( MaxBatchSize);
+	for (;;)
+	{
+		std::size_t batchBytes = 0;
+		{
+			strus::unique_lock lock( m_mutex);
+			while (queue->ops.empty() && !m_terminate)
+			{
+				queue->cv_notEmpty.wait( lock);
+			}
+			if (queue->ops.empty()) return;
+			while (!queue->ops.empty() && batch.size() < (std::size_t)MaxBatchSize)
+			{
+				Operation& op = queue->ops.front();
+				batch.push_back( Operation());
+				batch.back().type = op.type;
+				batch.back().filename.swap( op.filename);
+				batch.back().content.swap( op.content);
+				batchBytes += batch.back().content.size();
+				queue->ops.pop_front();
+			}
+		}
+		executeBatch( *queue, batch);
+		{
+			strus::unique_lock lock( m_mutex);
+			m_queuedBytes -= batchBytes;
+			m_nofPending -= batch.size();
+			m_cv_notFull.notify_all();
+		}
+		batch.clear();
+	}
+}
+
+static bool writeAll( int fd, const std::string& content)
+{
+	char const* ptr = content.c_str();
+	std::size_t size = content.size();
+	while (size > 0)
+	{
+		ssize_t nn = ::write( fd, ptr, size);
+		if (nn < 0)
+		{
+			if (errno == EINTR) continue;
+			return false;
+		}
+		ptr += nn;
+		size -= nn;
+	}
+	return true;
+}
+
+void AsyncFileWriter::executeBatch( WriterQueue& queue, const std::vector<Operation>& batch)
+{
+	std::vector<std::pair<int,const std::string*> > syncfiles;
+	std::vector<Operation>::const_iterator bi = batch.begin(), be = batch.end();
+	for (; bi != be; ++bi)
+	{
+		if (bi->type == Operation::Remove)
+		{
+			if (0 != ::unlink( bi->filename.c_str()) && errno != ENOENT)
+			{
+				int ec = errno;
+				std::cerr << "error removing file " << bi->filename << ": " << std::strerror(ec) << std::endl;
+			}
+			continue;
+		}
+		int fd = ::open( bi->filename.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0644);
+		if (fd < 0 || !writeAll( fd, bi->content))
+		{
+			int ec = errno;
+			std::cerr << "error writing file " << bi->filename << ": " << std::strerror(ec) << std::endl;
+			if (fd >= 0) ::close( fd);
+			continue;
+		}
+		++queue.nofFiles;
+		if (m_sync)
+		{
+			//... the files of the batch are synchronized together after all of them have been written
+			syncfiles.push_back( std::pair<int,const std::string*>( fd, &bi->filename));
+		}
+		else
+		{
+			::close( fd);
+		}
+	}
+	std::vector<std::pair<int,const std::string*> >::const_iterator si = syncfiles.begin(), se = syncfiles.end();
+	for (; si != se; ++si)
+	{
+		if (0 != ::fdatasync( si->first))
+		{
+			int ec = errno;
+			std::cerr << "error synchronizing file " << *si->second << ": " << std::strerror(ec) << std::endl;
+		}
+		::close( si->first);
+	}
+	++queue.nofBatches;
+}
+
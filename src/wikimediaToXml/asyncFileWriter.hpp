@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Pool of threads writing and removing the output files of the conversion asynchronously in batches
+/// \file asyncFileWriter.hpp
+#ifndef _STRUS_WIKIPEDIA_ASYNC_FILE_WRITER_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_ASYNC_FILE_WRITER_HPP_INCLUDED
+#include "strus/base/thread.hpp"
+#include <string>
+#include <vector>
+#include <deque>
+#include <cstddef>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Pool of threads writing and removing files asynchronously
+/// \note Every operation is queued for one writer thread selected by a key, the operations with the same key are executed in the order they were issued.
+/// \note A writer thread takes the operations queued for it in batches. If files are synchronized to disk, the files of a batch are synchronized together after all of them have been written.
+/// \note The pool is bounded by the number of bytes of content queued. The caller blocks if the limit is reached.
+class AsyncFileWriter
+{
+public:
+	/// \brief Constructor, starts the writer threads
+	/// \param[in] nofThreads number of writer threads
+	/// \param[in] capacity maximum number of bytes of content queued
+	/// \param[in] sync true if the files written are synchronized to disk
+	AsyncFileWriter( int nofThreads, std::size_t capacity, bool sync);
+	~AsyncFileWriter();
+
+	/// \brief Queue a file to write
+	/// \param[in] key key selecting the writer thread, files with the same key are written in the order of the calls
+	/// \param[in] filename path of the file to write
+	/// \param[in] content content of the file
+	void write( int key, const std::string& filename, const std::string& content);
+	/// \brief Queue a file to remove, a file not existing is ignored
+	/// \param[in] key key selecting the writer thread
+	/// \param[in] filename path of the file to remove
+	void remove( int key, const std::string& filename);
+
+	/// \brief Wait until all operations queued have been executed
+	void flush();
+	/// \brief Execute all operations queued and stop the writer threads
+	void close();
+
+	/// \brief Get the statistics of the writer threads, a line per thread
+	std::string statistics() const;
+
+private:
+	struct Operation
+	{
+		enum Type {Write,Remove};
+		Type type;
+		std::string filename;
+		std::string content;
+
+		Operation()
+			:type(Write),filename(),content(){}
+		Operation( const Operation& o)
+			:type(o.type),filename(o.filename),content(o.content){}
+	};
+	struct WriterQueue
+	{
+		std::deque<Operation> ops;
+		strus::condition_variable cv_notEmpty;
+		int nofFiles;			///< number of files written
+		int nofBatches;			///< number of batches executed
+		strus::thread* thread;
+
+		WriterQueue()
+			:ops(),cv_notEmpty(),nofFiles(0),nofBatches(0),thread(0){}
+	};
+	enum {MaxBatchSize=64};
+
+	void push( int key, Operation::Type type, const std::string& filename, const std::string& content);
+	void run( WriterQueue* queue);
+	void executeBatch( WriterQueue& queue, const std::vector<Operation>& batch);
+
+private:
+	AsyncFileWriter( const AsyncFileWriter&);	//... non copyable
+	void operator=( const AsyncFileWriter&);	//... non copyable
+
+private:
+	std::vector<WriterQueue*> m_queues;
+	std::size_t m_capacity;
+	std::size_t m_queuedBytes;			///< bytes of content queued or in execution
+	int m_nofPending;				///< number of operations queued or in execution
+	bool m_sync;
+	bool m_terminate;
+	strus::mutex m_mutex;
+	strus::condition_variable m_cv_notFull;		///< signalled when operations have been executed
+};
+
+}//namespace
+#endif
+
@@ -0,0 +1,513 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Throughput benchmark of the stages of the conversion of Wikimedia documents to XML
+/// \file benchmarkWikimediaToXml.cpp
+#include "textwolf/sourceiterator.hpp"
+#include "textwolf/xmlscanner.hpp"
+#include "textwolf/charset_utf8.hpp"
+#include "strus/base/fileio.hpp"
+#include "strus/base/string_format.hpp"
+#include "strus/base/numstring.hpp"
+#include "documentStructure.hpp"
+#include "documentParser.hpp"
+#include "wikimediaLexer.hpp"
+#include "stringArena.hpp"
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <stdexcept>
+#include <vector>
+#include <limits>
+#include <new>
+#include <time.h>
+
+#define _TXT(XX) XX
+
+/// \brief Number of calls of the global operator new, the benchmark runs single threaded
+static std::size_t g_nofAllocations = 0;
+
+//... exception specifications of the replaced global operators as declared in <new> of the language version compiled with
+#if __cplusplus >= 201103L
+#define BENCHMARK_NEW_THROW
+#define BENCHMARK_DELETE_THROW noexcept
+#else
+#define BENCHMARK_NEW_THROW throw(std::bad_alloc)
+#define BENCHMARK_DELETE_THROW throw()
+#endif
+
+void* operator new( std::size_t size) BENCHMARK_NEW_THROW
+{
+	++g_nofAllocations;
+	void* rt = std::malloc( size ? size : 1);
+	if (!rt) throw std::bad_alloc();
+	return rt;
+}
+void* operator new[]( std::size_t size) BENCHMARK_NEW_THROW
+{
+	++g_nofAllocations;
+	void* rt = std::malloc( size ? size : 1);
+	if (!rt) throw std::bad_alloc();
+	return rt;
+}
+void operator delete( void* ptr) BENCHMARK_DELETE_THROW
+{
+	std::free( ptr);
+}
+void operator delete[]( void* ptr) BENCHMARK_DELETE_THROW
+{
+	std::free( ptr);
+}
+
+struct Document
+{
+	std::string title;
+	std::string content;
+
+	Document( const std::string& title_, const std::string& content_)
+		:title(title_),content(content_){}
+	Document( const Document& o)
+		:title(o.title),content(o.content){}
+};
+
+/// \brief Set of documents benchmarked together
+struct DocumentSet
+{
+	std::string name;
+	std::vector<Document> docs;
+	std::size_t size;
+	std::string dump;		///< XML source of the documents, empty for a synthetic document set
+
+	explicit DocumentSet( const std::string& name_)
+		:name(name_),docs(),size(0),dump(){}
+
+	void add( const std::string& title, const std::string& content)
+	{
+		docs.push_back( Document( title, content));
+		size += content.size();
+	}
+};
+
+enum TagId {TagIgnored, TagPage, TagTitle, TagNs, TagText, TagRedirect};
+
+/// \brief Load the articles of namespace 0 without redirects from a Wikipedia dump
+static void loadDump( DocumentSet& docset, const std::string& filename)
+{
+	typedef textwolf::XMLScanner<textwolf::SrcIterator,textwolf::charset::UTF8,textwolf::charset::UTF8,std::string> XmlScanner;
+
+	std::string& dump = docset.dump;
+	int ec = strus::readFile( filename, dump);
+	if (ec) throw std::runtime_error( strus::string_format( _TXT("failed to read input file '%s': %s"), filename.c_str(), std::strerror(ec)));
+
+	textwolf::SrcIterator srciter( dump.c_str(), dump.size());
+	XmlScanner xs( srciter);
+	XmlScanner::iterator itr = xs.begin(), end = xs.end();
+	TagId lastTag = TagIgnored;
+	std::vector<TagId> tagstack;
+	std::string title;
+	std::string content;
+	int ns = 0;
+	bool redirect = false;
+
+	for (; itr != end; ++itr)
+	{
+		switch (itr->type())
+		{
+			case XmlScanner::ErrorOccurred:
+				throw std::runtime_error( strus::string_format( _TXT("xml error in input file '%s': %s"), filename.c_str(), itr->content()));
+			case XmlScanner::OpenTag:
+			{
+				std::string tagname( itr->content(), itr->size());
+				lastTag = TagIgnored;
+				if (tagname == "page")
+				{
+					lastTag = TagPage;
+					title.clear();
+					content.clear();
+					ns = 0;
+					redirect = false;
+				}
+				else if (tagname == "title") lastTag = TagTitle;
+				else if (tagname == "ns") lastTag = TagNs;
+				else if (tagname == "text") lastTag = TagText;
+				else if (tagname == "redirect") redirect = true;
+				tagstack.push_back( lastTag);
+				break;
+			}
+			case XmlScanner::CloseTagIm:
+			case XmlScanner::CloseTag:
+			{
+				lastTag = TagIgnored;
+				if (!tagstack.empty())
+				{
+					if (tagstack.back() == TagPage && ns == 0 && !redirect && !content.empty())
+					{
+						docset.add( title, content);
+					}
+					tagstack.pop_back();
+				}
+				break;
+			}
+			case XmlScanner::Content:
+				switch (lastTag)
+				{
+					case TagTitle: title = std::string( itr->content(), itr->size()); break;
+					case TagNs: ns = strus::numstring_conv::toint( std::string( itr->content(), itr->size()), 10000); break;
+					case TagText: content = std::string( itr->content(), itr->size()); break;
+					default: break;
+				}
+				break;
+			default:
+				break;
+		}
+	}
+}
+
+/// \brief Pseudo random number generator giving the same sequence on every platform
+class Random
+{
+public:
+	explicit Random( unsigned int seed_)
+		:m_state(seed_ ? seed_ : 1){}
+
+	unsigned int get( unsigned int range)
+	{
+		m_state = m_state * 1103515245 + 12345;
+		return ((m_state >> 16) & 0x7fff) % range;
+	}
+
+private:
+	unsigned int m_state;
+};
+
+static const char* g_words[] = {
+	"the","of","and","in","a","to","was","is","for","as","on","by","with","he","that","at","from","his","it","an",
+	"election","president","party","state","votes","candidate","convention","nomination","democratic","whig",
+	"album","music","singer","recorded","released","tour","london","career","band","single","chart",
+	"electric","field","conductor","charge","shield","radiation","frequency","mesh","enclosure","faraday",
+	"1852","1844","1969","2018","12","250","3.5","42"
+};
+
+static std::string randomWords( Random& rnd, int nofWords)
+{
+	std::string rt;
+	for (int wi=0; wi < nofWords; ++wi)
+	{
+		if (wi) rt.push_back( ' ');
+		rt.append( g_words[ rnd.get( sizeof(g_words)/sizeof(*g_words))]);
+	}
+	return rt;
+}
+
+/// \brief Generate a document with the markup elements found in Wikipedia articles in roughly their frequency
+static std::string syntheticDocument( Random& rnd, std::size_t size)
+{
+	std::string rt;
+	rt.append( "{{Infobox election\n| name = " + randomWords( rnd, 3) + "\n| image = File:Example.jpg\n| date = 2 November 1852\n}}\n");
+	while (rt.size() < size)
+	{
+		switch (rnd.get( 16))
+		{
+			case 0:
+				rt.append( "\n== " + randomWords( rnd, 2) + " ==\n");
+				break;
+			case 1:
+				rt.append( "\n{| class=\"wikitable\"\n|-\n! " + randomWords( rnd, 1) + " !! " + randomWords( rnd, 1) + "\n");
+				for (int ri=0,re=rnd.get( 6)+1; ri < re; ++ri)
+				{
+					rt.append( "|-\n| " + randomWords( rnd, 2) + " || " + strus::string_format( "%u", rnd.get( 100000)) + "\n");
+				}
+				rt.append( "|}\n");
+				break;
+			case 2:
+				rt.append( "<ref>{{cite web |url=http://www.example.org/" + randomWords( rnd, 1) + ".html |title=" + randomWords( rnd, 4) + " |accessdate=2018-11-30}}</ref>");
+				break;
+			case 3:
+				rt.append( "\n* " + randomWords( rnd, 6) + "\n* [[" + randomWords( rnd, 2) + "]]\n");
+				break;
+			case 4:
+				rt.append( " '''" + randomWords( rnd, 2) + "''' ");
+				break;
+			case 5:
+				rt.append( " ''" + randomWords( rnd, 2) + "'' ");
+				break;
+			case 6:
+			case 7:
+				rt.append( " [[" + randomWords( rnd, 2) + "|" + randomWords( rnd, 1) + "]] ");
+				break;
+			case 8:
+				rt.append( " [http://www.example.com/" + randomWords( rnd, 1) + " " + randomWords( rnd, 3) + "] ");
+				break;
+			case 9:
+				rt.append( " &ndash; " + randomWords( rnd, 3) + " &nbsp;");
+				break;
+			default:
+				rt.append( randomWords( rnd, 12) + ". ");
+				if (!rnd.get( 4)) rt.append( "\n\n");
+				break;
+		}
+	}
+	rt.append( "\n\n== References ==\n{{Reflist}}\n\n[[Category:" + randomWords( rnd, 2) + "]]\n");
+	return rt;
+}
+
+static void generateSyntheticDump( DocumentSet& docset, std::size_t size, unsigned int seed)
+{
+	Random rnd( seed);
+	for (int didx=1; docset.size < size; ++didx)
+	{
+		docset.add( strus::string_format( "Synthetic %d", didx), syntheticDocument( rnd, 2000 + rnd.get( 40000)));
+	}
+}
+
+/// \brief Scan the XML of a dump like strusWikimediaToXml does, without processing the documents
+/// \note With a source iterator providing access to its buffer (textwolf::SrcIterator, textwolf::IStreamIterator) the scanner copies the content of the UTF-8 input to the UTF-8 output in spans, with a plain character pointer it processes the content character by character
+/// \return a checksum of the results, used to prevent the compiler from optimizing the work away
+template <class InputIterator>
+static std::size_t scanXml( const InputIterator& srciter)
+{
+	typedef textwolf::XMLScanner<InputIterator,textwolf::charset::UTF8,textwolf::charset::UTF8,std::string> XmlScanner;
+
+	std::size_t rt = 0;
+	XmlScanner xs( srciter);
+	typename XmlScanner::iterator itr = xs.begin(), end = xs.end();
+	for (; itr != end; ++itr)
+	{
+		if (itr->type() == XmlScanner::ErrorOccurred)
+		{
+			throw std::runtime_error( strus::string_format( _TXT("xml error: %s"), itr->content()));
+		}
+		rt += itr->size() + 1;
+	}
+	return rt;
+}
+
+static double getTimeSeconds()
+{
+	struct timespec ts;
+	::clock_gettime( CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+enum Stage {StageLexer, StageDocumentStructure, StageToXml};
+static const char* stageName( Stage stage)
+{
+	static const char* ar[] = {"lexer","lexer+structure","lexer+structure+toxml"};
+	return ar[ stage];
+}
+
+/// \brief Process all documents of a set once, up to a stage of the conversion
+/// \return a checksum of the results, used to prevent the compiler from optimizing the work away
+static std::size_t runStage( const DocumentSet& docset, Stage stage, strus::StringArena& arena)
+{
+	std::size_t rt = 0;
+	std::vector<Document>::const_iterator di = docset.docs.begin(), de = docset.docs.end();
+	for (; di != de; ++di)
+	{
+		if (stage == StageLexer)
+		{
+			strus::WikimediaLexer lexer( di->content.c_str(), di->content.size());
+			strus::WikimediaLexem lexem = lexer.next();
+			for (; lexem.id != strus::WikimediaLexem::EoF; lexem = lexer.next())
+			{
+				rt += lexem.value.size() + 1;
+			}
+		}
+		else
+		{
+			strus::DocumentStructure doc( &arena);
+			doc.setTitle( di->title);
+			try
+			{
+				strus::parseDocumentText( doc, di->content.c_str(), di->content.size(), NULL/*linkmap*/, false/*defer links*/, false/*verbose*/, NULL/*statistics*/);
+				doc.finish();
+				if (stage == StageToXml)
+				{
+					rt += doc.toxml( false/*beautified*/, true/*singleIdAttribute*/).size();
+				}
+				rt += doc.errors().size();
+			}
+			catch (const std::runtime_error& err)
+			{
+				++rt;
+			}
+		}
+		arena.reset();
+	}
+	return rt;
+}
+
+static void printResult( const DocumentSet& docset, const char* stagename, std::size_t size, int nofRounds, double duration, std::size_t nofAllocations, std::size_t checksum)
+{
+	double nofDocs = (double)docset.docs.size() * nofRounds;
+	double nofMB = (double)size * nofRounds / (1024.0 * 1024.0);
+	if (duration <= 0.0) duration = 1e-9;
+	std::cout << strus::string_format( "%-24s %-22s %10.2f MB/s %12.1f docs/s %12.1f allocs/doc [%x]",
+			docset.name.c_str(), stagename,
+			nofMB / duration, nofDocs / duration,
+			nofDocs > 0.0 ? (double)nofAllocations / nofDocs : 0.0,
+			(unsigned int)(checksum & 0xFFFF)) << std::endl;
+}
+
+static void runXmlScanBenchmark( const DocumentSet& docset, int nofRounds, bool spanCopy)
+{
+	textwolf::SrcIterator srciter( docset.dump.c_str(), docset.dump.size());
+	char* charptr = const_cast<char*>( docset.dump.c_str());
+	std::size_t checksum = spanCopy ? scanXml( srciter) : scanXml( charptr); //... warm up caches
+
+	std::size_t nofAllocations = g_nofAllocations;
+	double startTime = getTimeSeconds();
+	for (int ri=0; ri < nofRounds; ++ri)
+	{
+		checksum += spanCopy ? scanXml( srciter) : scanXml( charptr);
+	}
+	double duration = getTimeSeconds() - startTime;
+	nofAllocations = g_nofAllocations - nofAllocations;
+	printResult( docset, spanCopy ? "xmlscan" : "xmlscan (char by char)", docset.dump.size(), nofRounds, duration, nofAllocations, checksum);
+}
+
+static void runBenchmark( const DocumentSet& docset, int nofRounds)
+{
+	if (!docset.dump.empty())
+	{
+		runXmlScanBenchmark( docset, nofRounds, false/*span copy*/);
+		runXmlScanBenchmark( docset, nofRounds, true/*span copy*/);
+	}
+	strus::StringArena arena;
+	int si = StageLexer, se = StageToXml+1;
+	for (; si != se; ++si)
+	{
+		Stage stage = (Stage)si;
+		runStage( docset, stage, arena); //... warm up caches and arena blocks
+
+		std::size_t nofAllocations = g_nofAllocations;
+		double startTime = getTimeSeconds();
+		std::size_t checksum = 0;
+		for (int ri=0; ri < nofRounds; ++ri)
+		{
+			checksum += runStage( docset, stage, arena);
+		}
+		double duration = getTimeSeconds() - startTime;
+		nofAllocations = g_nofAllocations - nofAllocations;
+		printResult( docset, stageName( stage), docset.size, nofRounds, duration, nofAllocations, checksum);
+	}
+}
+
+static int getUIntOptionArg( int argi, int argc, const char* argv[])
+{
+	if (argv[argi+1])
+	{
+		return strus::numstring_conv::touint( argv[argi+1], std::numeric_limits<int>::max());
+	}
+	else
+	{
+		throw std::runtime_error( std::string("no argument given for option ") + argv[argi]);
+	}
+}
+
+int main( int argc, const char* argv[])
+{
+	try
+	{
+		int argi = 1;
+		int nofRounds = 3;
+		int syntheticMB = 0;
+		int seed = 1;
+		bool printusage = false;
+
+		for (;argi < argc; ++argi)
+		{
+			if (0==std::strcmp(argv[argi],"-h") || 0==std::strcmp(argv[argi],"--help"))
+			{
+				printusage = true;
+			}
+			else if (0==std::strcmp(argv[argi],"-r"))
+			{
+				nofRounds = getUIntOptionArg( argi, argc, argv);
+				++argi;
+				if (nofRounds == 0) throw std::runtime_error( _TXT("number of rounds (option -r) must be positive"));
+			}
+			else if (0==std::strcmp(argv[argi],"-S"))
+			{
+				syntheticMB = getUIntOptionArg( argi, argc, argv);
+				++argi;
+			}
+			else if (0==std::strcmp(argv[argi],"-s"))
+			{
+				seed = getUIntOptionArg( argi, argc, argv);
+				++argi;
+			}
+			else if (0==std::strcmp(argv[argi],"--"))
+			{
+				++argi;
+				break;
+			}
+			else if (argv[argi][0] == '-')
+			{
+				throw std::runtime_error( strus::string_format( _TXT("unknown option %s"), argv[argi]));
+			}
+			else
+			{
+				break;
+			}
+		}
+		if (argi == argc && syntheticMB == 0)
+		{
+			printusage = true;
+		}
+		if (printusage)
+		{
+			std::cerr << "Usage: benchmarkWikimediaToXml [options] [<inputfile>...]" << std::endl;
+			std::cerr << "<inputfile>   :Wikipedia dump (XML) with the articles to process" << std::endl;
+			std::cerr << "options:" << std::endl;
+			std::cerr << "    -h|--help :Print this usage" << std::endl;
+			std::cerr << "    -r <N>    :Process every document set <N> times per stage (default 3)" << std::endl;
+			std::cerr << "    -S <MB>   :Process also a synthetic dump of <MB> megabytes" << std::endl;
+			std::cerr << "    -s <SEED> :Seed for generating the synthetic dump (default 1)" << std::endl;
+			std::cerr << "Reports for every input and stage (xmlscan of the dump, lexer, lexer+structure, lexer+structure+toxml)" << std::endl;
+			std::cerr << "the throughput in MB/s and documents/s, and the number of allocations per document." << std::endl;
+			return 0;
+		}
+		std::vector<DocumentSet> docsets;
+		for (; argi < argc; ++argi)
+		{
+			std::string filename( argv[argi]);
+			std::string::size_type namestart = filename.find_last_of( '/');
+			docsets.push_back( DocumentSet( namestart == std::string::npos ? filename : filename.substr( namestart+1)));
+			loadDump( docsets.back(), filename);
+		}
+		if (syntheticMB)
+		{
+			docsets.push_back( DocumentSet( strus::string_format( "synthetic %dMB", syntheticMB)));
+			generateSyntheticDump( docsets.back(), (std::size_t)syntheticMB << 20, seed);
+		}
+		std::vector<DocumentSet>::const_iterator si = docsets.begin(), se = docsets.end();
+		for (; si != se; ++si)
+		{
+			std::cerr << strus::string_format( "%s: %d documents, %.2f MB", si->name.c_str(), (int)si->docs.size(), (double)si->size / (1024.0 * 1024.0)) << std::endl;
+			runBenchmark( *si, nofRounds);
+		}
+		return 0;
+	}
+	catch (const std::bad_alloc&)
+	{
+		std::cerr << "ERROR out of memory" << std::endl;
+	}
+	catch (const std::runtime_error& e)
+	{
+		std::cerr << "ERROR " << e.what() << std::endl;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "EXCEPTION " << e.what() << std::endl;
+	}
+	return -1;
+}
+
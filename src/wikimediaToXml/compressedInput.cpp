@@ -0,0 +1,525 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Input stream decompressing a bzip2 or zstd compressed Wikipedia dump, in parallel if the dump consists of independent blocks
+/// \file compressedInput.cpp
+#include "compressedInput.hpp"
+#include "strus/base/string_format.hpp"
+#include <bzlib.h>
+#include <zstd.h>
+#include <stdexcept>
+#include <algorithm>
+#include <limits>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <stdint.h>
+
+#define _TXT(XX) XX
+
+using namespace strus;
+
+#define ZSTD_SKIPPABLE_SEEKTABLE_MAGIC 0x184D2A5E
+#define ZSTD_SEEKABLE_MAGIC 0x8F92EAB1
+
+static CompressionType getCompressionType( const char* ptr, std::size_t size)
+{
+	if (size >= 4 && ptr[0] == 'B' && ptr[1] == 'Z' && ptr[2] == 'h' && ptr[3] >= '1' && ptr[3] <= '9')
+	{
+		return CompressionBzip2;
+	}
+	if (size >= 4 && (unsigned char)ptr[0] == 0x28 && (unsigned char)ptr[1] == 0xB5 && (unsigned char)ptr[2] == 0x2F && (unsigned char)ptr[3] == 0xFD)
+	{
+		return CompressionZstd;
+	}
+	return CompressionNone;
+}
+
+CompressionType strus::getFileCompressionType( const std::string& filename)
+{
+	char hdr[4];
+	FILE* fh = ::fopen( filename.c_str(), "rb");
+	if (!fh) return CompressionNone;
+	std::size_t nn = ::fread( hdr, 1, sizeof(hdr), fh);
+	::fclose( fh);
+	return getCompressionType( hdr, nn);
+}
+
+static uint32_t readUint32LE( const char* ptr)
+{
+	const unsigned char* up = (const unsigned char*)ptr;
+	return (uint32_t)up[0] | ((uint32_t)up[1] << 8) | ((uint32_t)up[2] << 16) | ((uint32_t)up[3] << 24);
+}
+
+static void initBzip2Stream( bz_stream* strm)
+{
+	std::memset( strm, 0, sizeof(*strm));
+	int ec = BZ2_bzDecompressInit( strm, 0/*verbosity*/, 0/*small*/);
+	if (ec != BZ_OK) throw std::runtime_error( strus::string_format( _TXT("failed to initialize bzip2 decompression (error %d)"), ec));
+}
+
+/// \brief Decompress a sequence of complete bzip2 streams
+static void decodeBzip2( std::string& res, const char* src, std::size_t srcsize)
+{
+	enum {ChunkSize = 1<<20};
+	if (srcsize > std::numeric_limits<unsigned int>::max()) throw std::runtime_error( _TXT("bzip2 block too big"));
+	bz_stream strm;
+	initBzip2Stream( &strm);
+	strm.next_in = const_cast<char*>(src);
+	strm.avail_in = srcsize;
+	std::size_t pos = 0;
+	for (;;)
+	{
+		res.resize( pos + ChunkSize);
+		strm.next_out = &res[ pos];
+		strm.avail_out = ChunkSize;
+		int ec = BZ2_bzDecompress( &strm);
+		pos += ChunkSize - strm.avail_out;
+		if (ec == BZ_STREAM_END)
+		{
+			if (strm.avail_in == 0) break;
+			//... concatenated stream follows
+			char* next_in = strm.next_in;
+			unsigned int avail_in = strm.avail_in;
+			BZ2_bzDecompressEnd( &strm);
+			initBzip2Stream( &strm);
+			strm.next_in = next_in;
+			strm.avail_in = avail_in;
+		}
+		else if (ec != BZ_OK)
+		{
+			BZ2_bzDecompressEnd( &strm);
+			throw std::runtime_error( strus::string_format( _TXT("bzip2 decompression error %d"), ec));
+		}
+		else if (strm.avail_in == 0 && strm.avail_out == ChunkSize)
+		{
+			BZ2_bzDecompressEnd( &strm);
+			throw std::runtime_error( _TXT("unexpected end of bzip2 block"));
+		}
+	}
+	BZ2_bzDecompressEnd( &strm);
+	res.resize( pos);
+}
+
+/// \brief Parser for the offsets in a bzip2 multistream index file (lines of the form offset:pageid:title)
+class IndexOffsetParser
+{
+public:
+	IndexOffsetParser()
+		:m_offsets(),m_value(0),m_state(StateOffset),m_line(1){}
+
+	void feed( const char* src, std::size_t size)
+	{
+		char const* si = src;
+		const char* se = src + size;
+		for (; si != se; ++si)
+		{
+			switch (m_state)
+			{
+				case StateOffset:
+					if (*si >= '0' && *si <= '9')
+					{
+						m_value = m_value * 10 + (*si - '0');
+					}
+					else if (*si == ':')
+					{
+						if (m_offsets.empty() || m_offsets.back() != m_value)
+						{
+							m_offsets.push_back( m_value);
+						}
+						m_value = 0;
+						m_state = StateRest;
+					}
+					else if (*si == '\n' && m_value == 0)
+					{
+						++m_line;
+					}
+					else
+					{
+						throw std::runtime_error( strus::string_format( _TXT("syntax error in bzip2 multistream index on line %d"), m_line));
+					}
+					break;
+				case StateRest:
+					if (*si == '\n')
+					{
+						++m_line;
+						m_state = StateOffset;
+					}
+					break;
+			}
+		}
+	}
+
+	std::vector<std::size_t> offsets()
+	{
+		std::vector<std::size_t> rt( m_offsets);
+		std::sort( rt.begin(), rt.end());
+		rt.erase( std::unique( rt.begin(), rt.end()), rt.end());
+		return rt;
+	}
+
+private:
+	enum State {StateOffset,StateRest};
+	std::vector<std::size_t> m_offsets;
+	std::size_t m_value;
+	State m_state;
+	int m_line;
+};
+
+DecompressingInputStream::DecompressingInputStream( const std::string& filename, const std::string& indexfilename, int nofThreads)
+	:m_file(filename),m_type(CompressionNone),m_blocks(),m_slots(),m_nextBlock(0),m_readBlock(0),m_readPos(0),m_error(),m_terminate(false)
+	,m_threads(),m_stream(0),m_streamPos(0),m_streamEnd(false),m_position(0)
+{
+	m_type = getCompressionType( m_file.ptr(), m_file.size());
+	switch (m_type)
+	{
+		case CompressionNone:
+			throw std::runtime_error( strus::string_format( _TXT("file '%s' is neither bzip2 nor zstd compressed"), filename.c_str()));
+		case CompressionBzip2:
+			if (!indexfilename.empty())
+			{
+				initBzip2Blocks( indexfilename);
+			}
+			break;
+		case CompressionZstd:
+			if (!indexfilename.empty())
+			{
+				throw std::runtime_error( _TXT("an index file is only supported for bzip2 multistream input"));
+			}
+			initZstdBlocks();
+			break;
+	}
+	if (m_blocks.size() > 1 && nofThreads > 0)
+	{
+		startThreads( nofThreads);
+	}
+	else if (m_type == CompressionBzip2)
+	{
+		bz_stream* strm = new bz_stream;
+		try
+		{
+			initBzip2Stream( strm);
+		}
+		catch (...)
+		{
+			delete strm;
+			throw;
+		}
+		m_stream = strm;
+	}
+	else
+	{
+		ZSTD_DStream* zds = ZSTD_createDStream();
+		if (!zds) throw std::bad_alloc();
+		ZSTD_initDStream( zds);
+		m_stream = zds;
+	}
+}
+
+DecompressingInputStream::~DecompressingInputStream()
+{
+	{
+		strus::unique_lock lock( m_mutex);
+		m_terminate = true;
+		m_cv_consumed.notify_all();
+	}
+	std::vector<strus::thread*>::iterator ti = m_threads.begin(), te = m_threads.end();
+	for (; ti != te; ++ti)
+	{
+		(*ti)->join();
+		delete *ti;
+	}
+	if (m_stream)
+	{
+		if (m_type == CompressionBzip2)
+		{
+			BZ2_bzDecompressEnd( (bz_stream*)m_stream);
+			delete (bz_stream*)m_stream;
+		}
+		else
+		{
+			ZSTD_freeDStream( (ZSTD_DStream*)m_stream);
+		}
+	}
+}
+
+void DecompressingInputStream::initBzip2Blocks( const std::string& indexfilename)
+{
+	IndexOffsetParser parser;
+	if (getFileCompressionType( indexfilename) == CompressionBzip2)
+	{
+		DecompressingInputStream indexInput( indexfilename, std::string(), 0);
+		char buf[ 1<<16];
+		std::size_t nn = indexInput.read( buf, sizeof(buf));
+		for (; nn; nn = indexInput.read( buf, sizeof(buf)))
+		{
+			parser.feed( buf, nn);
+		}
+	}
+	else
+	{
+		MemoryMappedFile indexFile( indexfilename);
+		parser.feed( indexFile.ptr(), indexFile.size());
+	}
+	std::vector<std::size_t> offsets = parser.offsets();
+	if (offsets.empty() || offsets[0] != 0)
+	{
+		//... the first stream contains the dump header and is not referenced in the index
+		offsets.insert( offsets.begin(), 0);
+	}
+	std::vector<std::size_t>::const_iterator oi = offsets.begin(), oe = offsets.end();
+	for (; oi != oe; ++oi)
+	{
+		std::size_t end = (oi+1 == oe) ? m_file.size() : *(oi+1);
+		if (end > m_file.size() || getCompressionType( m_file.ptr() + *oi, end - *oi) != CompressionBzip2)
+		{
+			throw std::runtime_error( strus::string_format( _TXT("index file '%s' does not match the bzip2 multistream input (offset %lu)"), indexfilename.c_str(), (unsigned long)*oi));
+		}
+		m_blocks.push_back( Block( *oi, end - *oi, 0/*unknown*/));
+	}
+}
+
+void DecompressingInputStream::initZstdBlocks()
+{
+	// ... parse the seek table of the zstd seekable format, a skippable frame at the end of the file
+	enum {FooterSize=9, SkippableHeaderSize=8};
+	const char* ptr = m_file.ptr();
+	std::size_t size = m_file.size();
+	if (size < FooterSize + SkippableHeaderSize) return;
+	const char* footer = ptr + size - FooterSize;
+	if (readUint32LE( footer + 5) != ZSTD_SEEKABLE_MAGIC) return;
+
+	std::size_t nofFrames = readUint32LE( footer);
+	std::size_t entrySize = ((unsigned char)footer[4] & 0x80) ? 12 : 8;
+	std::size_t tableSize = nofFrames * entrySize + FooterSize;
+	if (tableSize + SkippableHeaderSize > size)
+	{
+		throw std::runtime_error( _TXT("corrupt zstd seek table"));
+	}
+	std::size_t tableStart = size - tableSize - SkippableHeaderSize;
+	if (readUint32LE( ptr + tableStart) != ZSTD_SKIPPABLE_SEEKTABLE_MAGIC || readUint32LE( ptr + tableStart + 4) != tableSize)
+	{
+		throw std::runtime_error( _TXT("corrupt zstd seek table"));
+	}
+	const char* entry = ptr + tableStart + SkippableHeaderSize;
+	std::size_t offset = 0;
+	std::size_t fi = 0;
+	for (; fi < nofFrames; ++fi,entry += entrySize)
+	{
+		std::size_t compressedSize = readUint32LE( entry);
+		std::size_t decompressedSize = readUint32LE( entry + 4);
+		m_blocks.push_back( Block( offset, compressedSize, decompressedSize));
+		offset += compressedSize;
+	}
+	if (offset != tableStart)
+	{
+		throw std::runtime_error( _TXT("zstd seek table does not match the frames in the input"));
+	}
+}
+
+void DecompressingInputStream::startThreads( int nofThreads)
+{
+	m_slots.resize( 4 * nofThreads);
+	int ti = 0;
+	for (; ti < nofThreads; ++ti)
+	{
+		m_threads.push_back( new strus::thread( &DecompressingInputStream::runDecoder, this));
+	}
+}
+
+void DecompressingInputStream::decodeBlock( std::string& res, const Block& block)
+{
+	const char* src = m_file.ptr() + block.offset;
+	if (m_type == CompressionBzip2)
+	{
+		decodeBzip2( res, src, block.size);
+	}
+	else
+	{
+		res.resize( block.decompressedSize);
+		std::size_t nn = ZSTD_decompress( res.empty() ? NULL : &res[0], res.size(), src, block.size);
+		if (ZSTD_isError( nn))
+		{
+			throw std::runtime_error( strus::string_format( _TXT("zstd decompression error: %s"), ZSTD_getErrorName( nn)));
+		}
+		if (nn != block.decompressedSize)
+		{
+			throw std::runtime_error( _TXT("zstd frame size does not match the seek table"));
+		}
+	}
+}
+
+void DecompressingInputStream::runDecoder()
+{
+	for (;;)
+	{
+		std::size_t blockidx;
+		{
+			strus::unique_lock lock( m_mutex);
+			while (!m_terminate && m_nextBlock < m_blocks.size() && m_nextBlock >= m_readBlock + m_slots.size())
+			{
+				m_cv_consumed.wait( lock);
+			}
+			if (m_terminate || m_nextBlock >= m_blocks.size()) return;
+			blockidx = m_nextBlock++;
+		}
+		std::string content;
+		std::string error;
+		try
+		{
+			decodeBlock( content, m_blocks[ blockidx]);
+		}
+		catch (const std::bad_alloc&)
+		{
+			error = _TXT("out of memory decompressing input");
+		}
+		catch (const std::runtime_error& err)
+		{
+			error = err.what();
+		}
+		strus::unique_lock lock( m_mutex);
+		if (!error.empty())
+		{
+			if (m_error.empty()) m_error = error;
+			m_terminate = true;
+			m_cv_ready.notify_all();
+			m_cv_consumed.notify_all();
+			return;
+		}
+		Slot& slot = m_slots[ blockidx % m_slots.size()];
+		slot.content.swap( content);
+		slot.ready = true;
+		m_cv_ready.notify_all();
+	}
+}
+
+std::size_t DecompressingInputStream::readParallel( char* buf, std::size_t bufsize)
+{
+	std::size_t rt = 0;
+	while (rt < bufsize && m_readBlock < m_blocks.size())
+	{
+		Slot& slot = m_slots[ m_readBlock % m_slots.size()];
+		{
+			strus::unique_lock lock( m_mutex);
+			while (!slot.ready && m_error.empty())
+			{
+				m_cv_ready.wait( lock);
+			}
+			if (!m_error.empty()) throw std::runtime_error( m_error);
+		}
+		// ... the slot content is not touched by decoder threads as long as it is marked as ready
+		std::size_t nn = std::min( bufsize - rt, slot.content.size() - m_readPos);
+		std::memcpy( buf + rt, slot.content.c_str() + m_readPos, nn);
+		rt += nn;
+		m_readPos += nn;
+		if (m_readPos == slot.content.size())
+		{
+			strus::unique_lock lock( m_mutex);
+			std::string().swap( slot.content);
+			slot.ready = false;
+			m_readPos = 0;
+			++m_readBlock;
+			m_cv_consumed.notify_all();
+		}
+	}
+	return rt;
+}
+
+std::size_t DecompressingInputStream::readSequential( char* buf, std::size_t bufsize)
+{
+	std::size_t rt = 0;
+	if (m_type == CompressionBzip2)
+	{
+		enum {FeedSize = 1<<20};
+		bz_stream* strm = (bz_stream*)m_stream;
+		while (rt < bufsize && !m_streamEnd)
+		{
+			if (strm->avail_in == 0 && m_streamPos < m_file.size())
+			{
+				std::size_t nn = std::min( (std::size_t)FeedSize, m_file.size() - m_streamPos);
+				strm->next_in = const_cast<char*>( m_file.ptr() + m_streamPos);
+				strm->avail_in = nn;
+				m_streamPos += nn;
+			}
+			std::size_t outsize = std::min( bufsize - rt, (std::size_t)std::numeric_limits<unsigned int>::max());
+			strm->next_out = buf + rt;
+			strm->avail_out = outsize;
+			int ec = BZ2_bzDecompress( strm);
+			rt += outsize - strm->avail_out;
+			if (ec == BZ_STREAM_END)
+			{
+				if (strm->avail_in == 0 && m_streamPos == m_file.size())
+				{
+					m_streamEnd = true;
+				}
+				else
+				{
+					//... concatenated stream follows (multistream)
+					char* next_in = strm->next_in;
+					unsigned int avail_in = strm->avail_in;
+					BZ2_bzDecompressEnd( strm);
+					initBzip2Stream( strm);
+					strm->next_in = next_in;
+					strm->avail_in = avail_in;
+				}
+			}
+			else if (ec != BZ_OK)
+			{
+				throw std::runtime_error( strus::string_format( _TXT("bzip2 decompression error %d"), ec));
+			}
+			else if (strm->avail_in == 0 && m_streamPos == m_file.size() && strm->avail_out == outsize)
+			{
+				throw std::runtime_error( _TXT("unexpected end of bzip2 input"));
+			}
+		}
+	}
+	else
+	{
+		ZSTD_DStream* zds = (ZSTD_DStream*)m_stream;
+		ZSTD_inBuffer input = {m_file.ptr(), m_file.size(), m_streamPos};
+		ZSTD_outBuffer output = {buf, bufsize, 0};
+		while (output.pos < output.size && !(m_streamEnd && input.pos == input.size))
+		{
+			std::size_t outpos = output.pos;
+			std::size_t ec = ZSTD_decompressStream( zds, &output, &input);
+			if (ZSTD_isError( ec))
+			{
+				throw std::runtime_error( strus::string_format( _TXT("zstd decompression error: %s"), ZSTD_getErrorName( ec)));
+			}
+			m_streamEnd = (ec == 0);
+			if (!m_streamEnd && input.pos == input.size && output.pos == outpos)
+			{
+				throw std::runtime_error( _TXT("unexpected end of zstd input"));
+			}
+		}
+		m_streamPos = input.pos;
+		rt = output.pos;
+	}
+	return rt;
+}
+
+std::size_t DecompressingInputStream::read( void* buf, std::size_t bufsize)
+{
+	std::size_t rt;
+	if (m_threads.empty())
+	{
+		rt = readSequential( (char*)buf, bufsize);
+		m_position.set( m_streamPos);
+	}
+	else
+	{
+		rt = readParallel( (char*)buf, bufsize);
+		m_position.set( m_readBlock < m_blocks.size() ? m_blocks[ m_readBlock].offset : m_file.size());
+	}
+	return rt;
+}
+
+int DecompressingInputStream::errorcode() const
+{
+	return 0;
+}
+
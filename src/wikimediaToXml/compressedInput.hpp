@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Input stream decompressing a bzip2 or zstd compressed Wikipedia dump, in parallel if the dump consists of independent blocks
+/// \file compressedInput.hpp
+#ifndef _STRUS_WIKIPEDIA_COMPRESSED_INPUT_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_COMPRESSED_INPUT_HPP_INCLUDED
+#include "textwolf/istreamiterator.hpp"
+#include "strus/base/thread.hpp"
+#include "strus/base/atomic.hpp"
+#include "memoryMappedFile.hpp"
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+enum CompressionType {CompressionNone, CompressionBzip2, CompressionZstd};
+
+/// \brief Get the compression type of a file by its magic number
+/// \param[in] filename path of the file to inspect
+CompressionType getFileCompressionType( const std::string& filename);
+
+/// \brief Input stream decompressing a bzip2 or zstd compressed file
+/// \note A bzip2 multistream dump with its index file (offset:pageid:title per line, plain or bzip2 compressed) or a zstd file in the seekable format is decompressed block by block by parallel threads. Other compressed files are decompressed sequentially while reading.
+class DecompressingInputStream
+	:public textwolf::IStream
+{
+public:
+	/// \brief Constructor
+	/// \param[in] filename path of the compressed file
+	/// \param[in] indexfilename path of the index file of a bzip2 multistream dump or empty
+	/// \param[in] nofThreads number of decompression threads for parallel decompression
+	DecompressingInputStream( const std::string& filename, const std::string& indexfilename, int nofThreads);
+	virtual ~DecompressingInputStream();
+
+	virtual std::size_t read( void* buf, std::size_t bufsize);
+	virtual int errorcode() const;
+
+	/// \brief Get true, if the input is decompressed by parallel threads
+	bool parallel() const			{return !m_threads.empty();}
+	/// \brief Get the number of independent blocks decompressed in parallel
+	std::size_t nofBlocks() const		{return m_blocks.size();}
+	/// \brief Get the number of bytes of the compressed file consumed by the reader, for reporting the progress
+	/// \note Thread safe, can be called while another thread reads. The position is advanced block by block if the input is decompressed in parallel
+	uint64_t position() const		{return m_position.value();}
+
+private:
+	struct Block
+	{
+		std::size_t offset;
+		std::size_t size;
+		std::size_t decompressedSize;
+
+		Block( std::size_t offset_, std::size_t size_, std::size_t decompressedSize_)
+			:offset(offset_),size(size_),decompressedSize(decompressedSize_){}
+		Block( const Block& o)
+			:offset(o.offset),size(o.size),decompressedSize(o.decompressedSize){}
+	};
+	struct Slot
+	{
+		bool ready;
+		std::string content;
+
+		Slot()
+			:ready(false),content(){}
+		Slot( const Slot& o)
+			:ready(o.ready),content(o.content){}
+	};
+
+	void initBzip2Blocks( const std::string& indexfilename);
+	void initZstdBlocks();
+	void startThreads( int nofThreads);
+	void runDecoder();
+	void decodeBlock( std::string& res, const Block& block);
+	std::size_t readParallel( char* buf, std::size_t bufsize);
+	std::size_t readSequential( char* buf, std::size_t bufsize);
+
+private:
+	DecompressingInputStream( const DecompressingInputStream&);	//... non copyable
+	void operator=( const DecompressingInputStream&);		//... non copyable
+
+private:
+	MemoryMappedFile m_file;
+	CompressionType m_type;
+	std::vector<Block> m_blocks;
+	std::vector<Slot> m_slots;			///< ring buffer of decompressed blocks, block i in slot i % window size
+	std::size_t m_nextBlock;			///< next block to decompress
+	std::size_t m_readBlock;			///< block currently read
+	std::size_t m_readPos;				///< read position in the block currently read
+	std::string m_error;				///< error of a decompression thread
+	bool m_terminate;
+	strus::mutex m_mutex;
+	strus::condition_variable m_cv_ready;		///< signalled when a block has been decompressed
+	strus::condition_variable m_cv_consumed;	///< signalled when a block has been consumed
+	std::vector<strus::thread*> m_threads;
+	void* m_stream;					///< sequential decompression stream state
+	std::size_t m_streamPos;			///< input position of the sequential decompression
+	bool m_streamEnd;
+	strus::AtomicCounter<uint64_t> m_position;	///< bytes of the compressed file consumed by the reader
+};
+
+}//namespace
+#endif
+
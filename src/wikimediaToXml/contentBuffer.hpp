@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Reference counted chunk buffers for passing document content to conversion threads without copying it
+/// \file contentBuffer.hpp
+#ifndef _STRUS_WIKIPEDIA_CONTENT_BUFFER_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_CONTENT_BUFFER_HPP_INCLUDED
+#include "strus/base/shared_ptr.hpp"
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <new>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Chunk of memory holding the content of multiple documents
+/// \note Written by one thread only, the chunk is freed when the last document referencing it has been processed
+class ContentChunk
+{
+public:
+	explicit ContentChunk( std::size_t allocsize_)
+		:m_buf((char*)std::malloc( allocsize_)),m_allocsize(allocsize_),m_size(0)
+	{
+		if (!m_buf) throw std::bad_alloc();
+	}
+	~ContentChunk()
+	{
+		std::free( m_buf);
+	}
+
+	/// \brief Copy a string into the chunk
+	/// \return pointer to the copy or NULL if the chunk has not enough space left
+	const char* append( const char* ptr, std::size_t size)
+	{
+		if (m_size + size + 1 > m_allocsize) return NULL;
+		char* rt = m_buf + m_size;
+		std::memcpy( rt, ptr, size);
+		rt[ size] = '\0';
+		m_size += size + 1;
+		return rt;
+	}
+
+private:
+	ContentChunk( const ContentChunk&){}	//... non copyable
+	void operator=( const ContentChunk&){}	//... non copyable
+
+private:
+	char* m_buf;
+	std::size_t m_allocsize;
+	std::size_t m_size;
+};
+
+typedef strus::shared_ptr<ContentChunk> ContentChunkRef;
+
+/// \brief Reference to a string in a content chunk, keeping the chunk alive
+/// \note Strings allocated in a chunk are 0-terminated, strings referenced in place are not
+class ContentRef
+{
+public:
+	ContentRef()
+		:m_chunk(),m_ptr(""),m_size(0){}
+	ContentRef( const ContentChunkRef& chunk_, const char* ptr_, std::size_t size_)
+		:m_chunk(chunk_),m_ptr(ptr_),m_size(size_){}
+	/// \brief Reference to memory not owned by a chunk, that is valid as long as the reference is used (memory mapped input)
+	ContentRef( const char* ptr_, std::size_t size_)
+		:m_chunk(),m_ptr(ptr_),m_size(size_){}
+	ContentRef( const ContentRef& o)
+		:m_chunk(o.m_chunk),m_ptr(o.m_ptr),m_size(o.m_size){}
+
+	const char* ptr() const				{return m_ptr;}
+	std::size_t size() const			{return m_size;}
+	bool empty() const				{return m_size == 0;}
+	std::string tostring() const			{return std::string( m_ptr, m_size);}
+
+	void clear()
+	{
+		m_chunk.reset();
+		m_ptr = "";
+		m_size = 0;
+	}
+
+private:
+	ContentChunkRef m_chunk;
+	const char* m_ptr;
+	std::size_t m_size;
+};
+
+/// \brief Allocator of document content in reference counted chunks
+class ContentAllocator
+{
+public:
+	enum {ChunkSize = (1<<22)};
+
+	ContentAllocator()
+		:m_chunk(){}
+
+	/// \brief Copy a string into a chunk
+	/// \note A document bigger than the chunk size gets a chunk of its own
+	ContentRef alloc( const char* ptr, std::size_t size)
+	{
+		const char* rt = m_chunk.get() ? m_chunk->append( ptr, size) : NULL;
+		if (!rt)
+		{
+			m_chunk.reset( new ContentChunk( size + 1 > (std::size_t)ChunkSize ? (size + 1) : (std::size_t)ChunkSize));
+			rt = m_chunk->append( ptr, size);
+		}
+		return ContentRef( m_chunk, rt, size);
+	}
+
+private:
+	ContentChunkRef m_chunk;
+};
+
+}//namespace
+#endif
+
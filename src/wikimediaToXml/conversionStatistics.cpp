@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Time and counters of the stages of the conversion collected per thread and reported as JSON (option --stats)
+/// \file conversionStatistics.cpp
+#include "conversionStatistics.hpp"
+#include "strus/base/string_format.hpp"
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+
+using namespace strus;
+
+static const char* g_stageNames[ NofConversionStages] = {"xmlscan","lexer","parse","finish","toxml","output","diagnostics","queue_push","queue_fetch"};
+
+static double getTimeSeconds()
+{
+	struct timespec ts;
+	::clock_gettime( CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+ThreadStatistics::ThreadStatistics( const std::string& name_, int nofSlowest_)
+	:m_name(name_),m_scannedBytes(0),m_inputBytes(0),m_outputBytes(0),m_nofDocuments(0),m_nofSlowest(nofSlowest_),m_slowest()
+{
+	std::memset( m_ticks, 0, sizeof(m_ticks));
+	std::memset( m_calls, 0, sizeof(m_calls));
+}
+
+void ThreadStatistics::addDocument( const std::string& title, std::size_t size, StatisticsTicks ticks)
+{
+	++m_nofDocuments;
+	m_inputBytes += size;
+	addSlowest( DocumentTime( title, size, ticks));
+}
+
+void ThreadStatistics::addSlowest( const DocumentTime& doc)
+{
+	if ((int)m_slowest.size() < m_nofSlowest)
+	{
+		m_slowest.push_back( doc);
+		std::push_heap( m_slowest.begin(), m_slowest.end());
+	}
+	else if (m_nofSlowest > 0 && doc.ticks > m_slowest.front().ticks)
+	{
+		std::pop_heap( m_slowest.begin(), m_slowest.end());
+		m_slowest.back() = doc;
+		std::push_heap( m_slowest.begin(), m_slowest.end());
+	}
+}
+
+void ThreadStatistics::merge( const ThreadStatistics& o)
+{
+	int si = 0;
+	for (; si < NofConversionStages; ++si)
+	{
+		m_ticks[ si] += o.m_ticks[ si];
+		m_calls[ si] += o.m_calls[ si];
+	}
+	m_scannedBytes += o.m_scannedBytes;
+	m_inputBytes += o.m_inputBytes;
+	m_outputBytes += o.m_outputBytes;
+	m_nofDocuments += o.m_nofDocuments;
+	std::vector<DocumentTime>::const_iterator di = o.m_slowest.begin(), de = o.m_slowest.end();
+	for (; di != de; ++di)
+	{
+		addSlowest( *di);
+	}
+}
+
+std::vector<ThreadStatistics::DocumentTime> ThreadStatistics::slowestDocuments() const
+{
+	std::vector<DocumentTime> rt( m_slowest);
+	//... the heap order puts the fastest document first, so the sorted list has the slowest first
+	std::sort( rt.begin(), rt.end());
+	return rt;
+}
+
+ConversionStatistics::ConversionStatistics( int nofSlowest_)
+	:m_nofSlowest(nofSlowest_),m_startTicks(getStatisticsTicks()),m_startTime(getTimeSeconds()),m_mutex(),m_threads(){}
+
+ConversionStatistics::~ConversionStatistics()
+{
+	std::vector<ThreadStatistics*>::iterator ti = m_threads.begin(), te = m_threads.end();
+	for (; ti != te; ++ti) delete *ti;
+}
+
+ThreadStatistics* ConversionStatistics::createThreadStatistics( const std::string& name)
+{
+	strus::unique_lock lock( m_mutex);
+	ThreadStatistics* rt = new ThreadStatistics( name, m_nofSlowest);
+	m_threads.push_back( rt);
+	return rt;
+}
+
+/// \brief Append a string as JSON string literal
+static void appendJsonString( std::string& buf, const std::string& str)
+{
+	buf.push_back( '"');
+	std::string::const_iterator si = str.begin(), se = str.end();
+	for (; si != se; ++si)
+	{
+		unsigned char ch = *si;
+		if (ch == '"' || ch == '\\')
+		{
+			buf.push_back( '\\');
+			buf.push_back( ch);
+		}
+		else if (ch < 32)
+		{
+			char hex[ 8];
+			std::snprintf( hex, sizeof(hex), "\\u%04x", (unsigned int)ch);
+			buf.append( hex);
+		}
+		else
+		{
+			buf.push_back( ch);
+		}
+	}
+	buf.push_back( '"');
+}
+
+/// \brief Append the time and the number of calls of the stages as JSON object
+static void appendJsonStages( std::string& buf, const ThreadStatistics& stats, double secondsPerTick, const char* indent)
+{
+	buf.append( "{");
+	int si = 0;
+	for (; si < NofConversionStages; ++si)
+	{
+		ConversionStage stage = (ConversionStage)si;
+		buf.append( strus::string_format( "%s\n%s\t\"%s\": {\"seconds\": %.6f, \"calls\": %llu}",
+				si ? "," : "", indent, g_stageNames[ si],
+				(double)stats.ticks( stage) * secondsPerTick, (unsigned long long)stats.calls( stage)));
+	}
+	buf.append( strus::string_format( "\n%s}", indent));
+}
+
+std::string ConversionStatistics::tojson() const
+{
+	double elapsed = getTimeSeconds() - m_startTime;
+	StatisticsTicks elapsedTicks = getStatisticsTicks() - m_startTicks;
+	//... the ticks are converted to seconds with the rate measured over the whole conversion
+	double secondsPerTick = elapsedTicks ? elapsed / (double)elapsedTicks : 0.0;
+
+	ThreadStatistics total( "total", m_nofSlowest);
+	std::vector<ThreadStatistics*>::const_iterator ti = m_threads.begin(), te = m_threads.end();
+	for (; ti != te; ++ti)
+	{
+		total.merge( **ti);
+	}
+	double lexerSeconds = (double)total.ticks( StageLexer) * secondsPerTick;
+	std::string rt;
+	rt.append( strus::string_format(
+			"{\n"
+			"\t\"elapsed_seconds\": %.6f,\n"
+			"\t\"documents\": %d,\n"
+			"\t\"scanned_bytes\": %llu,\n"
+			"\t\"input_bytes\": %llu,\n"
+			"\t\"output_bytes\": %llu,\n"
+			"\t\"lexems\": %llu,\n"
+			"\t\"lexems_per_second\": %.1f,\n"
+			"\t\"stages\": ",
+			elapsed, total.nofDocuments(),
+			(unsigned long long)total.scannedBytes(), (unsigned long long)total.inputBytes(), (unsigned long long)total.outputBytes(),
+			(unsigned long long)total.calls( StageLexer), lexerSeconds > 0.0 ? (double)total.calls( StageLexer) / lexerSeconds : 0.0));
+	appendJsonStages( rt, total, secondsPerTick, "\t");
+	rt.append( ",\n\t\"threads\": [");
+	for (ti = m_threads.begin(); ti != te; ++ti)
+	{
+		rt.append( ti == m_threads.begin() ? "\n\t\t{\"name\": " : ",\n\t\t{\"name\": ");
+		appendJsonString( rt, (*ti)->name());
+		rt.append( strus::string_format( ", \"documents\": %d, \"stages\": ", (*ti)->nofDocuments()));
+		appendJsonStages( rt, **ti, secondsPerTick, "\t\t");
+		rt.append( "}");
+	}
+	rt.append( "\n\t],\n\t\"slowest_documents\": [");
+	std::vector<ThreadStatistics::DocumentTime> slowest = total.slowestDocuments();
+	std::vector<ThreadStatistics::DocumentTime>::const_iterator di = slowest.begin(), de = slowest.end();
+	for (; di != de; ++di)
+	{
+		rt.append( di == slowest.begin() ? "\n\t\t{\"title\": " : ",\n\t\t{\"title\": ");
+		appendJsonString( rt, di->title);
+		rt.append( strus::string_format( ", \"bytes\": %llu, \"seconds\": %.6f}", (unsigned long long)di->size, (double)di->ticks * secondsPerTick));
+	}
+	rt.append( "\n\t]\n}\n");
+	return rt;
+}
+
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Time and counters of the stages of the conversion collected per thread and reported as JSON (option --stats)
+/// \file conversionStatistics.hpp
+#ifndef _STRUS_WIKIPEDIA_CONVERSION_STATISTICS_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_CONVERSION_STATISTICS_HPP_INCLUDED
+#include "strus/base/thread.hpp"
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+#include <time.h>
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <x86intrin.h>
+#define STRUS_CONVERSION_STATISTICS_RDTSC
+#endif
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Stages of the conversion measured
+enum ConversionStage
+{
+	StageXmlScan,		///< reading and scanning the XML of the dump, without the processing of the pages found
+	StageLexer,		///< lexing the Wikimedia text of a document (WikimediaLexer::next)
+	StageParse,		///< building the document structure from the lexems (parseDocumentText without the lexer)
+	StageFinish,		///< finishing the document structure (DocumentStructure::finish)
+	StageToXml,		///< serialization of a document (DocumentStructure::toxml) without writing the output
+	StageOutput,		///< writing the XML output of a document
+	StageDiagnostics,	///< reporting the diagnostics of a document (.wtf, .err, .mis and dump files)
+	StageQueuePush,		///< scanner waiting for space in the queue of the conversion threads
+	StageQueueFetch		///< conversion thread waiting for a document to convert
+};
+enum {NofConversionStages=StageQueueFetch+1};
+
+/// \brief Timestamp in ticks of a clock cheap to read, converted to seconds only for the report
+typedef uint64_t StatisticsTicks;
+
+/// \brief Get the current timestamp in ticks
+/// \note Uses the time stamp counter of the CPU where available, the monotonic clock in nanoseconds else
+inline StatisticsTicks getStatisticsTicks()
+{
+#ifdef STRUS_CONVERSION_STATISTICS_RDTSC
+	return __rdtsc();
+#else
+	struct timespec ts;
+	::clock_gettime( CLOCK_MONOTONIC, &ts);
+	return (StatisticsTicks)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+}
+
+/// \brief Counters of one thread, updated without synchronization by the thread owning them
+class ThreadStatistics
+{
+public:
+	/// \brief Document with the time of its conversion
+	struct DocumentTime
+	{
+		std::string title;
+		std::size_t size;
+		StatisticsTicks ticks;
+
+		DocumentTime( const std::string& title_, std::size_t size_, StatisticsTicks ticks_)
+			:title(title_),size(size_),ticks(ticks_){}
+		DocumentTime( const DocumentTime& o)
+			:title(o.title),size(o.size),ticks(o.ticks){}
+		/// \brief Order for a heap with the fastest document on top
+		bool operator < (const DocumentTime& o) const
+		{
+			return ticks > o.ticks;
+		}
+	};
+
+	/// \param[in] name_ name of the thread in the report
+	/// \param[in] nofSlowest_ number of the slowest documents kept
+	ThreadStatistics( const std::string& name_, int nofSlowest_);
+
+	/// \brief Add the time of one or more calls of a stage
+	void addTicks( ConversionStage stage, StatisticsTicks ticks, int nofCalls=1)
+	{
+		m_ticks[ stage] += ticks;
+		m_calls[ stage] += nofCalls;
+	}
+	/// \brief Add the number of bytes of the XML dump scanned
+	void addScannedBytes( std::size_t size)		{m_scannedBytes += size;}
+	/// \brief Add the number of bytes of the XML output of a document
+	void addOutputBytes( std::size_t size)		{m_outputBytes += size;}
+	/// \brief Count a document converted
+	/// \param[in] title title of the document
+	/// \param[in] size size of the Wikimedia text of the document in bytes
+	/// \param[in] ticks time of the conversion
+	void addDocument( const std::string& title, std::size_t size, StatisticsTicks ticks);
+
+	/// \brief Add the counters of another thread
+	void merge( const ThreadStatistics& o);
+
+	const std::string& name() const				{return m_name;}
+	StatisticsTicks ticks( ConversionStage stage) const	{return m_ticks[ stage];}
+	uint64_t calls( ConversionStage stage) const		{return m_calls[ stage];}
+	uint64_t scannedBytes() const				{return m_scannedBytes;}
+	uint64_t inputBytes() const				{return m_inputBytes;}
+	uint64_t outputBytes() const				{return m_outputBytes;}
+	int nofDocuments() const				{return m_nofDocuments;}
+	/// \brief Get the slowest documents, the slowest first
+	std::vector<DocumentTime> slowestDocuments() const;
+
+private:
+	void addSlowest( const DocumentTime& doc);
+
+private:
+	ThreadStatistics( const ThreadStatistics&);		//... non copyable
+	void operator=( const ThreadStatistics&);		//... non copyable
+
+private:
+	std::string m_name;
+	StatisticsTicks m_ticks[ NofConversionStages];
+	uint64_t m_calls[ NofConversionStages];
+	uint64_t m_scannedBytes;
+	uint64_t m_inputBytes;
+	uint64_t m_outputBytes;
+	int m_nofDocuments;
+	int m_nofSlowest;
+	std::vector<DocumentTime> m_slowest;		///< heap of the slowest documents with the fastest of them on top
+};
+
+/// \brief Measures the time of a stage from construction until stop() is called or until destruction, if the statistics of the thread are collected
+class StageTimer
+{
+public:
+	/// \param[in] stats_ statistics of the calling thread or NULL if not collected
+	/// \param[in] stage_ stage measured
+	StageTimer( ThreadStatistics* stats_, ConversionStage stage_)
+		:m_stats(stats_),m_stage(stage_),m_start(stats_ ? getStatisticsTicks() : 0){}
+	~StageTimer()
+	{
+		stop();
+	}
+
+	/// \brief Stop the measurement and add it to the statistics, if not stopped yet
+	/// \param[in] excluded ticks of nested operations measured separately and not added to this stage
+	void stop( StatisticsTicks excluded=0)
+	{
+		if (m_stats)
+		{
+			StatisticsTicks elapsed = getStatisticsTicks() - m_start;
+			m_stats->addTicks( m_stage, elapsed > excluded ? elapsed - excluded : 0);
+			m_stats = 0;
+		}
+	}
+
+private:
+	StageTimer( const StageTimer&);			//... non copyable
+	void operator=( const StageTimer&);		//... non copyable
+
+private:
+	ThreadStatistics* m_stats;
+	ConversionStage m_stage;
+	StatisticsTicks m_start;
+};
+
+/// \brief Statistics of all threads of a conversion, merged for the report at the end
+class ConversionStatistics
+{
+public:
+	/// \param[in] nofSlowest_ number of the slowest documents reported
+	explicit ConversionStatistics( int nofSlowest_);
+	~ConversionStatistics();
+
+	/// \brief Create the statistics of a thread, owned by this
+	/// \note Thread safe
+	ThreadStatistics* createThreadStatistics( const std::string& name);
+
+	/// \brief Get the report as JSON with the counters of all threads merged and the counters of every thread
+	/// \note The time of the stages is summed up over all threads, the elapsed time is measured since the construction of this
+	/// \note Must not be called before all threads updating the statistics are terminated
+	std::string tojson() const;
+
+private:
+	ConversionStatistics( const ConversionStatistics&);	//... non copyable
+	void operator=( const ConversionStatistics&);		//... non copyable
+
+private:
+	int m_nofSlowest;
+	StatisticsTicks m_startTicks;
+	double m_startTime;
+	strus::mutex m_mutex;
+	std::vector<ThreadStatistics*> m_threads;
+};
+
+}//namespace
+#endif
+
@@ -0,0 +1,489 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Building the document structure from the lexems of a Wikimedia document
+/// \file documentParser.cpp
+#include "documentParser.hpp"
+#include "documentStructure.hpp"
+#include "wikimediaLexer.hpp"
+#include "linkMap.hpp"
+#include "outputString.hpp"
+#include "conversionStatistics.hpp"
+#include "strus/base/string_conv.hpp"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <map>
+
+using namespace strus;
+
+static std::string attributesToString( const strus::WikimediaLexem& lexem)
+{
+	std::ostringstream out;
+	std::map<std::string,std::string> attributes;
+	for (int aidx=0; aidx < lexem.nofAttributes; ++aidx)
+	{
+		attributes[ lexem.attributes[ aidx].name] = lexem.attributes[ aidx].value;
+	}
+	std::map<std::string,std::string>::const_iterator ai = attributes.begin(), ae = attributes.end();
+	for (int aidx=0; ai != ae; ++ai,++aidx)
+	{
+		if (aidx) out << ", ";
+		out << ai->first << "='" << ai->second << "'";
+	}
+	return out.str();
+}
+
+static std::string getLinkDomainPrefix( const std::string& lnk, int maxsize)
+{
+	char const* si = lnk.c_str();
+	while (maxsize > 0 && (*si|32) >= 'a' && (*si|32) <= 'z') {++si;--maxsize;}
+	if (*si == ':')
+	{
+		return strus::string_conv::tolower( lnk.c_str(), si - lnk.c_str());
+	}
+	else
+	{
+		return std::string();
+	}
+}
+
+namespace {
+/// \brief Measurement of the lexer and of the parser of a document, added to the statistics of the thread on destruction
+class ParserMeasurement
+{
+public:
+	explicit ParserMeasurement( strus::ThreadStatistics* stats_)
+		:m_stats(stats_),m_start(stats_ ? strus::getStatisticsTicks() : 0),m_lexerTicks(0),m_nofLexems(0){}
+	~ParserMeasurement()
+	{
+		if (m_stats)
+		{
+			strus::StatisticsTicks elapsed = strus::getStatisticsTicks() - m_start;
+			m_stats->addTicks( strus::StageLexer, m_lexerTicks, m_nofLexems);
+			m_stats->addTicks( strus::StageParse, elapsed > m_lexerTicks ? elapsed - m_lexerTicks : 0);
+		}
+	}
+
+	/// \brief Get the next lexem, measuring the time of the lexer if the statistics are collected
+	strus::WikimediaLexem next( strus::WikimediaLexer& lexer)
+	{
+		if (!m_stats) return lexer.next();
+		strus::StatisticsTicks start = strus::getStatisticsTicks();
+		strus::WikimediaLexem rt = lexer.next();
+		m_lexerTicks += strus::getStatisticsTicks() - start;
+		++m_nofLexems;
+		return rt;
+	}
+
+private:
+	strus::ThreadStatistics* m_stats;
+	strus::StatisticsTicks m_start;
+	strus::StatisticsTicks m_lexerTicks;
+	int m_nofLexems;
+};
+}//anonymous namespace
+
+void strus::parseDocumentText( strus::DocumentStructure& doc, const char* src, std::size_t size, const strus::LinkMap* linkmap, bool deferLinks, bool verbose, strus::ThreadStatistics* statistics)
+{
+	strus::WikimediaLexer lexer(src,size);
+	ParserMeasurement measurement( statistics);
+	int lexemidx = 0;
+	int lastHeading = 1;
+	bool pendingTextBreak = false;
+
+	for (strus::WikimediaLexem lexem = measurement.next( lexer); lexem.id != strus::WikimediaLexem::EoF; lexem = measurement.next( lexer),++lexemidx)
+	{
+		if (verbose)
+		{
+			std::cout << "STATE " << doc.statestring() << std::endl;
+			std::cout << lexemidx << " LEXEM " << strus::WikimediaLexem::idName( lexem.id) << " " << strus::outputLineString( lexem.value.ptr(), lexem.value.ptr() + lexem.value.size());
+			if (lexem.nofAttributes) std::cout << " -- " << attributesToString( lexem);
+			std::cout << std::endl;
+		}
+		switch (lexem.id)
+		{
+			case strus::WikimediaLexem::EoF:
+				break;
+			case strus::WikimediaLexem::Error:
+				doc.addError( std::string("syntax error in document: ") + strus::outputLineString( lexem.value.ptr(), lexem.value.ptr() + lexem.value.size()));
+				break;
+			case strus::WikimediaLexem::Text:
+				if (pendingTextBreak) doc.addTextBreak();
+				doc.addText( lexem.value);
+				break;
+			case strus::WikimediaLexem::String:
+				doc.closeOpenQuoteItems();
+				doc.addQuotationMarker();
+				doc.addText( lexem.value);
+				doc.addQuotationMarker();
+				break;
+			case strus::WikimediaLexem::Char:
+				doc.addChar( lexem.value);
+				break;
+			case strus::WikimediaLexem::Math:
+				doc.addMath( lexem.value);
+				break;
+			case strus::WikimediaLexem::BibRef:
+				doc.addBibRef( lexem.value);
+				break;
+			case strus::WikimediaLexem::NoWiki:
+				doc.addNoWiki( lexem.value);
+				break;
+			case strus::WikimediaLexem::NoData:
+				doc.addError( std::string("lexem can not be treated as data: ") + strus::outputLineString( lexem.value.ptr(), lexem.value.ptr() + lexem.value.size()));
+				break;
+			case strus::WikimediaLexem::Code:
+				doc.addCode( lexem.value);
+				break;
+			case strus::WikimediaLexem::Timestamp:
+				doc.addTimestamp( lexem.value);
+				break;
+			case strus::WikimediaLexem::Url:
+				doc.openWebLink( lexem.value);
+				doc.closeWebLink();
+				break;
+			case strus::WikimediaLexem::Redirect:
+				doc.addError( "unexpected redirect in document");
+				break;
+			case strus::WikimediaLexem::Markup:
+				doc.addMarkup( lexem.value);
+				break;
+			case strus::WikimediaLexem::OpenHeading:
+				doc.openHeading( lastHeading = (int)lexem.idx);
+				break;
+			case strus::WikimediaLexem::CloseHeading:
+				doc.closeHeading();
+				break;
+			case strus::WikimediaLexem::OpenRef:
+				doc.openRef();
+				break;
+			case strus::WikimediaLexem::CloseRef:
+				doc.closeRef();
+				break;
+			case strus::WikimediaLexem::HeadingItem:
+				doc.addHeadingItem();
+				break;
+			case strus::WikimediaLexem::ListItem:
+				doc.openListItem( (int)lexem.idx);
+				break;
+			case strus::WikimediaLexem::EndOfLine:
+				doc.closeOpenEolnItem();
+				doc.addBreak();
+				break;
+			case strus::WikimediaLexem::QuotationMarker:
+				doc.addQuotationMarker();
+				break;
+			case strus::WikimediaLexem::MultiQuoteMarker:
+				doc.addMultiQuoteMarker( (int)lexem.idx);
+				break;
+			case strus::WikimediaLexem::OpenSpan:
+				doc.openSpan();
+				break;
+			case strus::WikimediaLexem::CloseSpan:
+				doc.closeSpan();
+				break;
+			case strus::WikimediaLexem::OpenFormat:
+				doc.openFormat();
+				break;
+			case strus::WikimediaLexem::CloseFormat:
+				doc.closeFormat();
+				break;
+			case strus::WikimediaLexem::OpenBlockQuote:
+				doc.openBlockQuote();
+				break;
+			case strus::WikimediaLexem::CloseBlockQuote:
+				doc.closeBlockQuote();
+				break;
+			case strus::WikimediaLexem::OpenDiv:
+				doc.openDiv();
+				break;
+			case strus::WikimediaLexem::CloseDiv:
+				doc.closeDiv();
+				break;
+			case strus::WikimediaLexem::OpenPoem:
+				doc.openPoem();
+				break;
+			case strus::WikimediaLexem::ClosePoem:
+				doc.closePoem();
+				break;
+			case strus::WikimediaLexem::OpenCitation:
+				doc.openCitation( lexem.value);
+				break;
+			case strus::WikimediaLexem::CloseCitation:
+				doc.closeCitation();
+				break;
+			case strus::WikimediaLexem::OpenWWWLink:
+				doc.openWebLink( lexem.value);
+				break;
+			case strus::WikimediaLexem::CloseWWWLink:
+				doc.closeWebLink();
+				break;
+			case strus::WikimediaLexem::OpenPageLink:
+			{
+				std::pair<std::string,std::string> lnk = strus::LinkMap::getLinkParts( lexem.value);
+				std::string link = lnk.first;
+				std::string anchorid;
+				if (lnk.second.size() > 80)
+				{
+					doc.setLinkDescription( lnk.second);
+				}
+				else
+				{
+					anchorid = lnk.second;
+				}
+
+				std::string prefix = getLinkDomainPrefix( link, 12);
+				if (strus::caseInsensitiveEquals( prefix, "wikipedia"))
+				{
+					link = strus::string_conv::trim( link.c_str() + prefix.size()+1);
+				}
+				if (strus::caseInsensitiveEquals( prefix, "file")
+				||  strus::caseInsensitiveEquals( prefix, "image")
+				||  strus::caseInsensitiveEquals( prefix, "category"))
+				{
+					doc.openPageLink( link, anchorid);
+				}
+				else
+				{
+					if (linkmap)
+					{
+						const char* val = linkmap->get( link);
+						if (val)
+						{
+							doc.openPageLink( val, anchorid);
+							if (!doc.hasLinkText())
+							{
+								doc.setLinkText( link);
+							}
+						}
+						else
+						{
+							doc.addUnresolved( link);
+							doc.openPageLink( link, anchorid);
+						}
+					}
+					else if (deferLinks)
+					{
+						//... the link id is replaced by its target when the output is patched
+						doc.openPageLink( link, anchorid);
+						if (!doc.hasLinkText())
+						{
+							doc.setDeferredLinkText( link);
+						}
+					}
+					else
+					{
+						doc.openPageLink( link, anchorid);
+					}
+				}
+				break;
+			}
+			case strus::WikimediaLexem::ClosePageLink:
+				doc.closePageLink();
+				break;
+			case strus::WikimediaLexem::OpenTable:
+				doc.openTable();
+				break;
+			case strus::WikimediaLexem::CloseTable:
+				doc.closeOpenEolnItem();
+				doc.closeTable();
+				break;
+			case strus::WikimediaLexem::TableTitle:
+				doc.closeOpenEolnItem();
+				doc.implicitOpenTableIfUndefined();
+				doc.addTableTitle();
+				break;
+			case strus::WikimediaLexem::TableHeadDelim:
+			{
+				doc.closeOpenEolnItem();
+				doc.implicitOpenTableIfUndefined();
+				int colspan = lexem.colspan();
+				if (colspan <= 0)
+				{
+					doc.addError( "invalid colspan attribute value");
+					colspan = 0;
+				}
+				int rowspan = lexem.rowspan();
+				if (rowspan <= 0)
+				{
+					doc.addError( "invalid colspan attribute value");
+					rowspan = 0;
+				}
+				doc.addTableHead( rowspan, colspan);
+				break;
+			}
+			case strus::WikimediaLexem::TableRowDelim:
+				doc.closeOpenEolnItem();
+				doc.implicitOpenTableIfUndefined();
+				doc.addTableRow();
+				break;
+			case strus::WikimediaLexem::TableColDelim:
+			{
+				doc.closeOpenEolnItem();
+				strus::Paragraph::StructType tp = doc.currentStructType();
+				if (tp == strus::Paragraph::StructPageLink
+				||  tp == strus::Paragraph::StructWebLink)
+				{
+					doc.clearOpenText();
+					//... ignore last text and restart structure
+				}
+				else
+				if (tp == strus::Paragraph::StructCitation
+				||  tp == strus::Paragraph::StructRef
+				||  tp == strus::Paragraph::StructAttribute)
+				{
+					doc.addAttribute( lexem.value);
+				}
+				else if (tp == strus::Paragraph::StructNone)
+				{
+					doc.openListItem( 1);
+				}
+				else
+				{
+					int colspan = lexem.colspan();
+					if (colspan <= 0)
+					{
+						doc.addError( "invalid colspan attribute value");
+						colspan = 0;
+					}
+					int rowspan = lexem.rowspan();
+					if (rowspan <= 0)
+					{
+						doc.addError( "invalid colspan attribute value");
+						rowspan = 0;
+					}
+					doc.addTableCell( rowspan, colspan);
+				}
+				break;
+			}
+			case strus::WikimediaLexem::ColDelim:
+			{
+				doc.closeOpenQuoteItems();
+				strus::Paragraph::StructType tp = doc.currentStructType();
+				if (tp == strus::Paragraph::StructPageLink
+				||  tp == strus::Paragraph::StructWebLink)
+				{
+					doc.clearOpenText();
+					//... ignore last text and restart structure
+				}
+				else if (tp == strus::Paragraph::StructList)
+				{
+					doc.addText( " |");
+					//... ignore
+				}
+				else if (tp == strus::Paragraph::StructTableTitle)
+				{
+					doc.addTableTitle();
+				}
+				else if (tp == strus::Paragraph::StructTableHead
+					|| tp == strus::Paragraph::StructTableCell)
+				{
+					int colspan = lexem.colspan();
+					if (colspan <= 0)
+					{
+						doc.addError( "invalid colspan attribute value");
+						colspan = 0;
+					}
+					int rowspan = lexem.rowspan();
+					if (rowspan <= 0)
+					{
+						doc.addError( "invalid colspan attribute value");
+						rowspan = 0;
+					}
+					doc.repeatTableCell( rowspan, colspan);
+				}
+				else
+				{
+					doc.addAttribute( lexem.value);
+				}
+				break;
+			}
+			case strus::WikimediaLexem::DoubleColDelimNewLine:
+			case strus::WikimediaLexem::DoubleColDelim:
+			{
+				doc.disableOpenFormatAndQuotes();
+				strus::Paragraph::StructType tp = doc.currentStructType();
+				if (tp == strus::Paragraph::StructList && lexem.id == strus::WikimediaLexem::DoubleColDelimNewLine)
+				{
+					doc.closeAutoCloseItem( strus::Paragraph::ListItemStart);
+					tp = doc.currentStructType();
+				}
+				if (tp == strus::Paragraph::StructPageLink
+				||  tp == strus::Paragraph::StructWebLink)
+				{
+					doc.clearOpenText();
+					//... ignore last text and restart structure
+				}
+				else if (tp == strus::Paragraph::StructTableTitle)
+				{
+					doc.addTableTitle();
+				}
+				else if (tp == strus::Paragraph::StructTableHead
+					|| tp == strus::Paragraph::StructTableCell)
+				{
+					int colspan = lexem.colspan();
+					if (colspan <= 0)
+					{
+						doc.addError( "invalid colspan attribute value");
+						colspan = 0;
+					}
+					int rowspan = lexem.rowspan();
+					if (rowspan <= 0)
+					{
+						doc.addError( "invalid colspan attribute value");
+						rowspan = 0;
+					}
+					doc.repeatTableCell( rowspan, colspan);
+				}
+				else if (tp == strus::Paragraph::StructCitation || tp == strus::Paragraph::StructAttribute)
+				{
+					doc.addAttribute( lexem.value);
+				}
+				else if (tp == strus::Paragraph::StructTable)
+				{
+					int colspan = lexem.colspan();
+					if (colspan <= 0)
+					{
+						doc.addError( "invalid colspan attribute value");
+						colspan = 0;
+					}
+					int rowspan = lexem.rowspan();
+					if (rowspan <= 0)
+					{
+						doc.addError( "invalid colspan attribute value");
+						rowspan = 0;
+					}
+					doc.addTableCell( rowspan, colspan);
+				}
+				else if (tp == strus::Paragraph::StructList)
+				{
+					doc.addBreak();
+				}
+				else
+				{
+					doc.addError( "unexpected token '||'");
+				}
+				break;
+			}
+			case strus::WikimediaLexem::TextBreak:
+				// ... text break only splits text.
+				pendingTextBreak = true;
+				continue;
+			case strus::WikimediaLexem::Break:
+				doc.addBreak();
+				break;
+		}
+		pendingTextBreak = false;
+		if (doc.hasNewErrors())
+		{
+			doc.setErrorsSourceInfo( lexer.currentSourceExtract( 60));
+		}
+		
+	}
+}
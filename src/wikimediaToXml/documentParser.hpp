@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Building the document structure from the lexems of a Wikimedia document
+/// \file documentParser.hpp
+#ifndef _STRUS_WIKIPEDIA_DOCUMENT_PARSER_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_DOCUMENT_PARSER_HPP_INCLUDED
+#include <cstddef>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Forward declaration
+class DocumentStructure;
+/// \brief Forward declaration
+class LinkMap;
+/// \brief Forward declaration
+class ThreadStatistics;
+
+/// \brief Feed the lexems of a Wikimedia document into a document structure
+/// \param[in,out] doc document structure to build
+/// \param[in] src pointer to the Wikimedia source of the document
+/// \param[in] size size of the source in bytes
+/// \param[in] linkmap map for resolving page links or NULL if links are not resolved
+/// \param[in] deferLinks true if page links are resolved later in the XML output (see linkPatch.hpp), they are then printed like resolved links
+/// \param[in] verbose true if the states and lexems are printed to stdout
+/// \param[in] statistics statistics of the calling thread the time of the lexer and of the parser is added to or NULL if not collected
+void parseDocumentText( DocumentStructure& doc, const char* src, std::size_t size, const LinkMap* linkmap, bool deferLinks, bool verbose, ThreadStatistics* statistics);
+
+}//namespace
+#endif
+
@@ -10,6 +10,8 @@
 /// \file documentStructure.cpp
 #include "documentStructure.hpp"
 #include "outputString.hpp"
+#include "xmlEscape.hpp"
+#include "multiPatternMatcher.hpp"
 #include "textwolf/istreamiterator.hpp"
 #include "textwolf/xmlscanner.hpp"
 #include "textwolf/xmlprinter.hpp"
@@ -19,6 +21,7 @@
 #include "strus/base/numstring.hpp"
 #include "strus/base/utf8.hpp"
 #include <stdexcept>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 #include <set>
@@ -87,19 +90,36 @@ public:
 
 	void printValue( const std::string& val, std::string& buf)
 	{
-		if (!XmlPrinterBase::printValue( val.c_str(), val.size(), buf))
-		{
-			const char* err = XmlPrinterBase::lasterror();
-			throw std::runtime_error( std::string( "xml print error: ") + (err?err:"") + " when printing: " + outputString(val.c_str(),val.c_str()+val.size()));
-		}
+		printValue( val.c_str(), val.c_str() + val.size(), buf);
+	}
+
+	void printValue( const StringRef& val, std::string& buf)
+	{
+		printValue( val.ptr(), val.ptr() + val.size(), buf);
 	}
 
 	void printValue( const char* si, const char* se, std::string& buf)
 	{
-		if (!XmlPrinterBase::printValue( si, se-si, buf))
+		if (state() == XmlPrinterBase::TagAttribute)
 		{
-			const char* err = XmlPrinterBase::lasterror();
-			throw std::runtime_error( std::string( "xml print error: ") + (err?err:"") + " when printing: " + outputString(si,se));
+			//... print an empty attribute value for the state transition and insert the value escaped between the quotes
+			if (!XmlPrinterBase::printValue( "", 0, buf))
+			{
+				const char* err = XmlPrinterBase::lasterror();
+				throw std::runtime_error( std::string( "xml print error: ") + (err?err:"") + " when printing: " + outputString(si,se));
+			}
+			buf.resize( buf.size()-1);
+			strus::appendXmlEscaped( buf, si, se-si, strus::XmlEscapeAttributeValue);
+			buf.push_back( '"');
+		}
+		else
+		{
+			if (!XmlPrinterBase::exitTagContext( buf))
+			{
+				const char* err = XmlPrinterBase::lasterror();
+				throw std::runtime_error( std::string( "xml print error: ") + (err?err:"") + " when printing: " + outputString(si,se));
+			}
+			strus::appendXmlEscaped( buf, si, se-si, strus::XmlEscapeContent);
 		}
 	}
 
@@ -122,6 +142,11 @@ public:
 	}
 };
 
+static std::string trimString( const StringRef& str, std::size_t pos=0)
+{
+	return pos < str.size() ? string_conv::trim( str.ptr() + pos, str.size() - pos) : std::string();
+}
+
 bool DocumentStructure::checkTableDefExists( const char* action)
 {
 	if (m_tableDefs.empty())
@@ -383,7 +408,7 @@ void DocumentStructure::addQuoteItem( Paragraph::Type startType, int count)
 	{
 		if (m_parar[ m_structStack.back().start].type() == startType)
 		{
-			m_parar.push_back( Paragraph( endType, "", ""));
+			m_parar.push_back( Paragraph( *m_arena, endType, "", ""));
 			m_structStack.pop_back();
 		}
 		else
@@ -400,13 +425,13 @@ void DocumentStructure::addQuoteItem( Paragraph::Type startType, int count)
 				}
 			}
 			m_structStack.push_back( StructRef( 0, m_parar.size()));
-			m_parar.push_back( Paragraph( startType, id, ""));
+			m_parar.push_back( Paragraph( *m_arena, startType, id, ""));
 		}
 	}
 	else
 	{
 		m_structStack.push_back( StructRef( 0, m_parar.size()));
-		m_parar.push_back( Paragraph( startType, id, ""));
+		m_parar.push_back( Paragraph( *m_arena, startType, id, ""));
 	}
 	checkStructureDepth();
 }
@@ -429,7 +454,7 @@ void DocumentStructure::openAutoCloseItem( Paragraph::Type startType, const char
 				{
 					finishStructure( m_structStack[ si].start);
 				}
-				m_parar.push_back( Paragraph( endType, "", ""));
+				m_parar.push_back( Paragraph( *m_arena, endType, "", ""));
 				m_structStack.pop_back();
 			}
 			break;
@@ -438,11 +463,11 @@ void DocumentStructure::openAutoCloseItem( Paragraph::Type startType, const char
 	m_structStack.push_back( StructRef( lidx, m_parar.size()));
 	if (lidx > 0)
 	{
-		m_parar.push_back( Paragraph( startType, strus::string_format("%s%d", prefix, lidx), ""));
+		m_parar.push_back( Paragraph( *m_arena, startType, strus::string_format("%s%d", prefix, lidx), ""));
 	}
 	else
 	{
-		m_parar.push_back( Paragraph( startType, prefix, ""));
+		m_parar.push_back( Paragraph( *m_arena, startType, prefix, ""));
 	}
 	checkStructureDepth();
 }
@@ -454,7 +479,7 @@ void DocumentStructure::closeAutoCloseItem( Paragraph::Type startType)
 	Paragraph para = m_parar[ m_structStack.back().start];
 	if (para.type() == startType)
 	{
-		m_parar.push_back( Paragraph( endType, "", ""));
+		m_parar.push_back( Paragraph( *m_arena, endType, "", ""));
 		m_structStack.pop_back();
 	}
 }
@@ -465,7 +490,7 @@ void DocumentStructure::openTableCell( Paragraph::Type startType, int rowspan, i
 	m_structStack.push_back( StructRef( 0, m_parar.size()));
 	m_tableDefs.back().defineCell( m_parar.size(), rowspan, colspan);
 	m_tableDefs.back().nextCol( colspan);
-	m_parar.push_back( Paragraph( startType, "", ""));
+	m_parar.push_back( Paragraph( *m_arena, startType, "", ""));
 	checkStructureDepth();
 }
 
@@ -506,11 +531,11 @@ void DocumentStructure::openStructure( Paragraph::Type startType, const char* pr
 	m_structStack.push_back( StructRef( 0, m_parar.size()));
 	if (lidx > 0)
 	{
-		m_parar.push_back( Paragraph( startType, strus::string_format("%s%d", prefix, lidx), ""));
+		m_parar.push_back( Paragraph( *m_arena, startType, strus::string_format("%s%d", prefix, lidx), ""));
 	}
 	else
 	{
-		m_parar.push_back( Paragraph( startType, prefix, ""));
+		m_parar.push_back( Paragraph( *m_arena, startType, prefix, ""));
 	}
 	checkStructureDepth();
 }
@@ -546,7 +571,7 @@ void DocumentStructure::addTableCellIdentifierAttributes( const char* prefix, co
 	std::set<int>::const_iterator ai = indices.begin(), ae = indices.end();
 	for (; ai != ae; ++ai)
 	{
-		m_tables.push_back( Paragraph( Paragraph::TableCellReference, "id", strus::string_format( "%s%d", prefix, *ai)));
+		m_tables.push_back( Paragraph( *m_arena, Paragraph::TableCellReference, "id", strus::string_format( "%s%d", prefix, *ai)));
 	}
 }
 
@@ -668,10 +693,10 @@ void DocumentStructure::finishTable( int startidx, const std::string& tableid)
 			outsideTableItems.push_back( *hi++);
 		}
 	}
-	m_tables.push_back( Paragraph( Paragraph::TableEnd, "", ""));
+	m_tables.push_back( Paragraph( *m_arena, Paragraph::TableEnd, "", ""));
 	// Remove table written to buffer and add table link:
 	m_parar.resize( startidx);
-	m_parar.push_back( Paragraph( Paragraph::TableLink, tableid, ""));
+	m_parar.push_back( Paragraph( *m_arena, Paragraph::TableLink, tableid, ""));
 	m_parar.insert( m_parar.end(), outsideTableItems.begin(), outsideTableItems.end());
 	m_tableDefs.pop_back();
 }
@@ -698,12 +723,12 @@ void DocumentStructure::finishRef( int startidx, const std::string& refid)
 			m_refs.insert( m_refs.end(), m_parar.begin() + startidx, m_parar.end());
 			m_refmap[ key] = refid;
 			m_parar.resize( startidx);
-			m_parar.push_back( Paragraph( Paragraph::RefLink, refid, ""));
+			m_parar.push_back( Paragraph( *m_arena, Paragraph::RefLink, refid, ""));
 		}
 		else
 		{
 			m_parar.resize( startidx);
-			m_parar.push_back( Paragraph( Paragraph::RefLink, ki->second, ""));
+			m_parar.push_back( Paragraph( *m_arena, Paragraph::RefLink, ki->second, ""));
 		}
 	}
 }
@@ -735,7 +760,7 @@ static std::vector<Paragraph>::const_iterator skipStructureContent( std::vector<
 
 static bool getAttributeContent( std::string& content, std::vector<Paragraph>::const_iterator pi, const std::vector<Paragraph>::const_iterator& pe)
 {
-	content.append( strus::string_conv::trim( pi->text()));
+	content.append( trimString( pi->text()));
 	for (++pi; pi != pe; ++pi)
 	{
 		if (pi->type() == Paragraph::AttributeStart)
@@ -748,7 +773,7 @@ static bool getAttributeContent( std::string& content, std::vector<Paragraph>::c
 		}
 		else if (pi->type() == Paragraph::Text)
 		{
-			std::string txt = strus::string_conv::trim( pi->text());
+			std::string txt = trimString( pi->text());
 			if (!content.empty() && !txt.empty())
 			{
 				content.push_back( ' ');
@@ -836,14 +861,14 @@ static VisualAttributeTable g_visualAttributeTable;
 typedef std::pair<std::vector<Paragraph>::const_iterator,std::vector<Paragraph>::const_iterator> SourceRange;
 typedef std::vector<SourceRange> TextList;
 
-static void printTextList( std::vector<Paragraph>& dest, const std::vector<SourceRange>& textlist, int level=1)
+static void printTextList( StringArena& arena, std::vector<Paragraph>& dest, const std::vector<SourceRange>& textlist, int level=1)
 {
 	std::vector<SourceRange>::const_iterator si = textlist.begin(), se = textlist.end();
 	for (; si != se; ++si)
 	{
 		if (textlist.size() > 1)
 		{
-			dest.push_back( Paragraph( Paragraph::ListItemStart, strus::string_format("l%d", level), ""));
+			dest.push_back( Paragraph( arena, Paragraph::ListItemStart, strus::string_format("l%d", level), ""));
 		}
 		std::vector<Paragraph>::const_iterator ti = si->first;
 		for (; ti != si->second; ++ti)
@@ -853,7 +878,7 @@ static void printTextList( std::vector<Paragraph>& dest, const std::vector<Sourc
 		dest.push_back( *ti);
 		if (textlist.size() > 1)
 		{
-			dest.push_back( Paragraph( Paragraph::ListItemEnd, "", ""));
+			dest.push_back( Paragraph( arena, Paragraph::ListItemEnd, "", ""));
 		}
 	}
 }
@@ -917,20 +942,20 @@ static CitationClass getCitationClassFromName( const std::string& name)
 	return Text;
 }
 
-static void printTextTextList( std::vector<Paragraph>& dest, const std::vector<TextList>& textlistlist, int level=1)
+static void printTextTextList( StringArena& arena, std::vector<Paragraph>& dest, const std::vector<TextList>& textlistlist, int level=1)
 {
 	std::vector<TextList>::const_iterator li = textlistlist.begin(), le = textlistlist.end();
 	for (; li != le; ++li)
 	{
 		if (textlistlist.size() > 1)
 		{
-			dest.push_back( Paragraph( Paragraph::ListItemStart, strus::string_format("l%d", level), ""));
-			printTextList( dest, *li, level+1);
-			dest.push_back( Paragraph( Paragraph::ListItemEnd, "", ""));
+			dest.push_back( Paragraph( arena, Paragraph::ListItemStart, strus::string_format("l%d", level), ""));
+			printTextList( arena, dest, *li, level+1);
+			dest.push_back( Paragraph( arena, Paragraph::ListItemEnd, "", ""));
 		}
 		else
 		{
-			printTextList( dest, *li, level+1);
+			printTextList( arena, dest, *li, level+1);
 		}
 	}
 }
@@ -967,7 +992,7 @@ bool DocumentStructure::processParsedCitation( std::vector<Paragraph>& dest, std
 	int emptyAttribCnt = 0;
 	if (pi->type() == Paragraph::Text)
 	{
-		attr_class = strus::string_conv::trim( pi->text());
+		attr_class = trimString( pi->text());
 		citationClass = getCitationClassFromName( attr_class);
 		++pi;
 	}
@@ -1060,7 +1085,7 @@ bool DocumentStructure::processParsedCitation( std::vector<Paragraph>& dest, std
 			++pi;
 			if (range.first->id() == "class" && attr_class.empty() && range.second - range.first == 1)
 			{
-				attr_class = strus::string_conv::trim( range.first->text());
+				attr_class = trimString( range.first->text());
 				citationClass = getCitationClassFromName( attr_class);
 			}
 			else
@@ -1083,14 +1108,14 @@ bool DocumentStructure::processParsedCitation( std::vector<Paragraph>& dest, std
 		{
 			if (!attr_class.empty())
 			{
-				dest.push_back( Paragraph( Paragraph::AttributeStart, "class", attr_class));
-				dest.push_back( Paragraph( Paragraph::AttributeEnd, "", ""));
+				dest.push_back( Paragraph( *m_arena, Paragraph::AttributeStart, "class", attr_class));
+				dest.push_back( Paragraph( *m_arena, Paragraph::AttributeEnd, "", ""));
 			}
 			std::vector<Attribute>::const_iterator ai = attrlist.begin(), ae = attrlist.end();
 			for (; ai != ae; ++ai)
 			{
 				std::vector<Paragraph>::const_iterator ti = ai->range.first;
-				dest.push_back( Paragraph( Paragraph::AttributeStart, ai->id, ti->text()));
+				dest.push_back( Paragraph( *m_arena, Paragraph::AttributeStart, ai->id, ti->text()));
 				for (++ti; ti != ai->range.second; ++ti)
 				{
 					dest.push_back( *ti);
@@ -1100,43 +1125,43 @@ bool DocumentStructure::processParsedCitation( std::vector<Paragraph>& dest, std
 		}
 		else if (!attrlist.empty())
 		{
-			dest.push_back( Paragraph( Paragraph::TableStart, strus::string_format("table%d", ++m_tableCnt), ""));
+			dest.push_back( Paragraph( *m_arena, Paragraph::TableStart, strus::string_format("table%d", ++m_tableCnt), ""));
 			if (!attr_class.empty())
 			{
-				dest.push_back( Paragraph( Paragraph::TableTitleStart, "", ""));
-				dest.push_back( Paragraph( Paragraph::Text, "", attr_class));
-				dest.push_back( Paragraph( Paragraph::TableTitleEnd, "", ""));
+				dest.push_back( Paragraph( *m_arena, Paragraph::TableTitleStart, "", ""));
+				dest.push_back( Paragraph( *m_arena, Paragraph::Text, "", attr_class));
+				dest.push_back( Paragraph( *m_arena, Paragraph::TableTitleEnd, "", ""));
 			}
 			std::vector<Attribute>::const_iterator ai = attrlist.begin(), ae = attrlist.end();
 			int aidx = 0;
 			for (; ai!=ae; ++ai,++aidx)
 			{
-				dest.push_back( Paragraph( Paragraph::TableHeadStart, "", ""));
-				dest.push_back( Paragraph( Paragraph::TableCellReference, "id", strus::string_format( "C%d", aidx)));
-				dest.push_back( Paragraph( Paragraph::Text, "",  normalizeCellHeadingName( ai->id)));
-				dest.push_back( Paragraph( Paragraph::TableHeadEnd, "", ""));
-				dest.push_back( Paragraph( Paragraph::TableCellStart, "", ""));
-				dest.push_back( Paragraph( Paragraph::TableCellReference, "id", strus::string_format( "C%d", aidx)));
+				dest.push_back( Paragraph( *m_arena, Paragraph::TableHeadStart, "", ""));
+				dest.push_back( Paragraph( *m_arena, Paragraph::TableCellReference, "id", strus::string_format( "C%d", aidx)));
+				dest.push_back( Paragraph( *m_arena, Paragraph::Text, "",  normalizeCellHeadingName( ai->id)));
+				dest.push_back( Paragraph( *m_arena, Paragraph::TableHeadEnd, "", ""));
+				dest.push_back( Paragraph( *m_arena, Paragraph::TableCellStart, "", ""));
+				dest.push_back( Paragraph( *m_arena, Paragraph::TableCellReference, "id", strus::string_format( "C%d", aidx)));
 				if (!strus::isEmptyString( ai->range.first->text()))
 				{
-					dest.push_back( Paragraph( Paragraph::Text, "", strus::string_conv::trim( ai->range.first->text())));
+					dest.push_back( Paragraph( *m_arena, Paragraph::Text, "", trimString( ai->range.first->text())));
 				}
 				std::vector<Paragraph>::const_iterator ci = ai->range.first;
 				for (++ci; ci != ai->range.second; ++ci)
 				{
 					dest.push_back( *ci);
 				}
-				dest.push_back( Paragraph( Paragraph::TableCellEnd, "", ""));
+				dest.push_back( Paragraph( *m_arena, Paragraph::TableCellEnd, "", ""));
 			}
-			dest.push_back( Paragraph( Paragraph::TableEnd, "", ""));
+			dest.push_back( Paragraph( *m_arena, Paragraph::TableEnd, "", ""));
 		}
 		if (!text.empty())
 		{
-			dest.push_back( Paragraph( Paragraph::AttributeStart, attr_class, text));
-			dest.push_back( Paragraph( Paragraph::AttributeEnd, "", ""));
+			dest.push_back( Paragraph( *m_arena, Paragraph::AttributeStart, attr_class, text));
+			dest.push_back( Paragraph( *m_arena, Paragraph::AttributeEnd, "", ""));
 		}
-		printTextList( dest, textlist);
-		printTextTextList( dest, textlistlist);
+		printTextList( *m_arena, dest, textlist);
+		printTextTextList( *m_arena, dest, textlistlist);
 	
 		dest.push_back( *pe);
 		return true;
@@ -1169,12 +1194,12 @@ void DocumentStructure::finishCitation( int startidx, const std::string& citid)
 			m_citationmap[ key] = citid;
 			bool ppc = processParsedCitation( m_citations, m_parar.begin() + startidx, m_parar.end());
 			m_parar.resize( startidx);
-			if (ppc) m_parar.push_back( Paragraph( Paragraph::CitationLink, citid, ""));
+			if (ppc) m_parar.push_back( Paragraph( *m_arena, Paragraph::CitationLink, citid, ""));
 		}
 		else
 		{
 			m_parar.resize( startidx);
-			m_parar.push_back( Paragraph( Paragraph::CitationLink, ki->second, ""));
+			m_parar.push_back( Paragraph( *m_arena, Paragraph::CitationLink, ki->second, ""));
 		}
 	}
 }
@@ -1190,7 +1215,7 @@ void DocumentStructure::finishStructure( int startidx)
 		}
 	}
 	Paragraph::Type endType = Paragraph::invType( para.type());
-	m_parar.push_back( Paragraph( endType, "", ""));
+	m_parar.push_back( Paragraph( *m_arena, endType, "", ""));
 
 	if (endType == Paragraph::CitationEnd)
 	{
@@ -1279,9 +1304,9 @@ void DocumentStructure::closeWebLink()
 		const Paragraph& para = *(pi-1);
 		if (para.type() == Paragraph::Text)
 		{
-			if (!para.text().empty() && 0!=std::strchr( para.text().c_str(), '['))
+			if (!para.text().empty() && 0!=std::memchr( para.text().ptr(), '[', para.text().size()))
 			{
-				char const* se = para.text().c_str();
+				char const* se = para.text().ptr();
 				char const* si = se + para.text().size();
 				char ch = 0;
 				for (; si != se; --si)
@@ -1347,41 +1372,14 @@ static std::string getFileIdFromTitle( const std::string& txt)
 static std::string encodeXmlContentString( const std::string& txt, bool encodeEoln)
 {
 	std::string rt;
-	char const* si = txt.c_str();
-	for (; *si; ++si)
-	{
-		if ((unsigned char)*si < 32 && encodeEoln)
-		{
-			rt.push_back( ' ');
-		}
-		else if (*si == '\"')
-		{
-			rt.append( "&quot;");
-		}
-		else if (*si == '&')
-		{
-			rt.append( "&amp;");
-		}
-		else if (*si == '<')
-		{
-			rt.append( "&lt;");
-		}
-		else if (*si == '>')
-		{
-			rt.append( "&gt;");
-		}
-		else
-		{
-			rt.push_back( *si);
-		}
-	}
+	strus::appendXmlEscaped( rt, txt.c_str(), txt.size(), encodeEoln ? strus::XmlEscapeTextLine : strus::XmlEscapeText);
 	return rt;
 }
 
 void DocumentStructure::setTitle( const std::string& text)
 {
 	m_fileId = getFileIdFromTitle( text);
-	Paragraph para( Paragraph::Title, m_fileId, text);
+	Paragraph para( *m_arena, Paragraph::Title, m_fileId, text);
 	if (!m_parar.empty() && m_parar[0].type() == Paragraph::Title)
 	{
 		m_parar[0] = para;
@@ -1410,11 +1408,12 @@ int DocumentStructure::currentStructIndex() const
 	return m_structStack.back().idx;
 }
 
-static bool isSpaceOnlyText( const std::string& text)
+static bool isSpaceOnlyText( const StringRef& text)
 {
-	char const* si = text.c_str();
-	for (; *si && (unsigned char)*si <= 32; ++si){}
-	return !*si;
+	char const* si = text.ptr();
+	char const* se = si + text.size();
+	for (; si != se && *si && (unsigned char)*si <= 32; ++si){}
+	return si == se || !*si;
 }
 
 void DocumentStructure::clearOpenText()
@@ -1436,19 +1435,20 @@ static bool isJoinLinkChar( unsigned char ch)
 	return false;
 }
 
-static bool isJoinLinkText( const std::string& text)
+static bool isJoinLinkText( const StringRef& text)
 {
 	if (text.empty()) return true;
 	return isJoinLinkChar( (unsigned char)text[0]);
 }
 
-std::pair<std::string,std::string> splitJoinLinkWords( const std::string& text)
+std::pair<std::string,std::string> splitJoinLinkWords( const StringRef& text)
 {
 	std::pair<std::string,std::string> rt;
-	char const* si = text.c_str();
-	while (*si && isJoinLinkChar(*si)) ++si;
-	rt.first.append( text.c_str(), si - text.c_str());
-	rt.second.append( si);
+	char const* si = text.ptr();
+	char const* se = si + text.size();
+	while (si != se && *si && isJoinLinkChar(*si)) ++si;
+	rt.first.append( text.ptr(), si - text.ptr());
+	rt.second.append( si, se - si);
 	return rt;
 }
 
@@ -1460,31 +1460,31 @@ static bool isLastItemJoinableText( const std::vector<Paragraph>& parar, Paragra
 	&& !parar[ parar.size()-2].text().empty();
 }
 
-void DocumentStructure::addSingleItem( Paragraph::Type type, const std::string& id, const std::string& text, bool joinText)
+void DocumentStructure::addSingleItem( Paragraph::Type type, const StringRef& id, const StringRef& text, bool joinText)
 {
 	if (joinText)
 	{
 		if (!m_parar.empty() && m_parar.back().type() == Paragraph::AttributeStart && type == Paragraph::Text)
 		{
-			m_parar.back().addText( text);
+			m_parar.back().addText( *m_arena, text);
 		}
 		else if (m_parar.back().type() == Paragraph::Text && isSpaceOnlyText( text) && (type == Paragraph::Text || type == Paragraph::Char || type == Paragraph::BibRef || type == Paragraph::NoWiki || type == Paragraph::Math || type == Paragraph::Timestamp))
 		{
 			if (!text.empty() && !m_parar.empty())
 			{
-				if (0!=std::strchr( text.c_str(), '\n'))
+				if (0!=std::memchr( text.ptr(), '\n', text.size()))
 				{
-					m_parar.back().addText( "\n");
+					m_parar.back().addText( *m_arena, "\n");
 				}
 				else
 				{
-					m_parar.back().addText( " ");
+					m_parar.back().addText( *m_arena, " ");
 				}
 			}
 		}
 		else if (!m_parar.empty() && m_parar.back().type() == Paragraph::Text && type == Paragraph::Text)
 		{
-			m_parar.back().addText( text);
+			m_parar.back().addText( *m_arena, text);
 		}
 		else if (m_parar.size() >= 2
 		&&	(	isLastItemJoinableText( m_parar, Paragraph::PageLinkStart, Paragraph::PageLinkEnd)
@@ -1495,17 +1495,17 @@ void DocumentStructure::addSingleItem( Paragraph::Type type, const std::string&
 		&&	type == Paragraph::Text && isJoinLinkText(text))
 		{
 			std::pair<std::string,std::string> sptext = splitJoinLinkWords( text);
-			m_parar[ m_parar.size()-2].addText( sptext.first);
-			m_parar.push_back( Paragraph( type, id, sptext.second));
+			m_parar[ m_parar.size()-2].addText( *m_arena, sptext.first);
+			m_parar.push_back( Paragraph( *m_arena, type, id, sptext.second));
 		}
 		else
 		{
-			m_parar.push_back( Paragraph( type, id, text));
+			m_parar.push_back( Paragraph( *m_arena, type, id, text));
 		}
 	}
 	else
 	{
-		m_parar.push_back( Paragraph( type, id, text));
+		m_parar.push_back( Paragraph( *m_arena, type, id, text));
 	}
 }
 
@@ -1686,7 +1686,7 @@ static bool collectMultiAttributeText(
 	std::string elem;
 	res.clear();
 
-	while (attrid == pi->id() && collectAttributeText( elem, pidx, pi, pe, inTag))
+	while (pi->id() == attrid && collectAttributeText( elem, pidx, pi, pe, inTag))
 	{
 		if (!res.empty() && res[ res.size()-1] != ',') res.push_back(',');
 		res.append( string_conv::trim( elem));
@@ -1719,9 +1719,49 @@ static void stack_pop_back( std::vector<Paragraph::StructType>& stk, const char*
 	stk.pop_back();
 }
 
+/// \brief Precomputed line break with the indentation of the beautified output
+class Indentation
+{
+public:
+	enum {MaxDepth=64};
+
+	Indentation()
+	{
+		m_buf[0] = '\n';
+		std::memset( m_buf+1, ' ', 2*MaxDepth);
+	}
+
+	void print( XmlPrinter& output, std::size_t depth, std::string& rt) const
+	{
+		if (depth <= MaxDepth)
+		{
+			output.printValue( m_buf, m_buf + 1 + 2*depth, rt);
+		}
+		else
+		{
+			output.printValue( std::string("\n") + std::string( 2*depth, ' '), rt);
+		}
+	}
+
+private:
+	char m_buf[ 1 + 2*MaxDepth];
+};
+
+static const Indentation g_indentation;
+
 std::string DocumentStructure::toxml( bool beautified, bool singleIdAttribute) const
 {
 	std::string rt;
+	StringOutputSink sink( rt);
+	toxml( sink, beautified, singleIdAttribute);
+	return rt;
+}
+
+void DocumentStructure::toxml( OutputSinkInterface& sink, bool beautified, bool singleIdAttribute) const
+{
+	enum {ChunkSize = (1<<16)};
+	std::string rt;
+	rt.reserve( ChunkSize + (ChunkSize >> 2));
 	std::string lastMark;
 	std::vector<Paragraph::StructType> stk;
 	XmlPrinter output;
@@ -1730,21 +1770,27 @@ std::string DocumentStructure::toxml( bool beautified, bool singleIdAttribute) c
 	std::vector<Paragraph>::const_iterator pi = m_parar.begin(), pe = m_parar.end();
 	for(int pidx=0; pi != pe; ++pi,++pidx)
 	{
+		if (rt.size() >= (std::size_t)ChunkSize)
+		{
+			//... the printer keeps its state apart from the output, the output printed can be passed to the sink at any time
+			sink.write( rt.c_str(), rt.size());
+			rt.clear();
+		}
 		if (beautified && !output.isInTagDeclaration())
 		{
-			output.printValue( std::string("\n") + std::string( 2*stk.size(), ' '), rt);
+			g_indentation.print( output, stk.size(), rt);
 		}
 		switch (pi->type())
 		{
 			case Paragraph::Title:
 				lastMark.clear();
 				printTagContent( output, rt, "docid", "", pi->id());
-				if (beautified) output.printValue( std::string("\n") + std::string( 2*stk.size(), ' '), rt);
+				if (beautified) g_indentation.print( output, stk.size(), rt);
 				printTagContent( output, rt, "title", "", pi->text());
 				break;
 			case Paragraph::DanglingQuotes:
 				output.switchToContent( rt);
-				output.printValue( pi->text().empty() ? std::string(" ") : pi->text(), rt);
+				output.printValue( pi->text().empty() ? StringRef(" ") : pi->text(), rt);
 				break;
 			case Paragraph::QuotationStart:
 				stk.push_back( Paragraph::StructQuotation);
@@ -1796,7 +1842,7 @@ std::string DocumentStructure::toxml( bool beautified, bool singleIdAttribute) c
 			case Paragraph::HeadingStart:
 				lastMark.clear();
 				stk.push_back( Paragraph::StructHeading);
-				printTagOpenA( output, rt, "heading", "lv", pi->id(), string_conv::trim( pi->text()));
+				printTagOpenA( output, rt, "heading", "lv", pi->id(), trimString( pi->text()));
 				break;
 			case Paragraph::HeadingEnd:
 				stack_pop_back( stk, pi->typeName());
@@ -1804,7 +1850,7 @@ std::string DocumentStructure::toxml( bool beautified, bool singleIdAttribute) c
 				break;
 			case Paragraph::ListItemStart:
 				stk.push_back( Paragraph::StructList);
-				printTagOpenA( output, rt, "list", "lv", pi->id(), string_conv::trim( pi->text()));
+				printTagOpenA( output, rt, "list", "lv", pi->id(), trimString( pi->text()));
 				break;
 			case Paragraph::ListItemEnd:
 				stack_pop_back( stk, pi->typeName());
@@ -1882,31 +1928,31 @@ std::string DocumentStructure::toxml( bool beautified, bool singleIdAttribute) c
 			case Paragraph::PageLinkStart:
 			{
 				stk.push_back( Paragraph::StructPageLink);
-				char const* cc = std::strchr( pi->id().c_str(), ':');
+				char const* cc = (char const*)std::memchr( pi->id().ptr(), ':', pi->id().size());
 				std::string prefix;
-				if (cc) prefix.append( pi->id().c_str(), cc - pi->id().c_str());
+				if (cc) prefix.append( pi->id().ptr(), cc - pi->id().ptr());
 				if (strus::caseInsensitiveEquals( prefix, "file"))
 				{
-					printTagOpen( output, rt, "filelink", strus::string_conv::trim( pi->id().c_str() + prefix.size() + 1), string_conv::trim( pi->text()));
+					printTagOpen( output, rt, "filelink", trimString( pi->id(), prefix.size() + 1), trimString( pi->text()));
 				}
 				else if (strus::caseInsensitiveEquals( prefix, "image"))
 				{
-					printTagOpen( output, rt, "imglink", strus::string_conv::trim( pi->id().c_str() + prefix.size() + 1), string_conv::trim( pi->text()));
+					printTagOpen( output, rt, "imglink", trimString( pi->id(), prefix.size() + 1), trimString( pi->text()));
 				}
 				else if (strus::caseInsensitiveEquals( prefix, "category"))
 				{
 					if (strus::caseInsensitiveStartsWith( pi->text(), prefix))
 					{
-						printTagOpen( output, rt, "category", strus::string_conv::trim( pi->id().c_str() + prefix.size() + 1), strus::string_conv::trim( pi->text().c_str() + prefix.size() + 1));
+						printTagOpen( output, rt, "category", trimString( pi->id(), prefix.size() + 1), trimString( pi->text(), prefix.size() + 1));
 					}
 					else
 					{
-						printTagOpen( output, rt, "category", strus::string_conv::trim( pi->id().c_str() + prefix.size() + 1), string_conv::trim( pi->text()));
+						printTagOpen( output, rt, "category", trimString( pi->id(), prefix.size() + 1), trimString( pi->text()));
 					}
 				}
 				else
 				{
-					printTagOpen( output, rt, "pagelink", pi->id(), string_conv::trim( pi->text()));
+					printTagOpen( output, rt, "pagelink", pi->id(), trimString( pi->text()));
 				}
 				break;
 			}
@@ -1916,7 +1962,7 @@ std::string DocumentStructure::toxml( bool beautified, bool singleIdAttribute) c
 				break;
 			case Paragraph::WebLinkStart:
 				stk.push_back( Paragraph::StructWebLink);
-				printTagOpen( output, rt, "weblink", pi->id(), string_conv::trim( pi->text()));
+				printTagOpen( output, rt, "weblink", pi->id(), trimString( pi->text()));
 				break;
 			case Paragraph::WebLinkEnd:
 				stack_pop_back( stk, pi->typeName());
@@ -1924,7 +1970,7 @@ std::string DocumentStructure::toxml( bool beautified, bool singleIdAttribute) c
 				break;
 			case Paragraph::TableStart:
 				stk.push_back( Paragraph::StructTable);
-				printTagOpen( output, rt, "table", pi->id(), string_conv::trim( pi->text()));
+				printTagOpen( output, rt, "table", pi->id(), trimString( pi->text()));
 				break;
 			case Paragraph::TableEnd:
 				stack_pop_back( stk, pi->typeName());
@@ -1932,7 +1978,7 @@ std::string DocumentStructure::toxml( bool beautified, bool singleIdAttribute) c
 				break;
 			case Paragraph::TableTitleStart:
 				stk.push_back( Paragraph::StructTableTitle);
-				printTagOpen( output, rt, "tabtitle", pi->id(), string_conv::trim( pi->text()));
+				printTagOpen( output, rt, "tabtitle", pi->id(), trimString( pi->text()));
 				break;
 			case Paragraph::TableTitleEnd:
 				stack_pop_back( stk, pi->typeName());
@@ -1957,12 +2003,12 @@ std::string DocumentStructure::toxml( bool beautified, bool singleIdAttribute) c
 			case Paragraph::TableCellReference:
 				if (output.isInTagDeclaration() && singleIdAttribute)
 				{
-					std::string attrtext = string_conv::trim( pi->text());
+					std::string attrtext = trimString( pi->text());
 					std::string attrid = pi->id();
-					for (++pi,++pidx; pi->type() == Paragraph::TableCellReference && attrid == pi->id(); ++pi,++pidx)
+					for (++pi,++pidx; pi->type() == Paragraph::TableCellReference && pi->id() == attrid; ++pi,++pidx)
 					{
 						if (!attrtext.empty() && attrtext[ attrtext.size()-1] != ',') attrtext.push_back(',');
-						attrtext.append( string_conv::trim( pi->text()));
+						attrtext.append( trimString( pi->text()));
 					}
 					output.printAttribute( attrid, rt);
 					output.printValue( attrtext, rt);
@@ -1971,16 +2017,16 @@ std::string DocumentStructure::toxml( bool beautified, bool singleIdAttribute) c
 				else
 				{
 					output.printAttribute( pi->id(), rt);
-					output.printValue( string_conv::trim( pi->text()), rt);
+					output.printValue( trimString( pi->text()), rt);
 				}
 				break;
 			case Paragraph::WebLink:
-				printTagOpen( output, rt, "weblink", pi->id(), string_conv::trim( pi->text()));
+				printTagOpen( output, rt, "weblink", pi->id(), trimString( pi->text()));
 				output.printCloseTag( rt);
 				break;
 			case Paragraph::Markup:
 			{
-				std::string mrk = string_conv::trim( pi->text());
+				std::string mrk = trimString( pi->text());
 				if (mrk != lastMark)
 				{
 					printTagContent( output, rt, "mark", pi->id(), mrk);
@@ -1991,7 +2037,7 @@ std::string DocumentStructure::toxml( bool beautified, bool singleIdAttribute) c
 			case Paragraph::Text:
 				if (!pi->id().empty() || !isSpaceOnlyText( pi->text()))
 				{
-					printTagContent( output, rt, "text", pi->id(), string_conv::trim( pi->text()));
+					printTagContent( output, rt, "text", pi->id(), trimString( pi->text()));
 				}
 				break;
 			case Paragraph::Break:
@@ -2016,18 +2062,18 @@ std::string DocumentStructure::toxml( bool beautified, bool singleIdAttribute) c
 				printTagContent( output, rt, "time", pi->id(), pi->text());
 				break;
 			case Paragraph::CitationLink:
-				printTagContent( output, rt, "citlink", pi->id(), string_conv::trim( pi->text()));
+				printTagContent( output, rt, "citlink", pi->id(), trimString( pi->text()));
 				break;
 			case Paragraph::RefLink:
-				printTagContent( output, rt, "reflink", pi->id(), string_conv::trim( pi->text()));
+				printTagContent( output, rt, "reflink", pi->id(), trimString( pi->text()));
 				break;
 			case Paragraph::TableLink:
-				printTagContent( output, rt, "tablink", pi->id(), string_conv::trim( pi->text()));
+				printTagContent( output, rt, "tablink", pi->id(), trimString( pi->text()));
 				break;
 		}
 	}
 	output.printCloseTag( rt);
-	return rt;
+	sink.write( rt.c_str(), rt.size());
 }
 
 std::string DocumentStructure::tostring() const
@@ -2041,7 +2087,24 @@ std::string DocumentStructure::tostring() const
 	return out.str();
 }
 
+static const char* g_defaultStrangeFeaturePatterns[] = {"bgcolor=","bgcolor:","align=","align:","width=","width:","style=","style:","class=","class:",0};
+
+std::vector<std::string> DocumentStructure::defaultStrangeFeaturePatterns()
+{
+	std::vector<std::string> rt;
+	char const** pi = g_defaultStrangeFeaturePatterns;
+	for (; *pi; ++pi) rt.push_back( *pi);
+	return rt;
+}
+
+static const MultiPatternMatcher g_defaultStrangeFeatureMatcher( DocumentStructure::defaultStrangeFeaturePatterns());
+
 std::string DocumentStructure::reportStrangeFeatures() const
+{
+	return reportStrangeFeatures( g_defaultStrangeFeatureMatcher);
+}
+
+std::string DocumentStructure::reportStrangeFeatures( const MultiPatternMatcher& patterns) const
 {
 	std::ostringstream out;
 	std::vector<Paragraph>::const_iterator pi = m_parar.begin(), pe = m_parar.end();
@@ -2049,76 +2112,22 @@ std::string DocumentStructure::reportStrangeFeatures() const
 	{
 		if (pi->type() == Paragraph::Text)
 		{
-			char const* si = pi->text().c_str();
-			if (0!=std::strstr( si, "bgcolor="))
-			{
-				const char* featptr = std::strstr( si, "bgcolor=");
-				std::string feat( featptr, 8);
-				out << pidx << " " << pi->typeName() << " " << feat << " [" << encodeXmlContentString( pi->text(), true) << "]\n";
-			}
-			else if (0!=std::strstr( si, "bgcolor:"))
-			{
-				const char* featptr = std::strstr( si, "bgcolor:");
-				std::string feat( featptr, 8);
-				out << pidx << " " << pi->typeName() << " " << feat << " [" << encodeXmlContentString( pi->text(), true) << "]\n";
-			}
-			else if (0!=std::strstr( si, "align="))
-			{
-				const char* featptr = std::strstr( si, "align=");
-				std::string feat( featptr, 6);
-				out << pidx << " " << pi->typeName() << " " << feat << " [" << encodeXmlContentString( pi->text(), true) << "]\n";
-			}
-			else if (0!=std::strstr( si, "align:"))
-			{
-				const char* featptr = std::strstr( si, "align:");
-				std::string feat( featptr, 6);
-				out << pidx << " " << pi->typeName() << " " << feat << " [" << encodeXmlContentString( pi->text(), true) << "]\n";
-			}
-			else if (0!=std::strstr( si, "width="))
-			{
-				const char* featptr = std::strstr( si, "width=");
-				std::string feat( featptr, 6);
-				out << pidx << " " << pi->typeName() << " " << feat << " [" << encodeXmlContentString( pi->text(), true) << "]\n";
-			}
-			else if (0!=std::strstr( si, "width:"))
-			{
-				const char* featptr = std::strstr( si, "width:");
-				std::string feat( featptr, 6);
-				out << pidx << " " << pi->typeName() << " " << feat << " [" << encodeXmlContentString( pi->text(), true) << "]\n";
-			}
-			else if (0!=std::strstr( si, "style="))
-			{
-				const char* featptr = std::strstr( si, "style=");
-				std::string feat( featptr, 6);
-				out << pidx << " " << pi->typeName() << " " << feat << " [" << encodeXmlContentString( pi->text(), true) << "]\n";
-			}
-			else if (0!=std::strstr( si, "style:"))
-			{
-				const char* featptr = std::strstr( si, "style:");
-				std::string feat( featptr, 6);
-				out << pidx << " " << pi->typeName() << " " << feat << " [" << encodeXmlContentString( pi->text(), true) << "]\n";
-			}
-			else if (0!=std::strstr( si, "class="))
-			{
-				const char* featptr = std::strstr( si, "class=");
-				std::string feat( featptr, 6);
-				out << pidx << " " << pi->typeName() << " " << feat << " [" << encodeXmlContentString( pi->text(), true) << "]\n";
-			}
-			else if (0!=std::strstr( si, "class:"))
+			char const* si = pi->text().ptr();
+			const char* se = si + pi->text().size();
+			int featidx = patterns.findFirst( si, se - si);
+			if (featidx >= 0)
 			{
-				const char* featptr = std::strstr( si, "class:");
-				std::string feat( featptr, 6);
-				out << pidx << " " << pi->typeName() << " " << feat << " [" << encodeXmlContentString( pi->text(), true) << "]\n";
+				out << pidx << " " << pi->typeName() << " " << patterns.pattern( featidx) << " [" << encodeXmlContentString( pi->text(), true) << "]\n";
 			}
-			else while (*si)
+			else while (si != se)
 			{
-				for (; *si && (unsigned char)*si <= 32; ++si){}
+				for (; si != se && (unsigned char)*si <= 32; ++si){}
 				int sidx = 0;
 				char cls = 0;
 				char prev_cls = 0;
 				int cls_chg = 0;
 				char const* start = si;
-				for (; *si; ++si,++sidx)
+				for (; si != se; ++si,++sidx)
 				{
 					prev_cls = cls;
 	
@@ -2136,7 +2145,7 @@ std::string DocumentStructure::reportStrangeFeatures() const
 					std::string feat( start, si-start);
 					out << pidx << " " << pi->typeName() << " " << feat << " [" << encodeXmlContentString( pi->text(), true) << "]\n";
 				}
-				if (*si) ++si;
+				if (si != se) ++si;
 			}
 		}
 	}
@@ -12,6 +12,9 @@
 #define _STRUS_WIKIPEDIA_DOCUMENT_STRUCTURE_HPP_INCLUDED
 #include "strus/base/string_format.hpp"
 #include "strus/base/fileio.hpp"
+#include "stringArena.hpp"
+#include "outputSink.hpp"
+#include "multiPatternMatcher.hpp"
 #include <string>
 #include <map>
 #include <set>
@@ -296,55 +299,64 @@ public:
 
 	Paragraph()
 		:m_type(Text),m_id(),m_text(){}
-	Paragraph( Type type_, const std::string& id_, const std::string& text_)
-		:m_type(type_),m_id(id_),m_text(text_){}
+	Paragraph( StringArena& arena, Type type_, const StringRef& id_, const StringRef& text_)
+		:m_type(type_)
+		,m_id(arena.copy( id_.ptr(), id_.size()))
+		,m_text(arena.copy( text_.ptr(), text_.size())){}
 	Paragraph( const Paragraph& o)
 		:m_type(o.m_type),m_id(o.m_id),m_text(o.m_text){}
 
 	Type type() const					{return m_type;}
-	const std::string& id() const				{return m_id;}
-	const std::string& text() const				{return m_text;}
+	const StringRef& id() const				{return m_id;}
+	const StringRef& text() const				{return m_text;}
 
 	void setType( Type tp)
 	{
 		m_type = tp;
 	}
-	void setId( const std::string& id_)
+	void setId( StringArena& arena, const StringRef& id_)
 	{
-		m_id = id_;
+		m_id = arena.copy( id_.ptr(), id_.size());
 	}
-	void setText( const std::string& text_)
+	/// \brief Set the text to a string allocated in the same arena
+	void setText( const StringRef& text_)
 	{
 		m_text = text_;
 	}
-	void addText( const std::string& text_)
+	void setText( StringArena& arena, const StringRef& text_)
 	{
-		m_text += text_;
+		m_text = arena.copy( text_.ptr(), text_.size());
+	}
+	void addText( StringArena& arena, const StringRef& text_)
+	{
+		m_text = arena.append( m_text, text_.ptr(), text_.size());
 	}
 	std::string tokey() const
 	{
-		return strus::string_format( "%d\1%s\1%s", (int)m_type, m_id.c_str(), m_text.c_str());
+		return strus::string_format( "%d\1%s\1%s", (int)m_type, m_id.tostring().c_str(), m_text.tostring().c_str());
 	}
 
 private:
 	Type m_type;
-	std::string m_id;
-	std::string m_text;
+	StringRef m_id;		///< id allocated in the string arena of the document
+	StringRef m_text;		///< text allocated in the string arena of the document
 };
 
 class DocumentStructure
 {
 public:
-	explicit DocumentStructure()
-		:m_fileId(),m_parar(),m_citations(),m_tables(),m_refs(),m_citationmap()
+	/// \brief Constructor
+	/// \param[in] arena_ arena for the strings of the paragraphs, reset by the caller after the document has been processed
+	explicit DocumentStructure( StringArena* arena_)
+		:m_arena(arena_),m_fileId(),m_parar(),m_citations(),m_tables(),m_refs(),m_citationmap()
 		,m_refmap(),m_structStack(),m_tableDefs(),m_errors(),m_unresolved()
-		,m_linkDescription(),m_linkText()
+		,m_linkDescription(),m_linkText(),m_linkTextDeferred(false)
 		,m_nofErrors(0),m_tableCnt(0),m_citationCnt(0),m_refCnt(0)
 		,m_lastHeadingIdx(0),m_maxStructureDepthReported(false){}
 	DocumentStructure( const DocumentStructure& o)
-		:m_fileId(o.m_fileId),m_parar(o.m_parar),m_citations(o.m_citations),m_tables(o.m_tables),m_refs(o.m_refs),m_citationmap(o.m_citationmap)
+		:m_arena(o.m_arena),m_fileId(o.m_fileId),m_parar(o.m_parar),m_citations(o.m_citations),m_tables(o.m_tables),m_refs(o.m_refs),m_citationmap(o.m_citationmap)
 		,m_refmap(o.m_refmap),m_structStack(o.m_structStack),m_tableDefs(o.m_tableDefs),m_errors(o.m_errors),m_unresolved(o.m_unresolved)
-		,m_linkDescription(o.m_linkDescription),m_linkText(o.m_linkText)
+		,m_linkDescription(o.m_linkDescription),m_linkText(o.m_linkText),m_linkTextDeferred(o.m_linkTextDeferred)
 		,m_nofErrors(o.m_nofErrors),m_tableCnt(o.m_tableCnt),m_citationCnt(o.m_citationCnt),m_refCnt(o.m_refCnt)
 		,m_lastHeadingIdx(o.m_lastHeadingIdx),m_maxStructureDepthReported(o.m_maxStructureDepthReported){}
 
@@ -368,43 +380,61 @@ public:
 	void setLinkText( const std::string& text)
 	{
 		m_linkText = text;
+		m_linkTextDeferred = false;
+	}
+	/// \brief Set the text of a page link resolved after the conversion (see patchPageLinks)
+	/// \note The text is printed with an id marking it, so that it can be turned into the form of an unresolved link if the link is not resolved
+	void setDeferredLinkText( const std::string& text)
+	{
+		m_linkText = text;
+		m_linkTextDeferred = true;
+	}
+	/// \brief Id of the text of a page link set with setDeferredLinkText, printed as content of the link if it is not resolved
+	static const char* deferredLinkTextContentId()
+	{
+		return "deferred:content";
+	}
+	/// \brief Id of the text of a page link set with setDeferredLinkText, dropped if the link is not resolved (link with attributes)
+	static const char* deferredLinkTextDropId()
+	{
+		return "deferred:drop";
 	}
 	bool hasLinkText() const
 	{
 		return !m_linkText.empty();
 	}
-	void addMarkup( const std::string& text)
+	void addMarkup( const StringRef& text)
 	{
 		closeWebLinkIfOpen();
 		addSingleItem( Paragraph::Markup, "", text, false/*joinText*/);
 	}
-	void addText( const std::string& text)
+	void addText( const StringRef& text)
 	{
 		addSingleItem( Paragraph::Text, "", text, true/*joinText*/);
 	}
-	void addChar( const std::string& text)
+	void addChar( const StringRef& text)
 	{
 		addSingleItem( Paragraph::Char, "", text, false/*joinText*/);
 	}
 	void clearOpenText();
 
-	void addMath( const std::string& text)
+	void addMath( const StringRef& text)
 	{
 		addSingleItem( Paragraph::Math, "", text, false/*joinText*/);
 	}
-	void addNoWiki( const std::string& text)
+	void addNoWiki( const StringRef& text)
 	{
 		addSingleItem( Paragraph::NoWiki, "", text, false/*joinText*/);
 	}
-	void addCode( const std::string& text)
+	void addCode( const StringRef& text)
 	{
 		addSingleItem( Paragraph::Code, "", text, false/*joinText*/);
 	}
-	void addTimestamp( const std::string& text)
+	void addTimestamp( const StringRef& text)
 	{
 		addSingleItem( Paragraph::Timestamp, "", text, false/*joinText*/);
 	}
-	void addBibRef( const std::string& text)
+	void addBibRef( const StringRef& text)
 	{
 		addSingleItem( Paragraph::BibRef, "", text, false/*joinText*/);
 	}
@@ -455,8 +485,8 @@ public:
 		openStructure( Paragraph::PageLinkStart, pageid.c_str(), 0);
 		if (!anchorid.empty())
 		{
-			m_parar.push_back( Paragraph( Paragraph::AttributeStart, "anchor", anchorid));
-			m_parar.push_back( Paragraph( Paragraph::AttributeEnd, "", ""));
+			m_parar.push_back( Paragraph( *m_arena, Paragraph::AttributeStart, "anchor", anchorid));
+			m_parar.push_back( Paragraph( *m_arena, Paragraph::AttributeEnd, "", ""));
 		}
 	}
 	void closePageLink()
@@ -471,12 +501,25 @@ public:
 		{
 			if (!m_parar.empty())
 			{
-				if (m_parar.back().type() == Paragraph::AttributeEnd || m_parar.back().type() == Paragraph::PageLinkStart)
+				if (m_linkTextDeferred)
+				{
+					//... an unresolved link gets its id as content only if it has no attributes (see finishStructure)
+					if (m_parar.back().type() == Paragraph::PageLinkStart)
+					{
+						m_parar.push_back( Paragraph( *m_arena, Paragraph::Text, deferredLinkTextContentId(), m_linkText));
+					}
+					else if (m_parar.back().type() == Paragraph::AttributeEnd)
+					{
+						m_parar.push_back( Paragraph( *m_arena, Paragraph::Text, deferredLinkTextDropId(), m_linkText));
+					}
+				}
+				else if (m_parar.back().type() == Paragraph::AttributeEnd || m_parar.back().type() == Paragraph::PageLinkStart)
 				{
 					addText( m_linkText);
 				}
 			}
 			m_linkText.clear();
+			m_linkTextDeferred = false;
 		}
 		closeStructure( Paragraph::PageLinkStart, "");
 	}
@@ -691,8 +734,8 @@ public:
 		openStructure( Paragraph::CitationStart, "cit", ++m_citationCnt);
 		if (!citclass.empty())
 		{
-			m_parar.push_back( Paragraph( Paragraph::AttributeStart, "class", citclass));
-			m_parar.push_back( Paragraph( Paragraph::AttributeEnd, "", ""));
+			m_parar.push_back( Paragraph( *m_arena, Paragraph::AttributeStart, "class", citclass));
+			m_parar.push_back( Paragraph( *m_arena, Paragraph::AttributeEnd, "", ""));
 		}
 	}
 
@@ -725,11 +768,23 @@ public:
 	{
 		return std::vector<std::string>( m_unresolved.begin(), m_unresolved.end());
 	}
+	int nofUnresolved() const
+	{
+		return m_unresolved.size();
+	}
 	void finish();
 
 	std::string toxml( bool beautified, bool singleIdAttribute) const;
+	/// \brief Write the XML of the document to an output sink in chunks without building the whole output in memory
+	void toxml( OutputSinkInterface& sink, bool beautified, bool singleIdAttribute) const;
 	std::string tostring() const;
+	/// \brief Report suspicious text elements with the default patterns
 	std::string reportStrangeFeatures() const;
+	/// \brief Report suspicious text elements
+	/// \param[in] patterns patterns of suspicious text, the pattern with the lowest index found in a text is reported
+	std::string reportStrangeFeatures( const MultiPatternMatcher& patterns) const;
+	/// \brief Get the default patterns of suspicious text of reportStrangeFeatures()
+	static std::vector<std::string> defaultStrangeFeaturePatterns();
 	std::string statestring() const;
 
 	static std::string getInputXML( const std::string& title, const std::string& content);
@@ -748,7 +803,7 @@ private:
 	void closeStructure( Paragraph::Type startType, const std::string& alt_text);
 	void closeOpenStructures();
 
-	void addSingleItem( Paragraph::Type type, const std::string& id, const std::string& text, bool joinText);
+	void addSingleItem( Paragraph::Type type, const StringRef& id, const StringRef& text, bool joinText);
 	void addQuoteItem( Paragraph::Type startType, int count);
 	void openAutoCloseItem( Paragraph::Type startType, const char* prefix, int lidx, int depth);
 	void closeDanglingStructures( const Paragraph::Type& starttype);
@@ -829,6 +884,7 @@ private:
 	};
 
 private:
+	StringArena* m_arena;
 	std::string m_fileId;
 	std::vector<Paragraph> m_parar;
 	std::vector<Paragraph> m_citations;
@@ -842,6 +898,7 @@ private:
 	std::set<std::string> m_unresolved;
 	std::string m_linkDescription;
 	std::string m_linkText;
+	bool m_linkTextDeferred;			///< m_linkText set with setDeferredLinkText
 	int m_nofErrors;
 	int m_tableCnt;
 	int m_citationCnt;
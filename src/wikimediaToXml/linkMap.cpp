@@ -11,6 +11,10 @@
 #include "strus/base/string_format.hpp"
 #include "strus/errorBufferInterface.hpp"
 #include "strus/base/fileio.hpp"
+#include "strus/base/thread.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
 
 #define _TXT(XX) XX
 
@@ -18,7 +22,7 @@ using namespace strus;
 
 void LinkMap::init( const SymbolTable& symtab_, const std::map<int,int>& map_)
 {
-	if (!m_symtab.empty()) throw std::runtime_error( _TXT("call of init on non empty link map not allowed"));
+	if (!m_symtab.empty() || m_file) throw std::runtime_error( _TXT("call of init on non empty link map not allowed"));
 	int ki = 0, ke = symtab_.size();
 	for (; ki < ke; ++ki)
 	{
@@ -27,6 +31,7 @@ void LinkMap::init( const SymbolTable& symtab_, const std::map<int,int>& map_)
 		if (keyidx != (int)m_symtab.getOrCreate( keystr, std::strlen(keystr))) throw std::runtime_error( _TXT("corrupt data: bad index"));
 	}
 	m_map = map_;
+	compile();
 }
 
 void LinkMap::addLine( const std::string& ln)
@@ -36,22 +41,134 @@ void LinkMap::addLine( const std::string& ln)
 	define( std::string( ln.c_str(), mid-ln.c_str()), std::string(mid+1));
 }
 
+/// \brief Header of the binary link map format
+/// \note The header is followed by the displacements of the perfect hash buckets (int32_t[nofEntries]), the entries (BinaryEntry[nofEntries]) and the string table (stringsSize bytes of 0-terminated strings)
+struct BinaryHeader
+{
+	char magic[8];
+	uint32_t byteorder;
+	uint32_t version;
+	uint32_t nofEntries;
+	uint32_t stringsSize;
+};
+
+#define LINKMAP_MAGIC		"STRUSLNK"
+#define LINKMAP_BYTEORDER	0x01020304
+#define LINKMAP_VERSION		2
+
+/// \brief Key value pair in the binary link map format, a slot of the perfect hash table
+struct LinkMap::BinaryEntry
+{
+	uint32_t key;		///< offset of the normalized key in the string table
+	uint32_t val;		///< offset of the value in the string table
+};
+
+/// \brief FNV-1a hash of a string with a final avalanche step, different seeds give independent hash functions
+/// \note Without the final step the lowest bits of the hash depend only on the lowest bits of the characters and of the seed, so that keys could not be separated in a table with a size that is a power of two
+static uint32_t linkKeyHash( uint32_t seed, const char* key)
+{
+	uint32_t rt = 2166136261U ^ (seed * 16777619U);
+	unsigned char const* ki = (const unsigned char*)key;
+	for (; *ki; ++ki)
+	{
+		rt = (rt ^ *ki) * 16777619U;
+	}
+	rt ^= rt >> 16;
+	rt *= 0x85ebca6bU;
+	rt ^= rt >> 13;
+	rt *= 0xc2b2ae35U;
+	rt ^= rt >> 16;
+	return rt;
+}
+
+LinkMap::~LinkMap()
+{
+	if (m_file) delete m_file;
+}
+
 void LinkMap::load( const std::string& filename)
 {
-	std::string content;
-	int ec = strus::readFile( filename, content);
-	if (ec) throw std::runtime_error( strus::string_format( _TXT("error reading link map file %s: %s"), filename.c_str(), ::strerror(ec)));
-	char const* li = content.c_str();
-	char const* ln = std::strchr( li, '\n');
-	for (; ln; li=ln+1,ln = std::strchr( li, '\n'))
+	MemoryMappedFile file( filename);
+	if (file.size() >= sizeof(BinaryHeader) && 0==std::memcmp( file.ptr(), LINKMAP_MAGIC, sizeof(((BinaryHeader*)0)->magic)))
+	{
+		mapBinary( filename);
+	}
+	else
+	{
+		char const* li = file.ptr();
+		char const* le = li + file.size();
+		char const* ln = (const char*)std::memchr( li, '\n', le-li);
+		for (; ln; li=ln+1,ln = (const char*)std::memchr( li, '\n', le-li))
+		{
+			if (ln-li>0) addLine( std::string( li, ln-li));
+		}
+		if (li < le) addLine( std::string( li, le-li));
+		compile();
+	}
+}
+
+void LinkMap::mapBinary( const std::string& filename)
+{
+	if (m_file || !m_map.empty()) throw std::runtime_error( _TXT("a binary link map file can only be loaded into an empty link map"));
+	MemoryMappedFile* file = new MemoryMappedFile( filename, MemoryMappedFile::RandomAccess);
+	try
+	{
+		setImage( file->ptr(), file->size(), filename);
+		m_file = file;
+	}
+	catch (...)
 	{
-		if (ln-li>0) addLine( std::string( li, ln-li));
+		delete file;
+		throw;
 	}
-	if (*li) addLine( li);
+}
+
+void LinkMap::setImage( const char* ptr, std::size_t size, const std::string& name)
+{
+	const BinaryHeader* hdr = (const BinaryHeader*)ptr;
+	if (hdr->byteorder != LINKMAP_BYTEORDER) throw std::runtime_error( strus::string_format( _TXT("link map file %s has been written on a platform with a different byte order"), name.c_str()));
+	if (hdr->version != LINKMAP_VERSION) throw std::runtime_error( strus::string_format( _TXT("unknown version %u of link map file %s"), (unsigned int)hdr->version, name.c_str()));
+	uint64_t expectedSize = sizeof(BinaryHeader) + (uint64_t)hdr->nofEntries * (sizeof(int32_t) + sizeof(BinaryEntry)) + hdr->stringsSize;
+	if (expectedSize != (uint64_t)size || hdr->stringsSize == 0 || ptr[ size-1] != '\0')
+	{
+		throw std::runtime_error( strus::string_format( _TXT("corrupt link map file %s"), name.c_str()));
+	}
+	m_nofEntries = hdr->nofEntries;
+	m_stringsSize = hdr->stringsSize;
+	m_displacements = (const int32_t*)(ptr + sizeof(BinaryHeader));
+	m_entries = (const BinaryEntry*)(m_displacements + m_nofEntries);
+	m_strings = (const char*)(m_entries + m_nofEntries);
+}
+
+void LinkMap::resetImage()
+{
+	if (m_file) throw std::runtime_error( _TXT("link map loaded from a binary file is read only"));
+	m_image.clear();
+	m_displacements = 0;
+	m_entries = 0;
+	m_strings = 0;
+	m_nofEntries = 0;
+	m_stringsSize = 0;
+}
+
+void LinkMap::compile()
+{
+	resetImage();
+	buildImage( m_image);
+	setImage( m_image.c_str(), m_image.size(), "<memory>");
 }
 
 void LinkMap::write( std::ostream& out) const
 {
+	if (m_map.empty())
+	{
+		uint32_t ei = 0, ee = m_nofEntries;
+		for (; ei != ee; ++ei)
+		{
+			out << (m_strings + m_entries[ ei].key) << '\t' << (m_strings + m_entries[ ei].val) << "\n";
+		}
+		return;
+	}
 	std::map<int,int>::const_iterator mi = m_map.begin(), me = m_map.end();
 	for (; mi != me; ++mi)
 	{
@@ -69,8 +186,149 @@ void LinkMap::write( const std::string& filename) const
 	if (ec) throw std::runtime_error( strus::string_format( _TXT("error writing link map file %s: %s"), filename.c_str(), ::strerror(ec)));
 }
 
+/// \brief Orders buckets of the perfect hash construction by descending size
+struct BucketSizeOrder
+{
+	explicit BucketSizeOrder( const std::vector<std::vector<uint32_t> >& buckets_)
+		:buckets(buckets_){}
+	bool operator()( uint32_t aa, uint32_t bb) const
+	{
+		if (buckets[ aa].size() != buckets[ bb].size()) return buckets[ aa].size() > buckets[ bb].size();
+		return aa < bb;
+	}
+	const std::vector<std::vector<uint32_t> >& buckets;
+};
+
+/// \brief Add a string to the string table of the binary format if not already there
+/// \return the offset of the string in the table
+static uint32_t binaryStringOffset( std::string& strings, std::map<const char*,uint32_t>& offsetmap, const char* str)
+{
+	std::map<const char*,uint32_t>::const_iterator oi = offsetmap.find( str);
+	if (oi != offsetmap.end()) return oi->second;
+	std::size_t rt = strings.size();
+	strings.append( str);
+	strings.push_back( '\0');
+	if (strings.size() > (std::size_t)std::numeric_limits<uint32_t>::max()) throw std::runtime_error( _TXT("too many strings for binary link map"));
+	offsetmap[ str] = rt;
+	return rt;
+}
+
+void LinkMap::writeBinary( const std::string& filename) const
+{
+	std::string content;
+	buildImage( content);
+	int ec = strus::writeFile( filename, content);
+	if (ec) throw std::runtime_error( strus::string_format( _TXT("error writing link map file %s: %s"), filename.c_str(), ::strerror(ec)));
+}
+
+void LinkMap::buildImage( std::string& content) const
+{
+	// [1] Collect the key value pairs and build the string table:
+	std::vector<std::pair<const char*,const char*> > pairs;
+	if (m_map.empty())
+	{
+		uint32_t ei = 0, ee = m_nofEntries;
+		for (; ei != ee; ++ei)
+		{
+			pairs.push_back( std::pair<const char*,const char*>( m_strings + m_entries[ ei].key, m_strings + m_entries[ ei].val));
+		}
+	}
+	else
+	{
+		std::map<int,int>::const_iterator mi = m_map.begin(), me = m_map.end();
+		for (; mi != me; ++mi)
+		{
+			pairs.push_back( std::pair<const char*,const char*>( m_symtab.key( mi->first), m_symtab.key( mi->second)));
+		}
+	}
+	if (pairs.size() > (std::size_t)std::numeric_limits<int32_t>::max()) throw std::runtime_error( _TXT("too many entries for binary link map"));
+	uint32_t nofEntries = pairs.size();
+	std::string strings( 1, '\0');
+	std::map<const char*,uint32_t> offsetmap;
+	std::vector<BinaryEntry> entries( nofEntries);
+	std::vector<uint32_t> keyOffsets( nofEntries);
+	std::vector<uint32_t> valOffsets( nofEntries);
+	for (uint32_t pi = 0; pi != nofEntries; ++pi)
+	{
+		keyOffsets[ pi] = binaryStringOffset( strings, offsetmap, pairs[ pi].first);
+		valOffsets[ pi] = binaryStringOffset( strings, offsetmap, pairs[ pi].second);
+	}
+
+	// [2] Build the minimal perfect hash with the hash and displace method:
+	//	The keys are distributed into buckets with a first hash function.
+	//	Starting with the biggest bucket, a second hash function seeded by a displacement is searched, that maps all keys of the bucket to free slots.
+	//	Keys alone in a bucket are put directly into the remaining free slots, encoded as negative displacement.
+	std::vector<int32_t> displacements( nofEntries, 0);
+	std::vector<std::vector<uint32_t> > buckets( nofEntries);
+	for (uint32_t pi = 0; pi != nofEntries; ++pi)
+	{
+		buckets[ linkKeyHash( 0, pairs[ pi].first) % nofEntries].push_back( pi);
+	}
+	std::vector<uint32_t> order( nofEntries);
+	for (uint32_t bi = 0; bi != nofEntries; ++bi) order[ bi] = bi;
+	std::sort( order.begin(), order.end(), BucketSizeOrder( buckets));
+
+	std::vector<bool> occupied( nofEntries, false);
+	std::vector<uint32_t> bucketSlots;
+	uint32_t oi = 0;
+	for (; oi != nofEntries && buckets[ order[ oi]].size() > 1; ++oi)
+	{
+		const std::vector<uint32_t>& bucket = buckets[ order[ oi]];
+		int32_t displacement = 1;
+		for (;; ++displacement)
+		{
+			if (displacement == std::numeric_limits<int32_t>::max()) throw std::runtime_error( _TXT("failed to build perfect hash for binary link map, duplicate keys?"));
+			bucketSlots.clear();
+			std::vector<uint32_t>::const_iterator ki = bucket.begin(), ke = bucket.end();
+			for (; ki != ke; ++ki)
+			{
+				uint32_t slot = linkKeyHash( displacement, pairs[ *ki].first) % nofEntries;
+				if (occupied[ slot] || std::find( bucketSlots.begin(), bucketSlots.end(), slot) != bucketSlots.end()) break;
+				bucketSlots.push_back( slot);
+			}
+			if (ki == ke) break;
+		}
+		displacements[ order[ oi]] = displacement;
+		for (std::size_t ki = 0; ki != bucket.size(); ++ki)
+		{
+			occupied[ bucketSlots[ ki]] = true;
+			entries[ bucketSlots[ ki]].key = keyOffsets[ bucket[ ki]];
+			entries[ bucketSlots[ ki]].val = valOffsets[ bucket[ ki]];
+		}
+	}
+	uint32_t freeSlot = 0;
+	for (; oi != nofEntries && buckets[ order[ oi]].size() == 1; ++oi)
+	{
+		while (occupied[ freeSlot]) ++freeSlot;
+		uint32_t pi = buckets[ order[ oi]][ 0];
+		occupied[ freeSlot] = true;
+		entries[ freeSlot].key = keyOffsets[ pi];
+		entries[ freeSlot].val = valOffsets[ pi];
+		displacements[ order[ oi]] = -(int32_t)freeSlot - 1;
+	}
+
+	// [3] Serialize the image:
+	BinaryHeader hdr;
+	std::memcpy( hdr.magic, LINKMAP_MAGIC, sizeof(hdr.magic));
+	hdr.byteorder = LINKMAP_BYTEORDER;
+	hdr.version = LINKMAP_VERSION;
+	hdr.nofEntries = nofEntries;
+	hdr.stringsSize = strings.size();
+
+	content.clear();
+	content.reserve( sizeof(hdr) + nofEntries * (sizeof(int32_t) + sizeof(BinaryEntry)) + strings.size());
+	content.append( (const char*)&hdr, sizeof(hdr));
+	if (nofEntries)
+	{
+		content.append( (const char*)&displacements[0], nofEntries * sizeof(int32_t));
+		content.append( (const char*)&entries[0], nofEntries * sizeof(BinaryEntry));
+	}
+	content.append( strings);
+}
+
 void LinkMap::define( const std::string& key, const std::string& value)
 {
+	if (m_strings) resetImage();
 	int keyidx = m_symtab.getOrCreate( key);
 	if (!keyidx) throw std::runtime_error( m_errorhnd->fetchError());
 	int validx = m_symtab.getOrCreate( value);
@@ -80,6 +338,19 @@ void LinkMap::define( const std::string& key, const std::string& value)
 
 const char* LinkMap::get( const std::string& key) const
 {
+	if (m_strings)
+	{
+		char normbuf[ NormalizeBufferSize];
+		if (key.size() < (std::size_t)NormalizeBufferSize)
+		{
+			normalizeValue( normbuf, key.c_str());
+			return getNormalized( normbuf);
+		}
+		else
+		{
+			return getNormalized( normalizeValue( key).c_str());
+		}
+	}
 	int keyidx = m_symtab.get( normalizeValue( key));
 	if (!keyidx) return 0;
 	std::map<int,int>::const_iterator mi = m_map.find( keyidx);
@@ -87,6 +358,31 @@ const char* LinkMap::get( const std::string& key) const
 	return m_symtab.key( mi->second);
 }
 
+const char* LinkMap::getNormalized( const char* normkey) const
+{
+	if (!m_nofEntries) return 0;
+	int32_t displacement = m_displacements[ linkKeyHash( 0, normkey) % m_nofEntries];
+	uint32_t slot;
+	if (displacement < 0)
+	{
+		slot = (uint32_t)(-(displacement+1));
+	}
+	else if (displacement > 0)
+	{
+		slot = linkKeyHash( displacement, normkey) % m_nofEntries;
+	}
+	else
+	{
+		return 0;
+	}
+	if (slot >= m_nofEntries || m_entries[ slot].key >= m_stringsSize || m_entries[ slot].val >= m_stringsSize)
+	{
+		throw std::runtime_error( _TXT("corrupt binary link map"));
+	}
+	if (0!=std::strcmp( m_strings + m_entries[ slot].key, normkey)) return 0;
+	return m_strings + m_entries[ slot].val;
+}
+
 std::pair<std::string,std::string> LinkMap::getLinkParts( const std::string& linkid)
 {
 	char const* mid = std::strchr( linkid.c_str(), '#');
@@ -108,13 +404,35 @@ static bool isEqualWord( const char* start, const char* word)
 	return *wi == '\0' && ((unsigned char)*si <= 32);
 }
 
-static bool isUnimportantWord( const char* start)
+/// \brief Table of the words not capitalized in a normalized link, indexed by their first letter
+class UnimportantWordTable
 {
-	static const char* ar[] = {"the","a","an","aboard","about","above","across","after","against","along","amid","among","anti","around","as","at","before","behind","below","beneath","beside","besides","between","beyond","but","by","concerning","considering","despite","down","during","except","excepting","excluding","following","for","from","in","inside","into","like","minus","near","of","off","on","onto","opposite","outside","over","past","per","plus","regarding","round","save","since","than","through","to","toward","towards","under","underneath","unlike","until","up","upon","versus","via","with","within","without",0};
-	int ai=0;
-	for (; ar[ai] && !isEqualWord( start, ar[ai]); ++ai){}
-	return !!ar[ai];
-}
+public:
+	UnimportantWordTable()
+	{
+		static const char* ar[] = {"the","a","an","aboard","about","above","across","after","against","along","amid","among","anti","around","as","at","before","behind","below","beneath","beside","besides","between","beyond","but","by","concerning","considering","despite","down","during","except","excepting","excluding","following","for","from","in","inside","into","like","minus","near","of","off","on","onto","opposite","outside","over","past","per","plus","regarding","round","save","since","than","through","to","toward","towards","under","underneath","unlike","until","up","upon","versus","via","with","within","without",0};
+		int ai=0;
+		for (; ar[ai]; ++ai)
+		{
+			m_words[ ar[ai][0] - 'a'].push_back( ar[ai]);
+		}
+	}
+
+	/// \brief Test if a lowercase word starts at the position passed
+	/// \param[in] start pointer to the first character of the word, a lowercase letter in the range 'a' to 'z'
+	bool find( const char* start) const
+	{
+		const std::vector<const char*>& words = m_words[ *start - 'a'];
+		std::vector<const char*>::const_iterator wi = words.begin(), we = words.end();
+		for (; wi != we && !isEqualWord( start, *wi); ++wi){}
+		return wi != we;
+	}
+
+private:
+	std::vector<const char*> m_words[ 26];
+};
+
+static const UnimportantWordTable g_unimportantWords;
 
 static char nextNormalizeChar( const char* vi, char back)
 {
@@ -124,7 +442,7 @@ static char nextNormalizeChar( const char* vi, char back)
 	}
 	else if (back == ' ' && *vi >= 'a' && *vi <= 'z')
 	{
-		if (isUnimportantWord( vi))
+		if (g_unimportantWords.find( vi))
 		{
 			return *vi;
 		}
@@ -140,28 +458,28 @@ static char nextNormalizeChar( const char* vi, char back)
 	return '\0';
 }
 
-std::string LinkMap::normalizeValue( const std::string& vv)
+std::size_t LinkMap::normalizeValue( char* buf, const char* vv)
 {
-	std::string rt;
-	if (!vv.empty())
+	std::size_t rt = 0;
+	char const* vi = vv;
+	for (; *vi; ++vi)
 	{
-		char const* vi = vv.c_str();
-		for (; *vi; ++vi)
+		char back = rt ? buf[ rt-1] : ' ';
+		char next = nextNormalizeChar( vi, back);
+		if (next)
 		{
-			char back = rt.empty() ? ' ' : rt[ rt.size()-1];
-			char next = nextNormalizeChar( vi, back);
-			if (next)
-			{
-				rt.push_back( next);
-			}
-		}
-		char back = rt.empty() ? '\0' : rt[ rt.size()-1];
-		while (back == ' ')
-		{
-			rt.resize( rt.size()-1);
-			back = rt.empty() ? '\0' : rt[ rt.size()-1];
+			buf[ rt++] = next;
 		}
 	}
+	while (rt && buf[ rt-1] == ' ') --rt;
+	buf[ rt] = '\0';
+	return rt;
+}
+
+std::string LinkMap::normalizeValue( const std::string& vv)
+{
+	std::string rt( vv.size(), '\0');
+	rt.resize( normalizeValue( &rt[0], vv.c_str()));
 	return rt;
 }
 
@@ -171,7 +489,8 @@ void LinkMapBuilder::define( const std::string& key)
 	int validx = m_symtab.getOrCreate( normval);
 	int origvalidx = m_symtab.getOrCreate( key);
 	if (!validx) throw std::runtime_error(_TXT("failed to create symbol"));
-	m_idset[ validx] =  m_symtab.key( origvalidx);
+	if ((std::size_t)validx >= m_idmap.size()) m_idmap.resize( validx+1, 0);
+	m_idmap[ validx] = origvalidx;
 	redirect( key, key);
 }
 
@@ -181,58 +500,255 @@ void LinkMapBuilder::redirect( const std::string& key, const std::string& value)
 	std::string normval = LinkMap::normalizeValue( value);
 	int keyidx = m_symtab.getOrCreate( normkey);
 	int validx = m_symtab.getOrCreate( normval);
-	LnkDef lnkdef( keyidx, validx);
-	m_lnkdefmap.insert( lnkdef);
+	m_lnkdefs.push_back( LnkDef( keyidx, validx));
 }
 
-const char* LinkMapBuilder::transitiveFindValue( int validx, int depth) const
+/// \brief Data of a pass computing one level of the transitive redirect resolution
+/// \note A level d assigns to every title the original title of the page reached first following at most d redirects in the order of their definition, 0 if there is none.
+///	Level d is computed from level d-1 only, so the titles can be split into ranges processed in parallel.
+struct RedirectLevelPass
+{
+	const std::vector<int>* idmap;			///< original title of a page, 0 if not a page
+	const std::vector<std::size_t>* edgeStart;	///< index of the first redirect of a title in the edge array
+	const std::vector<int>* edgeTarget;		///< edge array of redirect targets sorted by source
+	const std::vector<int>* prev;			///< level d-1
+	std::vector<int>* cur;				///< level d to compute
+
+	void run( std::size_t start, std::size_t end) const
+	{
+		for (std::size_t ni = start; ni < end; ++ni)
+		{
+			int rt = ni < idmap->size() ? (*idmap)[ ni] : 0;
+			std::size_t ei = (*edgeStart)[ ni], ee = (*edgeStart)[ ni+1];
+			for (; !rt && ei != ee; ++ei)
+			{
+				rt = (*prev)[ (*edgeTarget)[ ei]];
+			}
+			(*cur)[ ni] = rt;
+		}
+	}
+};
+
+/// \brief Thread computing a level of the transitive redirect resolution for a range of titles
+class RedirectLevelThread
+{
+public:
+	RedirectLevelThread()
+		:m_pass(0),m_start(0),m_end(0),m_thread(0){}
+	~RedirectLevelThread()
+	{
+		join();
+	}
+
+	void start( const RedirectLevelPass* pass_, std::size_t start_, std::size_t end_)
+	{
+		m_pass = pass_;
+		m_start = start_;
+		m_end = end_;
+		if (m_thread) throw std::runtime_error( _TXT("start called twice"));
+		m_thread = new strus::thread( &RedirectLevelThread::run, this);
+	}
+	void join()
+	{
+		if (m_thread)
+		{
+			m_thread->join();
+			delete m_thread;
+			m_thread = 0;
+		}
+	}
+	void run()
+	{
+		m_pass->run( m_start, m_end);
+	}
+
+private:
+	const RedirectLevelPass* m_pass;
+	std::size_t m_start;
+	std::size_t m_end;
+	strus::thread* m_thread;
+};
+
+void LinkMapBuilder::build( LinkMap& res, int nofThreads)
 {
-	std::map<int,const char*>::const_iterator itr = m_idset.find( validx);
-	if (itr != m_idset.end()) return itr->second;
+	// [1] Build the flat edge array of redirects sorted by source:
+	std::sort( m_lnkdefs.begin(), m_lnkdefs.end());
+	m_lnkdefs.erase( std::unique( m_lnkdefs.begin(), m_lnkdefs.end()), m_lnkdefs.end());
 
-	if (depth <= 0) return NULL;
+	std::size_t nofNodes = m_symtab.size() + 1;
+	std::vector<std::size_t> edgeStart( nofNodes + 1, 0);
+	std::vector<int> edgeTarget( m_lnkdefs.size());
+	std::vector<LnkDef>::const_iterator li = m_lnkdefs.begin(), le = m_lnkdefs.end();
+	for (std::size_t eidx = 0; li != le; ++li,++eidx)
+	{
+		++edgeStart[ li->key + 1];
+		edgeTarget[ eidx] = li->val;
+	}
+	for (std::size_t ni = 0; ni < nofNodes; ++ni)
+	{
+		edgeStart[ ni+1] += edgeStart[ ni];
+	}
+
+	// [2] Compute the levels of the resolution, each level split into ranges of titles processed by parallel threads:
+	std::vector<int> prev( nofNodes, 0);
+	std::vector<int> cur( nofNodes, 0);
+	for (std::size_t ni = 0; ni < nofNodes && ni < m_idmap.size(); ++ni)
+	{
+		prev[ ni] = m_idmap[ ni];
+	}
+	RedirectLevelPass pass;
+	pass.idmap = &m_idmap;
+	pass.edgeStart = &edgeStart;
+	pass.edgeTarget = &edgeTarget;
+	std::size_t nofParts = nofThreads > 1 ? (std::size_t)nofThreads : 1;
+	if (nofParts > nofNodes) nofParts = 1;
+	std::vector<RedirectLevelThread> threads( nofParts > 1 ? nofParts : 0);
 
-	int keyidx = validx;
-	LnkDef lnkdef( keyidx, 0/*val base*/);
-	LnkDefSet::const_iterator li = m_lnkdefmap.upper_bound( lnkdef);
-	LnkDefSet::const_iterator le = m_lnkdefmap.end();
+	for (int depth = 1; depth <= TransitiveSearchDepth; ++depth)
+	{
+		pass.prev = &prev;
+		pass.cur = &cur;
+		if (nofParts > 1)
+		{
+			std::size_t pi = 0;
+			for (; pi < nofParts; ++pi)
+			{
+				threads[ pi].start( &pass, nofNodes * pi / nofParts, nofNodes * (pi+1) / nofParts);
+			}
+			for (pi = 0; pi < nofParts; ++pi)
+			{
+				threads[ pi].join();
+			}
+		}
+		else
+		{
+			pass.run( 0, nofNodes);
+		}
+		prev.swap( cur);
+	}
 
-	for (; li != le && li->key == keyidx; ++li)
+	// [3] Define the links resolved:
+	bool hasUnresolved = false;
+	for (std::size_t ni = 1; ni < nofNodes; ++ni)
+	{
+		if (edgeStart[ ni] == edgeStart[ ni+1]) continue;
+		if (prev[ ni])
+		{
+			res.define( m_symtab.key( ni), m_symtab.key( prev[ ni]));
+		}
+		else
+		{
+			hasUnresolved = true;
+		}
+	}
+	if (hasUnresolved)
 	{
-		const char* rt = transitiveFindValue( li->val, depth-1);
-		if (rt) return rt;
+		classifyUnresolved( edgeStart, prev);
 	}
-	return NULL;
 }
 
-void LinkMapBuilder::build( LinkMap& res)
+void LinkMapBuilder::classifyUnresolved( const std::vector<std::size_t>& edgeStart, const std::vector<int>& resolved)
 {
-	LnkDefSet::const_iterator li = m_lnkdefmap.begin(), le = m_lnkdefmap.end();
-	while (li != le)
+	std::size_t nofNodes = edgeStart.size() - 1;
+
+	// [1] Build the reverse edge array:
+	std::vector<std::size_t> revStart( nofNodes + 1, 0);
+	std::vector<int> revSource( m_lnkdefs.size());
+	std::vector<LnkDef>::const_iterator li = m_lnkdefs.begin(), le = m_lnkdefs.end();
+	for (; li != le; ++li)
+	{
+		++revStart[ li->val + 1];
+	}
+	for (std::size_t ni = 0; ni < nofNodes; ++ni)
+	{
+		revStart[ ni+1] += revStart[ ni];
+	}
+	std::vector<std::size_t> revPos( revStart.begin(), revStart.end()-1);
+	for (li = m_lnkdefs.begin(); li != le; ++li)
+	{
+		revSource[ revPos[ li->val]++] = li->key;
+	}
+
+	// [2] Mark the titles leading to a page at any depth:
+	std::vector<bool> reachesPage( nofNodes, false);
+	std::vector<int> queue;
+	for (std::size_t ni = 1; ni < nofNodes && ni < m_idmap.size(); ++ni)
 	{
-		LnkDefSet::const_iterator next_li = li;
-		for (++next_li; next_li != le && next_li->key == li->key; ++next_li){}
+		if (m_idmap[ ni])
+		{
+			reachesPage[ ni] = true;
+			queue.push_back( ni);
+		}
+	}
+	while (!queue.empty())
+	{
+		int ni = queue.back();
+		queue.pop_back();
+		std::size_t ri = revStart[ ni], re = revStart[ ni+1];
+		for (; ri != re; ++ri)
+		{
+			if (!reachesPage[ revSource[ ri]])
+			{
+				reachesPage[ revSource[ ri]] = true;
+				queue.push_back( revSource[ ri]);
+			}
+		}
+	}
 
-		const char* keystr = m_symtab.key( li->key);
-		for (; li != next_li; ++li)
+	// [3] Remove the titles not leading to a page and not leading into a cycle, starting with the dead ends:
+	//	The titles remaining are the ones that lead into a cycle.
+	std::vector<std::size_t> outdegree( nofNodes, 0);
+	for (std::size_t ni = 1; ni < nofNodes; ++ni)
+	{
+		outdegree[ ni] = edgeStart[ ni+1] - edgeStart[ ni];
+		if (!reachesPage[ ni] && !outdegree[ ni]) queue.push_back( ni);
+	}
+	while (!queue.empty())
+	{
+		int ni = queue.back();
+		queue.pop_back();
+		std::size_t ri = revStart[ ni], re = revStart[ ni+1];
+		for (; ri != re; ++ri)
 		{
-			const char* selectedval = transitiveFindValue( li->key, TransitiveSearchDepth);
-			if (selectedval)
+			if (!reachesPage[ revSource[ ri]] && --outdegree[ revSource[ ri]] == 0)
 			{
-				res.define( keystr, selectedval);
-				break;
+				queue.push_back( revSource[ ri]);
 			}
 		}
-		if (li == next_li)
+	}
+
+	// [4] Classify the links not resolved:
+	for (std::size_t ni = 1; ni < nofNodes; ++ni)
+	{
+		if (edgeStart[ ni] == edgeStart[ ni+1] || resolved[ ni]) continue;
+		const char* keystr = m_symtab.key( ni);
+		if (reachesPage[ ni])
+		{
+			m_depthExceeded.push_back( keystr);
+		}
+		else if (outdegree[ ni])
+		{
+			m_cycles.push_back( keystr);
+		}
+		else
 		{
-			m_unresolved.insert( keystr);
+			m_unresolved.push_back( keystr);
 		}
-		li = next_li;
 	}
 }
 
 std::vector<const char*> LinkMapBuilder::unresolved() const
 {
-	return std::vector<const char*>( m_unresolved.begin(), m_unresolved.end());
+	return m_unresolved;
+}
+
+std::vector<const char*> LinkMapBuilder::cycles() const
+{
+	return m_cycles;
+}
+
+std::vector<const char*> LinkMapBuilder::depthExceeded() const
+{
+	return m_depthExceeded;
 }
 
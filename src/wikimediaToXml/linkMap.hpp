@@ -11,6 +11,7 @@
 #ifndef _STRUS_WIKIPEDIA_LINK_MAP_HPP_INCLUDED
 #define _STRUS_WIKIPEDIA_LINK_MAP_HPP_INCLUDED
 #include "strus/base/symbolTable.hpp"
+#include "memoryMappedFile.hpp"
 #include <string>
 #include <map>
 #include <set>
@@ -19,58 +20,102 @@
 #include <cstring>
 #include <sstream>
 #include <iostream>
+#include <stdint.h>
 
 namespace strus {
 
 /// \brief Forward declaration
 class ErrorBufferInterface;
 
+/// \brief Map of normalized link identifiers to page titles
+/// \note The map is either built in memory or mapped read only from a file in the binary format written by writeBinary. The binary format contains a minimal perfect hash over the normalized keys and a packed string table, it is shared without copying by all threads. A map loaded from a text file is compiled into the same format in memory for lookups.
 class LinkMap
 {
 public:
 	
 	explicit LinkMap( ErrorBufferInterface* errorhnd_)
-		:m_errorhnd(errorhnd_),m_symtab(errorhnd_),m_map(){}
+		:m_errorhnd(errorhnd_),m_symtab(errorhnd_),m_map(),m_file(0),m_image(),m_displacements(0),m_entries(0),m_strings(0),m_nofEntries(0),m_stringsSize(0){}
+	~LinkMap();
 
 	void init( const SymbolTable& symtab_, const std::map<int,int>& map_);
+	/// \brief Load a link map file, binary files are mapped into memory, text files (key and value separated by a tab per line) are parsed
 	void load( const std::string& filename);
 
 	void write( std::ostream& out) const;
 	void write( const std::string& filename) const;
+	/// \brief Write the link map in the binary format
+	void writeBinary( const std::string& filename) const;
 
 	void define( const std::string& key, const std::string& value);
+	/// \brief Get the value of a link
+	/// \note Safe to be called concurrently, without allocations for keys shorter than NormalizeBufferSize when the map has been loaded
 	const char* get( const std::string& key) const;
 
 public:
+	enum {NormalizeBufferSize=512};
 	static std::string normalizeValue( const std::string& vv);
+	/// \brief Normalize a link into a buffer
+	/// \param[out] buf buffer with space for strlen(vv)+1 characters, the result is 0-terminated
+	/// \param[in] vv 0-terminated link to normalize
+	/// \return the length of the result
+	static std::size_t normalizeValue( char* buf, const char* vv);
 	static std::pair<std::string,std::string> getLinkParts( const std::string& linkid);
 
 private:
 	void addLine( const std::string& ln);
+	void mapBinary( const std::string& filename);
+	void setImage( const char* ptr, std::size_t size, const std::string& name);
+	void resetImage();
+	void compile();
+	void buildImage( std::string& content) const;
+	const char* getNormalized( const char* normkey) const;
 
 private:
+	LinkMap( const LinkMap&);		//... non copyable
+	void operator=( const LinkMap&);	//... non copyable
+
+private:
+	struct BinaryEntry;
+
 	ErrorBufferInterface* m_errorhnd;
 	SymbolTable m_symtab;
 	std::map<int,int> m_map;
+	MemoryMappedFile* m_file;		///< file mapped if the map was loaded from a binary file
+	std::string m_image;			///< binary image built in memory if the map was loaded from a text file
+	const int32_t* m_displacements;		///< bucket displacements of the perfect hash in the binary image
+	const BinaryEntry* m_entries;		///< key value pairs in the binary image, one per hash slot
+	const char* m_strings;			///< string table in the binary image or NULL if there is no image for lookups
+	uint32_t m_nofEntries;			///< number of key value pairs in the binary image
+	uint32_t m_stringsSize;			///< size of the string table in the binary image
 };
 
 
+/// \brief Collects page definitions and redirects and resolves the redirects to pages
 class LinkMapBuilder
 {
 public:
 	explicit LinkMapBuilder( ErrorBufferInterface* errorhnd_)
-		:m_errorhnd(errorhnd_),m_symtab(errorhnd_),m_lnkdefmap(),m_idset(),m_unresolved(){}
+		:m_errorhnd(errorhnd_),m_symtab(errorhnd_),m_lnkdefs(),m_idmap(),m_unresolved(),m_cycles(),m_depthExceeded(){}
 
-	void build( LinkMap& res);
+	/// \brief Resolve the redirects and define the links resolved in a link map
+	/// \param[out] res link map to fill
+	/// \param[in] nofThreads number of threads resolving the redirects in parallel, 0 for resolving them in the calling thread
+	/// \note A link is resolved to the page reached first in a depth first search following at most TransitiveSearchDepth redirects in the order of their definition
+	void build( LinkMap& res, int nofThreads=0);
 
+	/// \brief Get the links not leading to any page
 	std::vector<const char*> unresolved() const;
+	/// \brief Get the links not resolved because they lead into a cycle of redirects without reaching a page
+	std::vector<const char*> cycles() const;
+	/// \brief Get the links not resolved because the pages they lead to are more than TransitiveSearchDepth redirects away
+	std::vector<const char*> depthExceeded() const;
 
 	void redirect( const std::string& key, const std::string& value);
 	void define( const std::string& key);
 
 private:
 	enum {TransitiveSearchDepth=6};
-	const char* transitiveFindValue( int validx, int depth) const;
+	void classifyUnresolved( const std::vector<std::size_t>& edgeStart, const std::vector<int>& resolved);
 
 private:
 	struct LnkDef
@@ -91,14 +136,19 @@ private:
 			if (key > o.key) return false;
 			return val < o.val;
 		}
+		bool operator == ( const LnkDef& o) const
+		{
+			return key == o.key && val == o.val;
+		}
 	};
 	ErrorBufferInterface* m_errorhnd;
 	SymbolTable m_symtab;
-	typedef std::set<LnkDef> LnkDefSet;
 
-	LnkDefSet m_lnkdefmap;
-	std::map<int,const char*> m_idset;
-	std::set<const char*> m_unresolved;
+	std::vector<LnkDef> m_lnkdefs;			///< redirects as flat edge array, sorted and made unique by build
+	std::vector<int> m_idmap;			///< map of the normalized title of a page to its original title, 0 if not a page
+	std::vector<const char*> m_unresolved;
+	std::vector<const char*> m_cycles;
+	std::vector<const char*> m_depthExceeded;
 };
 
 }//namespace
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Resolving the page links of converted documents after the link map has been built (single pass conversion)
+/// \file linkPatch.cpp
+#include "linkPatch.hpp"
+#include "linkMap.hpp"
+#include "xmlEscape.hpp"
+#include "documentStructure.hpp"
+#include <cstring>
+#include <cstdlib>
+
+using namespace strus;
+
+/// \brief Decode the entities of an attribute value printed by the XML printer of the document structure
+static std::string decodeAttributeValue( const char* src, std::size_t size)
+{
+	std::string rt;
+	rt.reserve( size);
+	char const* si = src;
+	const char* se = src + size;
+	while (si != se)
+	{
+		if (*si != '&')
+		{
+			rt.push_back( *si++);
+			continue;
+		}
+		const char* end = (const char*)std::memchr( si, ';', se - si);
+		if (!end)
+		{
+			rt.append( si, se - si);
+			break;
+		}
+		std::size_t len = end - si - 1;
+		const char* ent = si + 1;
+		if (len == 2 && ent[0] == 'l' && ent[1] == 't') rt.push_back( '<');
+		else if (len == 2 && ent[0] == 'g' && ent[1] == 't') rt.push_back( '>');
+		else if (len == 3 && 0==std::memcmp( ent, "amp", 3)) rt.push_back( '&');
+		else if (len == 4 && 0==std::memcmp( ent, "apos", 4)) rt.push_back( '\'');
+		else if (len == 4 && 0==std::memcmp( ent, "quot", 4)) rt.push_back( '"');
+		else if (len >= 2 && len <= 4 && ent[0] == '#' && std::strspn( ent+1, "0123456789") == len-1)
+		{
+			//... the printer encodes only ASCII control characters as numeric entities
+			rt.push_back( (char)std::atoi( std::string( ent+1, len-1).c_str()));
+		}
+		else
+		{
+			rt.append( si, end - si + 1);
+		}
+		si = end + 1;
+	}
+	return rt;
+}
+
+/// \brief Get the start tag of the text of a page link printed with an id marking it as set with DocumentStructure::setDeferredLinkText
+static std::string deferredLinkTextTag( const char* id)
+{
+	return std::string( "<text id=\"") + id + "\">";
+}
+
+bool strus::patchPageLinks( std::string& content, const LinkMap& linkmap, std::set<std::string>& unresolved)
+{
+	static const char* pagelinktag = "<pagelink id=\"";
+	enum {PageLinkTagLen = 14};
+	const std::string contentTextTag( deferredLinkTextTag( DocumentStructure::deferredLinkTextContentId()));
+	const std::string dropTextTag( deferredLinkTextTag( DocumentStructure::deferredLinkTextDropId()));
+	static const char* deferredTextTagPrefix = "<text id=\"deferred:";
+	static const char* textCloseTag = "</text>";
+	enum {TextCloseTagLen = 7};
+	static const char* pagelinkCloseTag = "</pagelink>";
+	enum {PageLinkCloseTagLen = 11};
+
+	std::string rt;
+	bool modified = false;
+	std::size_t pos = 0;
+	std::size_t start = content.find( pagelinktag);
+	while (start != std::string::npos)
+	{
+		std::size_t valuepos = start + PageLinkTagLen;
+		std::size_t valueend = content.find( '"', valuepos);
+		if (valueend == std::string::npos) break;
+
+		std::string link = decodeAttributeValue( content.c_str() + valuepos, valueend - valuepos);
+		const char* target = linkmap.get( link);
+		if (!target)
+		{
+			unresolved.insert( link);
+		}
+		else if (link != target)
+		{
+			if (!modified)
+			{
+				rt.reserve( content.size() + content.size() / 16);
+				modified = true;
+			}
+			rt.append( content.c_str() + pos, valuepos - pos);
+			strus::appendXmlEscaped( rt, target, std::strlen( target), strus::XmlEscapeAttributeValue);
+			pos = valueend;
+		}
+		start = content.find( pagelinktag, valueend);
+
+		//... the marked text of the link, if it exists, is its only element besides attributes, so it is before the end of the link and before any other link
+		std::size_t textpos = content.find( deferredTextTagPrefix, valueend);
+		std::size_t linkend = content.find( pagelinkCloseTag, valueend);
+		if (textpos == std::string::npos || textpos > linkend || textpos > start) continue;
+
+		std::size_t textend = content.find( textCloseTag, textpos);
+		if (textend == std::string::npos) break;
+		bool isContent = 0==content.compare( textpos, contentTextTag.size(), contentTextTag);
+		const std::string& texttag = isContent ? contentTextTag : dropTextTag;
+		if (!isContent && 0!=content.compare( textpos, dropTextTag.size(), dropTextTag)) continue;
+		if (!modified)
+		{
+			rt.reserve( content.size() + content.size() / 16);
+			modified = true;
+		}
+		rt.append( content.c_str() + pos, textpos - pos);
+		if (target)
+		{
+			//... resolved link, its text is printed as the text of a link resolved when converting
+			rt.append( "<text>");
+			pos = textpos + texttag.size();
+		}
+		else if (isContent)
+		{
+			//... unresolved link without attributes, its text is printed as content of the link as in a conversion without link map
+			rt.append( content.c_str() + textpos + texttag.size(), textend - textpos - texttag.size());
+			pos = textend + TextCloseTagLen;
+		}
+		else
+		{
+			//... unresolved link with attributes, no text as in a conversion without link map
+			pos = textend + TextCloseTagLen;
+			std::size_t closepos = pos;
+			while (closepos < content.size() && (unsigned char)content[ closepos] <= 32) ++closepos;
+			if (closepos == linkend && !rt.empty() && rt[ rt.size()-1] == '>' && (rt.size() < 2 || rt[ rt.size()-2] != '/'))
+			{
+				//... the link has no content left, printed as empty element
+				rt.resize( rt.size()-1);
+				rt.append( "/>");
+				pos = linkend + PageLinkCloseTagLen;
+			}
+		}
+	}
+	if (modified)
+	{
+		rt.append( content.c_str() + pos, content.size() - pos);
+		content.swap( rt);
+	}
+	return modified;
+}
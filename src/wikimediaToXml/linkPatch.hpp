@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Resolving the page links of converted documents after the link map has been built (single pass conversion)
+/// \file linkPatch.hpp
+#ifndef _STRUS_WIKIPEDIA_LINK_PATCH_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_LINK_PATCH_HPP_INCLUDED
+#include <string>
+#include <set>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Forward declaration
+class LinkMap;
+
+/// \brief Replace the ids of the page links in the XML output of a document by their targets in a link map
+/// \note The text of the links marked as set with DocumentStructure::setDeferredLinkText is turned into the form written by a conversion with the link map loaded: a text element if the link is resolved, the content of an unresolved link else
+/// \param[in,out] content XML output of a document converted with page links deferred (see parseDocumentText)
+/// \param[in] linkmap map for resolving the page links
+/// \param[out] unresolved set of the page links not found in the link map
+/// \return true if the content has been changed
+bool patchPageLinks( std::string& content, const LinkMap& linkmap, std::set<std::string>& unresolved);
+
+}//namespace
+#endif
+
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Read only memory mapped file
+/// \file memoryMappedFile.cpp
+#include "memoryMappedFile.hpp"
+#include "strus/base/string_format.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define _TXT(XX) XX
+
+using namespace strus;
+
+MemoryMappedFile::MemoryMappedFile( const std::string& filename_, Access access_)
+	:m_filename(filename_),m_ptr(0),m_size(0)
+{
+	int fd = ::open( m_filename.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		int ec = errno;
+		throw std::runtime_error( strus::string_format( _TXT("failed to open file '%s' for mapping: %s"), m_filename.c_str(), ::strerror(ec)));
+	}
+	struct stat st;
+	if (::fstat( fd, &st) != 0)
+	{
+		int ec = errno;
+		::close( fd);
+		throw std::runtime_error( strus::string_format( _TXT("failed to get size of file '%s' to map: %s"), m_filename.c_str(), ::strerror(ec)));
+	}
+	m_size = st.st_size;
+	if (m_size == 0)
+	{
+		::close( fd);
+		m_ptr = "";
+		return;
+	}
+	void* ptr = ::mmap( NULL, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	int ec = errno;
+	::close( fd);
+	if (ptr == MAP_FAILED)
+	{
+		throw std::runtime_error( strus::string_format( _TXT("failed to map file '%s' into memory: %s"), m_filename.c_str(), ::strerror(ec)));
+	}
+	(void)::madvise( ptr, m_size, access_ == RandomAccess ? MADV_RANDOM : MADV_SEQUENTIAL);
+	m_ptr = (const char*)ptr;
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+	if (m_size) ::munmap( const_cast<char*>(m_ptr), m_size);
+}
+
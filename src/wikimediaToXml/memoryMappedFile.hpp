@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Read only memory mapped file
+/// \file memoryMappedFile.hpp
+#ifndef _STRUS_WIKIPEDIA_MEMORY_MAPPED_FILE_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_MEMORY_MAPPED_FILE_HPP_INCLUDED
+#include <string>
+#include <cstddef>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Read only mapping of a whole file into memory
+class MemoryMappedFile
+{
+public:
+	/// \brief Expected pattern of accesses, passed as advice to the kernel
+	enum Access {SequentialAccess, RandomAccess};
+
+	/// \brief Constructor, maps the file
+	/// \param[in] filename_ path of the file to map
+	/// \param[in] access_ expected pattern of accesses to the mapped content
+	/// \note Throws a std::runtime_error if the file could not be mapped
+	explicit MemoryMappedFile( const std::string& filename_, Access access_ = SequentialAccess);
+	~MemoryMappedFile();
+
+	/// \brief Pointer to the start of the mapped file content
+	const char* ptr() const				{return m_ptr;}
+	/// \brief Size of the mapped file in bytes
+	std::size_t size() const			{return m_size;}
+	/// \brief Name of the file mapped
+	const std::string& filename() const		{return m_filename;}
+
+private:
+	MemoryMappedFile( const MemoryMappedFile&){}	//... non copyable
+	void operator=( const MemoryMappedFile&){}	//... non copyable
+
+private:
+	std::string m_filename;
+	const char* m_ptr;
+	std::size_t m_size;
+};
+
+}//namespace
+#endif
+
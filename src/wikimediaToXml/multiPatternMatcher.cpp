@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Matcher finding a set of string patterns in a text in one pass (Aho-Corasick automaton)
+/// \file multiPatternMatcher.cpp
+#include "multiPatternMatcher.hpp"
+#include <algorithm>
+#include <deque>
+#include <cstring>
+
+using namespace strus;
+
+MultiPatternMatcher::MultiPatternMatcher( const std::vector<std::string>& patterns)
+	:m_patterns(patterns),m_nofClasses(1),m_transitions(),m_firstMatch(),m_matches()
+{
+	std::memset( m_charClass, 0, sizeof(m_charClass));
+	std::vector<std::string>::const_iterator pi = m_patterns.begin(), pe = m_patterns.end();
+	for (; pi != pe; ++pi)
+	{
+		std::string::const_iterator ci = pi->begin(), ce = pi->end();
+		for (; ci != ce; ++ci)
+		{
+			unsigned char ch = *ci;
+			if (!m_charClass[ ch]) m_charClass[ ch] = m_nofClasses++;
+		}
+	}
+	// Build the trie of the patterns with -1 marking a missing transition:
+	m_transitions.resize( m_nofClasses, -1);
+	m_matches.push_back( std::vector<int>());
+	pi = m_patterns.begin();
+	for (int pidx=0; pi != pe; ++pi,++pidx)
+	{
+		int state = 0;
+		std::string::const_iterator ci = pi->begin(), ce = pi->end();
+		for (; ci != ce; ++ci)
+		{
+			int& next = m_transitions[ state * m_nofClasses + m_charClass[ (unsigned char)*ci]];
+			if (next < 0)
+			{
+				next = m_matches.size();
+				m_matches.push_back( std::vector<int>());
+				m_transitions.resize( m_transitions.size() + m_nofClasses, -1);
+			}
+			state = m_transitions[ state * m_nofClasses + m_charClass[ (unsigned char)*ci]];
+		}
+		m_matches[ state].push_back( pidx);
+	}
+	// Complete the transitions with the failure links in breadth first order, a state inherits the missing transitions and the matches of the state of its longest proper suffix:
+	std::vector<int> fail( m_matches.size(), 0);
+	std::deque<int> queue;
+	int ci = 0;
+	for (; ci < m_nofClasses; ++ci)
+	{
+		int& next = m_transitions[ ci];
+		if (next < 0)
+		{
+			next = 0;
+		}
+		else
+		{
+			fail[ next] = 0;
+			queue.push_back( next);
+		}
+	}
+	while (!queue.empty())
+	{
+		int state = queue.front();
+		queue.pop_front();
+		const std::vector<int>& inherited = m_matches[ fail[ state]];
+		m_matches[ state].insert( m_matches[ state].end(), inherited.begin(), inherited.end());
+		for (ci = 0; ci < m_nofClasses; ++ci)
+		{
+			int& next = m_transitions[ state * m_nofClasses + ci];
+			int failnext = m_transitions[ fail[ state] * m_nofClasses + ci];
+			if (next < 0)
+			{
+				next = failnext;
+			}
+			else
+			{
+				fail[ next] = failnext;
+				queue.push_back( next);
+			}
+		}
+	}
+	m_firstMatch.resize( m_matches.size(), -1);
+	std::vector<std::vector<int> >::iterator mi = m_matches.begin(), me = m_matches.end();
+	for (int midx=0; mi != me; ++mi,++midx)
+	{
+		std::sort( mi->begin(), mi->end());
+		mi->erase( std::unique( mi->begin(), mi->end()), mi->end());
+		if (!mi->empty()) m_firstMatch[ midx] = mi->front();
+	}
+}
+
+int MultiPatternMatcher::findFirst( const char* src, std::size_t size) const
+{
+	int rt = m_firstMatch[ 0];
+	if (rt == 0) return rt;
+	int state = 0;
+	const unsigned char* si = (const unsigned char*)src;
+	const unsigned char* se = si + size;
+	for (; si != se; ++si)
+	{
+		state = nextState( state, *si);
+		int match = m_firstMatch[ state];
+		if (match >= 0 && (rt < 0 || match < rt))
+		{
+			rt = match;
+			if (rt == 0) break;
+		}
+	}
+	return rt;
+}
+
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Matcher finding a set of string patterns in a text in one pass (Aho-Corasick automaton)
+/// \file multiPatternMatcher.hpp
+#ifndef _STRUS_WIKIPEDIA_MULTI_PATTERN_MATCHER_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_MULTI_PATTERN_MATCHER_HPP_INCLUDED
+#include <string>
+#include <vector>
+#include <cstddef>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Matcher finding a set of string patterns in a text in one pass
+/// \note The patterns are compiled into a deterministic automaton with a transition table over the classes of bytes occurring in the patterns. The cost of a match does not grow with the number of patterns.
+class MultiPatternMatcher
+{
+public:
+	/// \brief Constructor
+	/// \param[in] patterns list of patterns, the index of a pattern in the list is its priority (lower is higher)
+	explicit MultiPatternMatcher( const std::vector<std::string>& patterns);
+
+	/// \brief Find the pattern with the highest priority (lowest index) occurring in a text
+	/// \param[in] src pointer to the text
+	/// \param[in] size size of the text in bytes
+	/// \return the index of the pattern or -1 if none of the patterns occurs in the text
+	int findFirst( const char* src, std::size_t size) const;
+
+	/// \brief Get the pattern with index idx
+	const std::string& pattern( int idx) const		{return m_patterns[ idx];}
+	/// \brief Get the number of patterns
+	int size() const					{return (int)m_patterns.size();}
+
+private:
+	int nextState( int state, unsigned char ch) const
+	{
+		return m_transitions[ state * m_nofClasses + m_charClass[ ch]];
+	}
+
+private:
+	std::vector<std::string> m_patterns;
+	unsigned short m_charClass[ 256];		///< class of every byte, 0 for bytes not occurring in any pattern
+	int m_nofClasses;
+	std::vector<int> m_transitions;			///< next state for every state and class
+	std::vector<int> m_firstMatch;			///< pattern with the lowest index ending in a state or -1
+	std::vector<std::vector<int> > m_matches;	///< patterns ending in a state, including the ones ending in its suffix states
+};
+
+}//namespace
+#endif
+
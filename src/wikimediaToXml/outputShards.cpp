@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Container files (shards) collecting the output files of the conversion instead of writing one file per document
+/// \file outputShards.cpp
+#include "outputShards.hpp"
+#include "strus/base/string_format.hpp"
+#include "strus/base/fileio.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <cstdlib>
+#include <cerrno>
+
+#define _TXT(XX) XX
+
+using namespace strus;
+
+static std::FILE* openShardFile( const std::string& filename, char* buf, std::size_t bufsize)
+{
+	std::FILE* rt = std::fopen( filename.c_str(), "wb");
+	if (!rt)
+	{
+		int ec = errno;
+		throw std::runtime_error( strus::string_format( _TXT("failed to create shard file '%s': %s"), filename.c_str(), ::strerror(ec)));
+	}
+	std::setvbuf( rt, buf, _IOFBF, bufsize);
+	return rt;
+}
+
+OutputShardWriter::OutputShardWriter( const std::string& path_)
+	:m_path(path_),m_data(0),m_index(0),m_databuf(0),m_indexbuf(0),m_offset(0),m_failed(false),m_mutex()
+{
+	m_databuf = (char*)std::malloc( BufferSize);
+	m_indexbuf = (char*)std::malloc( BufferSize);
+	if (!m_databuf || !m_indexbuf)
+	{
+		std::free( m_databuf);
+		std::free( m_indexbuf);
+		throw std::bad_alloc();
+	}
+	try
+	{
+		m_data = openShardFile( m_path + ".dat", m_databuf, BufferSize);
+		m_index = openShardFile( m_path + ".idx", m_indexbuf, BufferSize);
+	}
+	catch (const std::runtime_error&)
+	{
+		if (m_data) std::fclose( m_data);
+		std::free( m_databuf);
+		std::free( m_indexbuf);
+		throw;
+	}
+}
+
+OutputShardWriter::~OutputShardWriter()
+{
+	if (m_data) std::fclose( m_data);
+	if (m_index) std::fclose( m_index);
+	std::free( m_databuf);
+	std::free( m_indexbuf);
+}
+
+void OutputShardWriter::write( const std::string& name, const std::string& content)
+{
+	strus::unique_lock lock( m_mutex);
+	if (!m_data) throw std::runtime_error( strus::string_format( _TXT("write to closed shard '%s'"), m_path.c_str()));
+	if (m_failed) throw std::runtime_error( strus::string_format( _TXT("write to shard '%s' after a failed write"), m_path.c_str()));
+	if (content.size() && std::fwrite( content.c_str(), 1, content.size(), m_data) != content.size())
+	{
+		int ec = errno;
+		//... the position of the data file is undefined after a short write of a buffered stream, the offsets of further files would be wrong
+		m_failed = true;
+		throw std::runtime_error( strus::string_format( _TXT("failed to write to shard '%s': %s"), m_path.c_str(), ::strerror(ec)));
+	}
+	if (0 > std::fprintf( m_index, "%llu\t%llu\t%s\n", (unsigned long long)m_offset, (unsigned long long)content.size(), name.c_str()))
+	{
+		int ec = errno;
+		//... the index may end with a partially written line, no further files can be added
+		m_failed = true;
+		throw std::runtime_error( strus::string_format( _TXT("failed to write to index of shard '%s': %s"), m_path.c_str(), ::strerror(ec)));
+	}
+	m_offset += content.size();
+}
+
+void OutputShardWriter::flush()
+{
+	strus::unique_lock lock( m_mutex);
+	if (m_data && (0 != std::fflush( m_data) || 0 != std::fflush( m_index)))
+	{
+		int ec = errno;
+		throw std::runtime_error( strus::string_format( _TXT("failed to flush shard '%s': %s"), m_path.c_str(), ::strerror(ec)));
+	}
+}
+
+void OutputShardWriter::close()
+{
+	strus::unique_lock lock( m_mutex);
+	if (!m_data) return;
+	int res_data = std::fclose( m_data);
+	int res_index = std::fclose( m_index);
+	m_data = 0;
+	m_index = 0;
+	if (res_data != 0 || res_index != 0)
+	{
+		int ec = errno;
+		throw std::runtime_error( strus::string_format( _TXT("failed to close shard '%s': %s"), m_path.c_str(), ::strerror(ec)));
+	}
+}
+
+OutputShardSet::OutputShardSet( const std::string& dir, int nofShards)
+	:m_ar()
+{
+	if (nofShards <= 0) throw std::runtime_error( _TXT("number of shards must be positive"));
+	try
+	{
+		int si = 0;
+		for (; si < nofShards; ++si)
+		{
+			m_ar.push_back( 0);
+			m_ar.back() = new OutputShardWriter( strus::joinFilePath( dir, strus::string_format( "shard%03d", si)));
+		}
+	}
+	catch (...)
+	{
+		std::vector<OutputShardWriter*>::iterator ai = m_ar.begin(), ae = m_ar.end();
+		for (; ai != ae; ++ai) delete *ai;
+		throw;
+	}
+}
+
+OutputShardSet::~OutputShardSet()
+{
+	std::vector<OutputShardWriter*>::iterator ai = m_ar.begin(), ae = m_ar.end();
+	for (; ai != ae; ++ai) delete *ai;
+}
+
+void OutputShardSet::close()
+{
+	std::vector<OutputShardWriter*>::iterator ai = m_ar.begin(), ae = m_ar.end();
+	for (; ai != ae; ++ai) (*ai)->close();
+}
+
+std::string OutputShardReader::shardPath( const std::string& path)
+{
+	if (path.size() > 4 && (0==std::strcmp( path.c_str() + path.size() - 4, ".dat") || 0==std::strcmp( path.c_str() + path.size() - 4, ".idx")))
+	{
+		return std::string( path, 0, path.size() - 4);
+	}
+	return path;
+}
+
+OutputShardReader::OutputShardReader( const std::string& path)
+	:m_path(shardPath(path)),m_data(m_path + ".dat", MemoryMappedFile::RandomAccess),m_entries(),m_namemap()
+{
+	std::string indexfilename( m_path + ".idx");
+	std::string index;
+	int ec = strus::readFile( indexfilename, index);
+	if (ec) throw std::runtime_error( strus::string_format( _TXT("failed to read index of shard '%s': %s"), indexfilename.c_str(), ::strerror(ec)));
+
+	char const* li = index.c_str();
+	int linecnt = 1;
+	for (; *li; ++linecnt)
+	{
+		const char* eoln = std::strchr( li, '\n');
+		if (!eoln) eoln = li + std::strlen( li);
+		char* next;
+		unsigned long long offset = std::strtoull( li, &next, 10);
+		if (*next != '\t') throw std::runtime_error( strus::string_format( _TXT("syntax error in index of shard '%s' on line %d"), indexfilename.c_str(), linecnt));
+		unsigned long long size = std::strtoull( next+1, &next, 10);
+		if (*next != '\t' || next >= eoln) throw std::runtime_error( strus::string_format( _TXT("syntax error in index of shard '%s' on line %d"), indexfilename.c_str(), linecnt));
+		if (offset + size > m_data.size()) throw std::runtime_error( strus::string_format( _TXT("index of shard '%s' refers to content out of range on line %d"), indexfilename.c_str(), linecnt));
+		std::string name( next+1, eoln - next - 1);
+
+		std::map<std::string,std::size_t>::const_iterator ni = m_namemap.find( name);
+		if (ni == m_namemap.end())
+		{
+			m_namemap[ name] = m_entries.size();
+			m_entries.push_back( Entry( name, offset, size));
+		}
+		else
+		{
+			m_entries[ ni->second].offset = offset;
+			m_entries[ ni->second].size = size;
+		}
+		li = *eoln ? eoln+1 : eoln;
+	}
+}
+
+const OutputShardReader::Entry* OutputShardReader::find( const std::string& name) const
+{
+	std::map<std::string,std::size_t>::const_iterator ni = m_namemap.find( name);
+	return (ni == m_namemap.end()) ? 0 : &m_entries[ ni->second];
+}
+
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Container files (shards) collecting the output files of the conversion instead of writing one file per document
+/// \file outputShards.hpp
+#ifndef _STRUS_WIKIPEDIA_OUTPUT_SHARDS_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_OUTPUT_SHARDS_HPP_INCLUDED
+#include "strus/base/thread.hpp"
+#include "memoryMappedFile.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdio>
+#include <stdint.h>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Writer of one shard, a data file <path>.dat with the contents of the files appended and an index file <path>.idx
+/// \note The index has a line "<offset>\t<size>\t<name>" per file written. A file written again replaces the file written before with the same name.
+/// \note The methods are thread safe.
+class OutputShardWriter
+{
+public:
+	/// \brief Constructor, creates the data and the index file of the shard
+	/// \param[in] path_ path of the shard without extension
+	explicit OutputShardWriter( const std::string& path_);
+	~OutputShardWriter();
+
+	/// \brief Append a file to the shard
+	/// \note After a failed write the shard rejects any further write
+	/// \param[in] name name of the file (relative path)
+	/// \param[in] content content of the file
+	void write( const std::string& name, const std::string& content);
+	/// \brief Flush the buffers of the data and the index file, so that the shard can be read
+	void flush();
+	/// \brief Flush the buffers and close the data and the index file
+	void close();
+
+	/// \brief Path of the shard without extension
+	const std::string& path() const		{return m_path;}
+
+private:
+	OutputShardWriter( const OutputShardWriter&);	//... non copyable
+	void operator=( const OutputShardWriter&);	//... non copyable
+
+private:
+	enum {BufferSize = (1<<20)};
+	std::string m_path;
+	std::FILE* m_data;
+	std::FILE* m_index;
+	char* m_databuf;				///< buffer of the sequential writes of the data file
+	char* m_indexbuf;				///< buffer of the sequential writes of the index file
+	uint64_t m_offset;				///< size of the data file written
+	bool m_failed;					///< a write to the shard failed, the shard is not written anymore
+	strus::mutex m_mutex;
+};
+
+/// \brief Set of shards the output files are distributed on by the index of their document
+class OutputShardSet
+{
+public:
+	/// \brief Constructor, creates the shards <dir>/shard000 to <dir>/shard<nofShards-1>
+	/// \param[in] dir directory of the shards
+	/// \param[in] nofShards number of shards
+	OutputShardSet( const std::string& dir, int nofShards);
+	~OutputShardSet();
+
+	/// \brief Append a file of a document to its shard
+	/// \param[in] docindex index of the document, all files of a document are written to the same shard
+	/// \param[in] name name of the file (relative path)
+	/// \param[in] content content of the file
+	void write( int docindex, const std::string& name, const std::string& content)
+	{
+		m_ar[ docindex % m_ar.size()]->write( name, content);
+	}
+
+	/// \brief Number of shards
+	std::size_t size() const			{return m_ar.size();}
+	/// \brief Get a shard by index
+	OutputShardWriter& operator[]( std::size_t idx)	{return *m_ar[ idx];}
+
+	/// \brief Close all shards
+	void close();
+
+private:
+	OutputShardSet( const OutputShardSet&);		//... non copyable
+	void operator=( const OutputShardSet&);		//... non copyable
+
+private:
+	std::vector<OutputShardWriter*> m_ar;
+};
+
+/// \brief Reader of a shard written by an OutputShardWriter
+/// \note The data file is mapped into memory, the files of the shard are referenced in place
+class OutputShardReader
+{
+public:
+	/// \brief File in a shard
+	struct Entry
+	{
+		std::string name;
+		uint64_t offset;
+		uint64_t size;
+
+		Entry( const std::string& name_, uint64_t offset_, uint64_t size_)
+			:name(name_),offset(offset_),size(size_){}
+		Entry( const Entry& o)
+			:name(o.name),offset(o.offset),size(o.size){}
+	};
+
+	/// \brief Constructor, maps the data file and loads the index of a shard
+	/// \param[in] path path of the shard with or without the extension .dat or .idx
+	explicit OutputShardReader( const std::string& path);
+
+	/// \brief Files of the shard in the order they were written first, files replaced are reported with their last content
+	const std::vector<Entry>& entries() const	{return m_entries;}
+	/// \brief Find a file in the shard by name
+	/// \return the entry of the file or NULL if not found
+	const Entry* find( const std::string& name) const;
+	/// \brief Get a pointer to the content of a file in the shard
+	const char* content( const Entry& entry) const	{return m_data.ptr() + entry.offset;}
+
+	/// \brief Get the path of a shard without extension
+	static std::string shardPath( const std::string& path);
+
+private:
+	OutputShardReader( const OutputShardReader&);	//... non copyable
+	void operator=( const OutputShardReader&);	//... non copyable
+
+private:
+	std::string m_path;
+	MemoryMappedFile m_data;
+	std::vector<Entry> m_entries;
+	std::map<std::string,std::size_t> m_namemap;	///< map of names to the index of their entry
+};
+
+}//namespace
+#endif
+
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Outputs the XML of a converted document is written to in chunks
+/// \file outputSink.cpp
+#include "outputSink.hpp"
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace strus;
+
+FileOutputSink::FileOutputSink( const std::string& filename_)
+	:m_filename(filename_),m_fd(-1),m_errno(0)
+{
+	m_fd = ::open( m_filename.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0644);
+	if (m_fd < 0) m_errno = errno;
+}
+
+FileOutputSink::~FileOutputSink()
+{
+	if (m_fd >= 0) ::close( m_fd);
+}
+
+void FileOutputSink::write( const char* ptr, std::size_t size)
+{
+	if (m_errno) return;
+	while (size > 0)
+	{
+		ssize_t nn = ::write( m_fd, ptr, size);
+		if (nn < 0)
+		{
+			if (errno == EINTR) continue;
+			m_errno = errno;
+			return;
+		}
+		ptr += nn;
+		size -= nn;
+	}
+}
+
+int FileOutputSink::close()
+{
+	if (m_fd >= 0)
+	{
+		if (0 != ::close( m_fd) && !m_errno) m_errno = errno;
+		m_fd = -1;
+	}
+	return m_errno;
+}
+
+void FileOutputSink::discard()
+{
+	close();
+	(void)::unlink( m_filename.c_str());
+}
+
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Outputs the XML of a converted document is written to in chunks
+/// \file outputSink.hpp
+#ifndef _STRUS_WIKIPEDIA_OUTPUT_SINK_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_OUTPUT_SINK_HPP_INCLUDED
+#include <string>
+#include <cstddef>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Interface of an output written to in chunks
+class OutputSinkInterface
+{
+public:
+	virtual ~OutputSinkInterface(){}
+
+	/// \brief Write the next chunk of the output
+	/// \param[in] ptr pointer to the chunk
+	/// \param[in] size size of the chunk in bytes
+	virtual void write( const char* ptr, std::size_t size)=0;
+};
+
+/// \brief Output sink appending the chunks to a string
+class StringOutputSink
+	:public OutputSinkInterface
+{
+public:
+	explicit StringOutputSink( std::string& output_)
+		:m_output(output_){}
+	virtual ~StringOutputSink(){}
+
+	virtual void write( const char* ptr, std::size_t size)
+	{
+		m_output.append( ptr, size);
+	}
+
+private:
+	std::string& m_output;
+};
+
+/// \brief Output sink writing the chunks to a file
+/// \note Errors are not thrown, the first error is kept and returned by close()
+class FileOutputSink
+	:public OutputSinkInterface
+{
+public:
+	/// \brief Constructor, creates or truncates the file
+	explicit FileOutputSink( const std::string& filename_);
+	virtual ~FileOutputSink();
+
+	virtual void write( const char* ptr, std::size_t size);
+
+	/// \brief Close the file
+	/// \return the first error (errno) occurred or 0 on success
+	int close();
+	/// \brief Close and remove the file, for example if the output could not be completed
+	void discard();
+
+	const std::string& filename() const		{return m_filename;}
+
+private:
+	FileOutputSink( const FileOutputSink&);		//... non copyable
+	void operator=( const FileOutputSink&);		//... non copyable
+
+private:
+	std::string m_filename;
+	int m_fd;
+	int m_errno;
+};
+
+}//namespace
+#endif
+
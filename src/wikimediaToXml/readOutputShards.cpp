@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Program listing, printing or extracting the files of the shards written by strusWikimediaToXml with option --shards
+/// \file readOutputShards.cpp
+#include "outputShards.hpp"
+#include "strus/base/fileio.hpp"
+#include "strus/base/string_format.hpp"
+#include <iostream>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <vector>
+#include <set>
+#include <stdexcept>
+
+static bool hasExtension( const std::string& name, const std::vector<std::string>& extensions)
+{
+	if (extensions.empty()) return true;
+	std::vector<std::string>::const_iterator ei = extensions.begin(), ee = extensions.end();
+	for (; ei != ee; ++ei)
+	{
+		if (name.size() >= ei->size() && 0==std::strcmp( name.c_str() + name.size() - ei->size(), ei->c_str())) return true;
+	}
+	return false;
+}
+
+static void extractFile( const std::string& outputdir, const std::string& name, const char* content, std::size_t size, std::set<std::string>& dirs)
+{
+	char const* si = name.c_str();
+	char const* sn = std::strchr( si, '/');
+	for (; sn; sn = std::strchr( sn+1, '/'))
+	{
+		std::string dir( strus::joinFilePath( outputdir, std::string( si, sn - si)));
+		if (dirs.insert( dir).second)
+		{
+			int ec = strus::createDir( dir, false/*fail_ifexist, an existing directory is used*/);
+			if (ec) throw std::runtime_error( strus::string_format( "error creating directory %s: %s", dir.c_str(), std::strerror(ec)));
+		}
+	}
+	std::string filename( strus::joinFilePath( outputdir, name));
+	int ec = strus::writeFile( filename, std::string( content, size));
+	if (ec) throw std::runtime_error( strus::string_format( "error writing file %s: %s", filename.c_str(), std::strerror(ec)));
+}
+
+/// \brief Compare the output printed with the content of an expected file, as strusWikimediaToXml with option --test does
+static void testOutput( const std::string& output, const std::string& expectedFilename)
+{
+	std::string expected;
+	int ec = strus::readFile( expectedFilename, expected);
+	if (ec) throw std::runtime_error( strus::string_format( "failed to read expected file '%s' for testing (option --test <expected file>): %s", expectedFilename.c_str(), std::strerror(ec)));
+	char const* ei = expected.c_str();
+	char const* oi = output.c_str();
+	int line = 1;
+	while (*ei && *oi)
+	{
+		if ((*ei == '\r' || *ei == '\n') && (*oi == '\r' || *oi == '\n'))
+		{
+			if (*ei == '\r') ++ei;
+			if (*ei == '\n') ++ei;
+			if (*oi == '\r') ++oi;
+			if (*oi == '\n') ++oi;
+			++line;
+		}
+		else if (*ei != *oi)
+		{
+			break;
+		}
+		else
+		{
+			++ei;
+			++oi;
+		}
+	}
+	if (*ei || *oi)
+	{
+		throw std::runtime_error( strus::string_format( "test outputs differ at line %d", line));
+	}
+}
+
+int main( int argc, const char* argv[])
+{
+	try
+	{
+		int argi = 1;
+		bool printusage = false;
+		bool listFiles = false;
+		std::string outputdir;
+		std::string testExpectedFilename;
+		std::vector<std::string> selectNames;
+		std::vector<std::string> extensions;
+
+		for (;argi < argc; ++argi)
+		{
+			if (0==std::strcmp(argv[argi],"-h"))
+			{
+				printusage = true;
+			}
+			else if (0==std::strcmp(argv[argi],"-l"))
+			{
+				listFiles = true;
+			}
+			else if (0==std::strcmp(argv[argi],"-e") || 0==std::strcmp(argv[argi],"-g") || 0==std::strcmp(argv[argi],"-x"))
+			{
+				if (argi+1 == argc) throw std::runtime_error( std::string("no argument given for option ") + argv[argi]);
+				if (argv[argi][1] == 'e') extensions.push_back( argv[argi+1]);
+				else if (argv[argi][1] == 'g') selectNames.push_back( argv[argi+1]);
+				else if (!outputdir.empty()) throw std::runtime_error( "duplicated option -x <outputdir>");
+				else outputdir = argv[argi+1];
+				++argi;
+			}
+			else if (0==std::strcmp(argv[argi],"--test"))
+			{
+				if (argi+1 == argc) throw std::runtime_error( std::string("no argument given for option ") + argv[argi]);
+				if (!testExpectedFilename.empty()) throw std::runtime_error( "duplicated option --test <expected file>");
+				testExpectedFilename = argv[argi+1];
+				++argi;
+			}
+			else if (argv[argi][0] == '-' && argv[argi][1] == '-')
+			{
+				++argi;
+				break;
+			}
+			else if (argv[argi][0] == '-' && argv[argi][1])
+			{
+				std::cerr << "unknown option '" << argv[argi] << "'" << std::endl;
+				printusage = true;
+			}
+			else
+			{
+				break;
+			}
+		}
+		if (argi == argc)
+		{
+			std::cerr << "too few arguments" << std::endl;
+			printusage = true;
+		}
+		if (printusage)
+		{
+			std::cerr << "Usage: readOutputShards [options] <shard> [<shard> ...]" << std::endl;
+			std::cerr << "<shard>       :Shard written by strusWikimediaToXml with option --shards" << std::endl;
+			std::cerr << "               (path of the .dat or .idx file or without extension)" << std::endl;
+			std::cerr << "options:" << std::endl;
+			std::cerr << "    -h           :Print this usage" << std::endl;
+			std::cerr << "    -l           :List the names and sizes of the files in the shards" << std::endl;
+			std::cerr << "    -g <name>    :Select the file <name> (e.g. 0000/Gliese_1214.xml)" << std::endl;
+			std::cerr << "    -e <ext>     :Select the files with extension <ext> (e.g. .xml)" << std::endl;
+			std::cerr << "    -x <dir>     :Extract the files selected into the directory <dir>" << std::endl;
+			std::cerr << "                  as written by strusWikimediaToXml without option --shards" << std::endl;
+			std::cerr << "    --test <EXP> :Compare the files selected printed with the content" << std::endl;
+			std::cerr << "                  of the file <EXP> instead of printing them" << std::endl;
+			std::cerr << "Description:" << std::endl;
+			std::cerr << "  Without option -l or -x the files selected are printed to stdout in the\n";
+			std::cerr << "    format of strusWikimediaToXml with option --stdout." << std::endl;
+			return argi == argc ? -1 : 0;
+		}
+		if (!testExpectedFilename.empty() && (listFiles || !outputdir.empty())) throw std::runtime_error( "option --test cannot be used with option -l or -x");
+		std::set<std::string> dirs;
+		std::string testOutputString;
+		for (; argi < argc; ++argi)
+		{
+			strus::OutputShardReader reader( argv[ argi]);
+			std::vector<strus::OutputShardReader::Entry> selected;
+			if (selectNames.empty())
+			{
+				std::vector<strus::OutputShardReader::Entry>::const_iterator ei = reader.entries().begin(), ee = reader.entries().end();
+				for (; ei != ee; ++ei)
+				{
+					if (hasExtension( ei->name, extensions)) selected.push_back( *ei);
+				}
+			}
+			else
+			{
+				std::vector<std::string>::const_iterator ni = selectNames.begin(), ne = selectNames.end();
+				for (; ni != ne; ++ni)
+				{
+					const strus::OutputShardReader::Entry* entry = reader.find( *ni);
+					if (entry && hasExtension( entry->name, extensions)) selected.push_back( *entry);
+				}
+			}
+			std::vector<strus::OutputShardReader::Entry>::const_iterator si = selected.begin(), se = selected.end();
+			for (; si != se; ++si)
+			{
+				if (listFiles)
+				{
+					std::cout << si->name << "\t" << si->size << std::endl;
+				}
+				else if (!outputdir.empty())
+				{
+					extractFile( outputdir, si->name, reader.content( *si), si->size, dirs);
+				}
+				else if (!testExpectedFilename.empty())
+				{
+					testOutputString.append( "## ");
+					testOutputString.append( si->name);
+					testOutputString.append( "\n");
+					testOutputString.append( reader.content( *si), si->size);
+					testOutputString.append( "\n\n");
+				}
+				else
+				{
+					std::cout << "## " << si->name << std::endl;
+					std::cout << std::string( reader.content( *si), si->size) << std::endl << std::endl;
+				}
+			}
+		}
+		if (!testExpectedFilename.empty())
+		{
+			testOutput( testOutputString, testExpectedFilename);
+		}
+		return 0;
+	}
+	catch (const std::runtime_error& e)
+	{
+		std::cerr << "ERROR " << e.what() << std::endl;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "EXCEPTION " << e.what() << std::endl;
+	}
+	return -1;
+}
+
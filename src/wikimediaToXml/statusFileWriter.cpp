@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Thread rewriting a status file with the progress and the throughput of a running conversion periodically (option --status)
+/// \file statusFileWriter.cpp
+#include "statusFileWriter.hpp"
+#include "strus/base/fileio.hpp"
+#include "strus/base/string_format.hpp"
+#include <iostream>
+#include <stdexcept>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <time.h>
+#include <unistd.h>
+
+using namespace strus;
+
+static double getTimeSeconds()
+{
+	struct timespec ts;
+	::clock_gettime( CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/// \brief Get the resident set size of the process in bytes (from /proc/self/statm) or 0 if not available
+static uint64_t getResidentSetSize()
+{
+	std::FILE* fh = std::fopen( "/proc/self/statm", "r");
+	if (!fh) return 0;
+	unsigned long size = 0, resident = 0;
+	int nn = std::fscanf( fh, "%lu %lu", &size, &resident);
+	std::fclose( fh);
+	if (nn != 2) return 0;
+	long pagesize = ::sysconf( _SC_PAGESIZE);
+	return pagesize > 0 ? (uint64_t)resident * pagesize : 0;
+}
+
+StatusFileWriter::StatusFileWriter( const std::string& filename_, int interval_, const ConversionStatusSourceInterface* source_)
+	:m_filename(filename_),m_interval(interval_ > 0 ? interval_ : 1),m_source(source_)
+	,m_startTime(getTimeSeconds()),m_lastTime(m_startTime),m_lastScannedBytes(0),m_lastDocuments(0),m_lastError(0)
+	,m_terminate(false),m_thread(0){}
+
+StatusFileWriter::~StatusFileWriter()
+{
+	terminate( "aborted");
+}
+
+void StatusFileWriter::start()
+{
+	if (m_thread) throw std::runtime_error("start called twice");
+	update( "running");
+	m_thread = new strus::thread( &StatusFileWriter::run, this);
+}
+
+void StatusFileWriter::stop()
+{
+	terminate( "finished");
+}
+
+void StatusFileWriter::terminate( const char* state)
+{
+	if (m_thread)
+	{
+		m_terminate.set( true);
+		m_thread->join();
+		delete m_thread;
+		m_thread = 0;
+		update( state);
+	}
+}
+
+void StatusFileWriter::run()
+{
+	while (!m_terminate.test())
+	{
+		//... sleep in short steps to react on termination in time
+		struct timespec ts;
+		ts.tv_sec = 0;
+		ts.tv_nsec = 100 * 1000 * 1000;
+		::nanosleep( &ts, NULL);
+		if (!m_terminate.test() && getTimeSeconds() - m_lastTime >= m_interval)
+		{
+			update( "running");
+		}
+	}
+}
+
+void StatusFileWriter::update( const char* state)
+{
+	ConversionStatus status;
+	m_source->getStatus( status);
+	double now = getTimeSeconds();
+	double elapsed = now - m_startTime;
+	double sinceLast = now - m_lastTime;
+
+	int nofQueued = 0;
+	std::string queueDepths;
+	std::vector<int>::const_iterator qi = status.queueDepths.begin(), qe = status.queueDepths.end();
+	for (; qi != qe; ++qi)
+	{
+		if (!queueDepths.empty()) queueDepths.append( ", ");
+		queueDepths.append( strus::string_format( "%d", *qi));
+		nofQueued += *qi;
+	}
+	std::string progress( "null");
+	std::string eta( "null");
+	if (status.inputSize && status.inputPosition)
+	{
+		double ratio = (double)status.inputPosition / (double)status.inputSize;
+		progress = strus::string_format( "%.4f", ratio > 1.0 ? 1.0 : ratio);
+		//... estimated with the average rate since the start
+		double remaining = status.inputPosition < status.inputSize ? (double)(status.inputSize - status.inputPosition) : 0.0;
+		eta = strus::string_format( "%.0f", elapsed * remaining / (double)status.inputPosition);
+	}
+	const double MB = 1024.0 * 1024.0;
+	std::string content( strus::string_format(
+		"{\n"
+		"\t\"state\": \"%s\",\n"
+		"\t\"timestamp\": %lld,\n"
+		"\t\"elapsed_seconds\": %.1f,\n"
+		"\t\"scanned_bytes\": %llu,\n"
+		"\t\"input_position\": %llu,\n"
+		"\t\"input_size\": %llu,\n"
+		"\t\"progress\": %s,\n"
+		"\t\"eta_seconds\": %s,\n"
+		"\t\"pages\": %d,\n"
+		"\t\"documents\": %d,\n"
+		"\t\"documents_per_second\": %.1f,\n"
+		"\t\"documents_per_second_avg\": %.1f,\n"
+		"\t\"megabytes_per_second\": %.2f,\n"
+		"\t\"megabytes_per_second_avg\": %.2f,\n"
+		"\t\"inflight_documents\": %d,\n"
+		"\t\"queued_documents\": %d,\n"
+		"\t\"queue_depths\": [%s],\n"
+		"\t\"rss_bytes\": %llu\n"
+		"}\n",
+		state, (long long)::time( NULL), elapsed,
+		(unsigned long long)status.scannedBytes, (unsigned long long)status.inputPosition, (unsigned long long)status.inputSize,
+		progress.c_str(), eta.c_str(), status.nofPages, status.nofDocuments,
+		sinceLast > 0.0 ? (double)(status.nofDocuments - m_lastDocuments) / sinceLast : 0.0,
+		elapsed > 0.0 ? (double)status.nofDocuments / elapsed : 0.0,
+		sinceLast > 0.0 ? (double)(status.scannedBytes - m_lastScannedBytes) / MB / sinceLast : 0.0,
+		elapsed > 0.0 ? (double)status.scannedBytes / MB / elapsed : 0.0,
+		status.nofInflight, nofQueued, queueDepths.c_str(), (unsigned long long)getResidentSetSize()));
+
+	std::string tmpfilename( m_filename + ".tmp");
+	int ec = strus::writeFile( tmpfilename, content);
+	if (!ec && 0 != std::rename( tmpfilename.c_str(), m_filename.c_str())) ec = errno;
+	if (ec && ec != m_lastError)
+	{
+		std::cerr << "error writing status file " << m_filename << ": " << std::strerror(ec) << std::endl;
+	}
+	m_lastError = ec;
+	m_lastTime = now;
+	m_lastScannedBytes = status.scannedBytes;
+	m_lastDocuments = status.nofDocuments;
+}
+
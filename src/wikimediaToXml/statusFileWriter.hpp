@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Thread rewriting a status file with the progress and the throughput of a running conversion periodically (option --status)
+/// \file statusFileWriter.hpp
+#ifndef _STRUS_WIKIPEDIA_STATUS_FILE_WRITER_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_STATUS_FILE_WRITER_HPP_INCLUDED
+#include "strus/base/thread.hpp"
+#include "strus/base/atomic.hpp"
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief State of a running conversion
+struct ConversionStatus
+{
+	uint64_t scannedBytes;		///< bytes of the XML dump scanned
+	uint64_t inputPosition;		///< bytes of the input file consumed (bytes of the compressed file for compressed input)
+	uint64_t inputSize;		///< size of the input file or 0 if not known (input from stdin)
+	int nofPages;			///< number of pages scanned
+	int nofDocuments;		///< number of documents converted
+	int nofInflight;		///< number of documents in conversion
+	std::vector<int> queueDepths;	///< number of documents queued for every conversion thread
+
+	ConversionStatus()
+		:scannedBytes(0),inputPosition(0),inputSize(0),nofPages(0),nofDocuments(0),nofInflight(0),queueDepths(){}
+};
+
+/// \brief Interface for getting the state of a running conversion
+class ConversionStatusSourceInterface
+{
+public:
+	virtual ~ConversionStatusSourceInterface(){}
+
+	/// \brief Get the current state of the conversion
+	/// \note Called by the thread of the status file writer while the conversion is running
+	virtual void getStatus( ConversionStatus& status) const=0;
+};
+
+/// \brief Thread rewriting a status file as JSON periodically with the progress, the throughput, the estimated time to completion, the queues of the conversion threads and the memory (RSS) of the process
+/// \note The file is written to a temporary file renamed to the status file, so that a reader never sees a partially written status
+/// \note The rates are reported for the time since the previous update and as average since the start, a stalled conversion shows up as a rate of 0 since the previous update
+class StatusFileWriter
+{
+public:
+	/// \brief Constructor
+	/// \param[in] filename_ path of the status file
+	/// \param[in] interval_ number of seconds between two updates of the status file
+	/// \param[in] source_ source of the state of the conversion
+	StatusFileWriter( const std::string& filename_, int interval_, const ConversionStatusSourceInterface* source_);
+	/// \brief Destructor, stops the thread and marks the status as aborted if it has not been stopped before
+	~StatusFileWriter();
+
+	/// \brief Write the status file and start the thread updating it
+	void start();
+	/// \brief Stop the thread and write the status file a last time marked as finished
+	void stop();
+
+	const std::string& filename() const		{return m_filename;}
+
+private:
+	void run();
+	void terminate( const char* state);
+	void update( const char* state);
+
+private:
+	StatusFileWriter( const StatusFileWriter&);	//... non copyable
+	void operator=( const StatusFileWriter&);	//... non copyable
+
+private:
+	std::string m_filename;
+	int m_interval;
+	const ConversionStatusSourceInterface* m_source;
+	double m_startTime;
+	double m_lastTime;			///< time of the previous update
+	uint64_t m_lastScannedBytes;		///< bytes scanned at the previous update
+	int m_lastDocuments;			///< documents converted at the previous update
+	int m_lastError;			///< error of the previous update, reported only if it changes
+	strus::AtomicFlag m_terminate;
+	strus::thread* m_thread;
+};
+
+}//namespace
+#endif
+
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Arena for strings referenced during the conversion of a document, reset and reused for the next document or token
+/// \file stringArena.hpp
+#ifndef _STRUS_WIKIPEDIA_STRING_ARENA_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_STRING_ARENA_HPP_INCLUDED
+#include "stringRef.hpp"
+#include <vector>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include <new>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Bump allocator for strings referenced with StringRef, all strings are released together with reset()
+/// \note The blocks allocated are kept for reuse after reset(), only strings bigger than a block are freed
+/// \note The last string bigger than a quarter of a block gets a capacity growing geometrically when appended to, so that a string built by many appends costs amortized linear time
+class StringArena
+{
+public:
+	enum {BlockSize = (1<<16)};
+
+	StringArena()
+		:m_blocks(),m_large(),m_blockidx(0),m_ptr(0),m_end(0),m_lastLarge(0),m_lastLargeSize(0),m_lastLargeCapacity(0){}
+	~StringArena()
+	{
+		std::vector<char*>::iterator bi = m_blocks.begin(), be = m_blocks.end();
+		for (; bi != be; ++bi) std::free( *bi);
+		freeLarge();
+	}
+
+	/// \brief Allocate uninitialized memory for a string
+	char* alloc( std::size_t size)
+	{
+		if (size > (std::size_t)(m_end - m_ptr))
+		{
+			if (size > (std::size_t)BlockSize / 4)
+			{
+				return allocLarge( size, size);
+			}
+			nextBlock();
+		}
+		char* rt = m_ptr;
+		m_ptr += size;
+		return rt;
+	}
+
+	/// \brief Try to grow the string allocated last in place
+	/// \return true on success, false if the string was not the last one allocated or the block has not enough space left
+	bool extend( const char* ptr, std::size_t size, std::size_t addsize)
+	{
+		if (ptr && ptr == m_lastLarge && size == m_lastLargeSize)
+		{
+			if (addsize > m_lastLargeCapacity - m_lastLargeSize) return false;
+			m_lastLargeSize += addsize;
+			return true;
+		}
+		if (ptr + size != m_ptr || addsize > (std::size_t)(m_end - m_ptr)) return false;
+		m_ptr += addsize;
+		return true;
+	}
+
+	/// \brief Copy a string into the arena
+	StringRef copy( const char* ptr, std::size_t size)
+	{
+		if (!size) return StringRef();
+		char* buf = alloc( size);
+		std::memcpy( buf, ptr, size);
+		return StringRef( buf, size);
+	}
+
+	/// \brief Get the concatenation of a string with another one, grown in place if it was the last string allocated in the arena
+	StringRef append( const StringRef& str, const char* ptr, std::size_t size)
+	{
+		if (!size) return str;
+		if (!str.empty() && extend( str.ptr(), str.size(), size))
+		{
+			std::memcpy( const_cast<char*>( str.ptr()) + str.size(), ptr, size);
+			return StringRef( str.ptr(), str.size() + size);
+		}
+		std::size_t newsize = str.size() + size;
+		char* buf;
+		if (newsize > (std::size_t)BlockSize / 4)
+		{
+			//... the old string stays valid until reset, so the sizes of the copies sum up to at most twice the final size
+			buf = allocLarge( newsize, std::max( newsize, 2 * str.size()));
+		}
+		else
+		{
+			buf = alloc( newsize);
+		}
+		std::memcpy( buf, str.ptr(), str.size());
+		std::memcpy( buf + str.size(), ptr, size);
+		return StringRef( buf, newsize);
+	}
+
+	/// \brief Release all strings allocated
+	void reset()
+	{
+		freeLarge();
+		m_blockidx = 0;
+		if (m_blocks.empty())
+		{
+			m_ptr = m_end = 0;
+		}
+		else
+		{
+			m_ptr = m_blocks[0];
+			m_end = m_ptr + BlockSize;
+		}
+	}
+
+private:
+	char* allocLarge( std::size_t size, std::size_t capacity)
+	{
+		char* rt = (char*)std::malloc( capacity);
+		if (!rt) throw std::bad_alloc();
+		m_large.push_back( rt);
+		m_lastLarge = rt;
+		m_lastLargeSize = size;
+		m_lastLargeCapacity = capacity;
+		return rt;
+	}
+	void nextBlock()
+	{
+		if (m_ptr) ++m_blockidx;
+		if (m_blockidx == m_blocks.size())
+		{
+			char* blk = (char*)std::malloc( BlockSize);
+			if (!blk) throw std::bad_alloc();
+			m_blocks.push_back( blk);
+		}
+		m_ptr = m_blocks[ m_blockidx];
+		m_end = m_ptr + BlockSize;
+	}
+	void freeLarge()
+	{
+		std::vector<char*>::iterator li = m_large.begin(), le = m_large.end();
+		for (; li != le; ++li) std::free( *li);
+		m_large.clear();
+		m_lastLarge = 0;
+		m_lastLargeSize = 0;
+		m_lastLargeCapacity = 0;
+	}
+
+private:
+	StringArena( const StringArena&){}	//... non copyable
+	void operator=( const StringArena&){}	//... non copyable
+
+private:
+	std::vector<char*> m_blocks;		///< blocks kept for reuse
+	std::vector<char*> m_large;		///< strings bigger than a quarter of a block, freed on reset
+	std::size_t m_blockidx;			///< index of the current block
+	char* m_ptr;				///< next free byte in the current block
+	char* m_end;				///< end of the current block
+	char* m_lastLarge;			///< string bigger than a quarter of a block allocated last
+	std::size_t m_lastLargeSize;		///< size of the string allocated last bigger than a quarter of a block
+	std::size_t m_lastLargeCapacity;	///< capacity of the string allocated last bigger than a quarter of a block
+};
+
+}//namespace
+#endif
+
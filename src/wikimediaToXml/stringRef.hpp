@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Reference to a string not owned, for passing strings of the source or of a string arena without copying them
+/// \file stringRef.hpp
+#ifndef _STRUS_WIKIPEDIA_STRING_REF_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_STRING_REF_HPP_INCLUDED
+#include <string>
+#include <cstring>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Immutable reference to a string not owned, not 0-terminated
+/// \note The referenced string must live as long as the reference is used. Constructed implicitly from a std::string or a C string only for passing it as argument.
+class StringRef
+{
+public:
+	StringRef()
+		:m_ptr(""),m_size(0){}
+	StringRef( const char* ptr_, std::size_t size_)
+		:m_ptr(ptr_),m_size(size_){}
+	StringRef( const char* str)
+		:m_ptr(str),m_size(std::strlen(str)){}
+	StringRef( const std::string& str)
+		:m_ptr(str.c_str()),m_size(str.size()){}
+	StringRef( const StringRef& o)
+		:m_ptr(o.m_ptr),m_size(o.m_size){}
+
+	const char* ptr() const				{return m_ptr;}
+	std::size_t size() const			{return m_size;}
+	bool empty() const				{return m_size == 0;}
+	std::string tostring() const			{return std::string( m_ptr, m_size);}
+	char operator[]( std::size_t idx) const		{return m_ptr[ idx];}
+	/// \brief Implicit conversion for passing the string to functions expecting a std::string (allocates a copy)
+	operator std::string() const			{return std::string( m_ptr, m_size);}
+
+	bool operator==( const char* str) const
+	{
+		return std::strlen( str) == m_size && 0==std::memcmp( m_ptr, str, m_size);
+	}
+	bool operator!=( const char* str) const
+	{
+		return !operator==( str);
+	}
+	bool operator==( const std::string& str) const
+	{
+		return str.size() == m_size && 0==std::memcmp( m_ptr, str.c_str(), m_size);
+	}
+	bool operator!=( const std::string& str) const
+	{
+		return !operator==( str);
+	}
+	bool operator==( const StringRef& o) const
+	{
+		return o.m_size == m_size && 0==std::memcmp( m_ptr, o.m_ptr, m_size);
+	}
+	bool operator!=( const StringRef& o) const
+	{
+		return !operator==( o);
+	}
+
+private:
+	const char* m_ptr;
+	std::size_t m_size;
+};
+
+}//namespace
+#endif
+
@@ -7,7 +7,9 @@
  */
 
 #include "textwolf/istreamiterator.hpp"
+#include "textwolf/sourceiterator.hpp"
 #include "textwolf/xmlscanner.hpp"
+#include "textwolf/xmlpathselect.hpp"
 #include "textwolf/charset.hpp"
 #include "strus/lib/error.hpp"
 #include "strus/base/local_ptr.hpp"
@@ -19,12 +21,22 @@
 #include "strus/base/atomic.hpp"
 #include "strus/base/local_ptr.hpp"
 #include "strus/base/string_conv.hpp"
-#include "strus/base/sleep.hpp"
 #include "strus/errorBufferInterface.hpp"
 #include "linkMap.hpp"
 #include "documentStructure.hpp"
+#include "documentParser.hpp"
 #include "outputString.hpp"
 #include "wikimediaLexer.hpp"
+#include "contentBuffer.hpp"
+#include "memoryMappedFile.hpp"
+#include "compressedInput.hpp"
+#include "linkPatch.hpp"
+#include "outputShards.hpp"
+#include "asyncFileWriter.hpp"
+#include "outputSink.hpp"
+#include "multiPatternMatcher.hpp"
+#include "conversionStatistics.hpp"
+#include "statusFileWriter.hpp"
 #include <iostream>
 #include <sstream>
 #include <cstring>
@@ -35,8 +47,9 @@
 #include <memory>
 #include <vector>
 #include <set>
-#include <queue>
+#include <deque>
 #include <limits>
+#include <time.h>
 
 static int g_verbosity = 0;
 static bool g_beautified = false;
@@ -44,432 +57,86 @@ static bool g_dumps = false;
 static bool g_singleIdAttribute = true;
 static bool g_dumpStdout = false;
 static bool g_doTest = false;
+static bool g_deferLinks = false;
 static std::string g_testExpectedFilename;
 static std::string g_testOutput;
 static std::string g_outputdir;
 static const strus::LinkMap* g_linkmap = NULL;
+static strus::OutputShardSet* g_outputShards = NULL;
+static strus::AsyncFileWriter* g_fileWriter = NULL;
+static const strus::MultiPatternMatcher* g_strangeFeatureMatcher = NULL;
+static strus::ConversionStatistics* g_statistics = NULL;
 static strus::ErrorBufferInterface* g_errorhnd = NULL;
+static strus::mutex g_convertedDocsMutex;
+static std::vector<std::pair<int,std::string> > g_convertedDocs;	///< documents converted with page links to patch (option --onepass)
 
-typedef textwolf::XMLScanner<textwolf::IStreamIterator,textwolf::charset::UTF8,textwolf::charset::UTF8,std::string> XmlScanner;
-
-static std::string attributesToString( const strus::WikimediaLexem::AttributeMap& attributes)
+/// \brief Diagnostics of the conversion collected as counters in production mode (option --production), instead of writing the side files of every document
+class DiagnosticsSummary
 {
-	std::ostringstream out;
-	strus::WikimediaLexem::AttributeMap::const_iterator ai = attributes.begin(), ae = attributes.end();
-	for (int aidx=0; ai != ae; ++ai,++aidx)
+public:
+	DiagnosticsSummary()
+		:m_nofDocuments(0),m_nofDocumentsWithErrors(0),m_nofErrors(0),m_nofDocumentsWithUnresolved(0),m_nofUnresolved(0),m_mutex(),m_failures(){}
+
+	/// \brief Count a document converted
+	void addDocument( const strus::DocumentStructure& doc)
 	{
-		if (aidx) out << ", ";
-		out << ai->first << "='" << ai->second << "'";
+		m_nofDocuments.increment();
+		if (!doc.errors().empty())
+		{
+			m_nofDocumentsWithErrors.increment();
+			m_nofErrors.increment( doc.errors().size());
+		}
+		if (doc.nofUnresolved()) addUnresolved( doc.nofUnresolved());
 	}
-	return out.str();
-}
-
-static std::string getLinkDomainPrefix( const std::string& lnk, int maxsize)
-{
-	char const* si = lnk.c_str();
-	while (maxsize > 0 && (*si|32) >= 'a' && (*si|32) <= 'z') {++si;--maxsize;}
-	if (*si == ':')
+	/// \brief Count the page links of a document not resolved
+	void addUnresolved( int nofLinks)
 	{
-		return strus::string_conv::tolower( lnk.c_str(), si - lnk.c_str());
+		m_nofDocumentsWithUnresolved.increment();
+		m_nofUnresolved.increment( nofLinks);
 	}
-	else
+	/// \brief Register a document whose conversion failed with an exception
+	void addFailure( const std::string& title, const std::string& msg)
 	{
-		return std::string();
+		strus::unique_lock lock( m_mutex);
+		m_failures.push_back( title + ": " + msg);
 	}
-}
-
-static void parseDocumentText( strus::DocumentStructure& doc, const char* src, std::size_t size)
-{
-	strus::WikimediaLexer lexer(src,size);
-	int lexemidx = 0;
-	int lastHeading = 1;
-	bool pendingTextBreak = false;
-	bool verboseOutput = (g_verbosity >= 2);
 
-	for (strus::WikimediaLexem lexem = lexer.next(); lexem.id != strus::WikimediaLexem::EoF; lexem = lexer.next(),++lexemidx)
+	std::string tostring()
 	{
-		if (verboseOutput)
-		{
-			std::cout << "STATE " << doc.statestring() << std::endl;
-			std::cout << lexemidx << " LEXEM " << strus::WikimediaLexem::idName( lexem.id) << " " << strus::outputLineString( lexem.value.c_str(), lexem.value.c_str() + lexem.value.size());
-			if (!lexem.attributes.empty()) std::cout << " -- " << attributesToString( lexem.attributes);
-			std::cout << std::endl;
-		}
-		switch (lexem.id)
-		{
-			case strus::WikimediaLexem::EoF:
-				break;
-			case strus::WikimediaLexem::Error:
-				doc.addError( std::string("syntax error in document: ") + strus::outputLineString( lexem.value.c_str()));
-				break;
-			case strus::WikimediaLexem::Text:
-				if (pendingTextBreak) doc.addTextBreak();
-				doc.addText( lexem.value);
-				break;
-			case strus::WikimediaLexem::String:
-				doc.closeOpenQuoteItems();
-				doc.addQuotationMarker();
-				doc.addText( lexem.value);
-				doc.addQuotationMarker();
-				break;
-			case strus::WikimediaLexem::Char:
-				doc.addChar( lexem.value);
-				break;
-			case strus::WikimediaLexem::Math:
-				doc.addMath( lexem.value);
-				break;
-			case strus::WikimediaLexem::BibRef:
-				doc.addBibRef( lexem.value);
-				break;
-			case strus::WikimediaLexem::NoWiki:
-				doc.addNoWiki( lexem.value);
-				break;
-			case strus::WikimediaLexem::NoData:
-				doc.addError( std::string("lexem can not be treated as data: ") + strus::outputLineString( lexem.value.c_str()));
-				break;
-			case strus::WikimediaLexem::Code:
-				doc.addCode( lexem.value);
-				break;
-			case strus::WikimediaLexem::Timestamp:
-				doc.addTimestamp( lexem.value);
-				break;
-			case strus::WikimediaLexem::Url:
-				doc.openWebLink( lexem.value);
-				doc.closeWebLink();
-				break;
-			case strus::WikimediaLexem::Redirect:
-				doc.addError( "unexpected redirect in document");
-				break;
-			case strus::WikimediaLexem::Markup:
-				doc.addMarkup( lexem.value);
-				break;
-			case strus::WikimediaLexem::OpenHeading:
-				doc.openHeading( lastHeading = (int)lexem.idx);
-				break;
-			case strus::WikimediaLexem::CloseHeading:
-				doc.closeHeading();
-				break;
-			case strus::WikimediaLexem::OpenRef:
-				doc.openRef();
-				break;
-			case strus::WikimediaLexem::CloseRef:
-				doc.closeRef();
-				break;
-			case strus::WikimediaLexem::HeadingItem:
-				doc.addHeadingItem();
-				break;
-			case strus::WikimediaLexem::ListItem:
-				doc.openListItem( (int)lexem.idx);
-				break;
-			case strus::WikimediaLexem::EndOfLine:
-				doc.closeOpenEolnItem();
-				doc.addBreak();
-				break;
-			case strus::WikimediaLexem::QuotationMarker:
-				doc.addQuotationMarker();
-				break;
-			case strus::WikimediaLexem::MultiQuoteMarker:
-				doc.addMultiQuoteMarker( (int)lexem.idx);
-				break;
-			case strus::WikimediaLexem::OpenSpan:
-				doc.openSpan();
-				break;
-			case strus::WikimediaLexem::CloseSpan:
-				doc.closeSpan();
-				break;
-			case strus::WikimediaLexem::OpenFormat:
-				doc.openFormat();
-				break;
-			case strus::WikimediaLexem::CloseFormat:
-				doc.closeFormat();
-				break;
-			case strus::WikimediaLexem::OpenBlockQuote:
-				doc.openBlockQuote();
-				break;
-			case strus::WikimediaLexem::CloseBlockQuote:
-				doc.closeBlockQuote();
-				break;
-			case strus::WikimediaLexem::OpenDiv:
-				doc.openDiv();
-				break;
-			case strus::WikimediaLexem::CloseDiv:
-				doc.closeDiv();
-				break;
-			case strus::WikimediaLexem::OpenPoem:
-				doc.openPoem();
-				break;
-			case strus::WikimediaLexem::ClosePoem:
-				doc.closePoem();
-				break;
-			case strus::WikimediaLexem::OpenCitation:
-				doc.openCitation( lexem.value);
-				break;
-			case strus::WikimediaLexem::CloseCitation:
-				doc.closeCitation();
-				break;
-			case strus::WikimediaLexem::OpenWWWLink:
-				doc.openWebLink( lexem.value);
-				break;
-			case strus::WikimediaLexem::CloseWWWLink:
-				doc.closeWebLink();
-				break;
-			case strus::WikimediaLexem::OpenPageLink:
-			{
-				std::pair<std::string,std::string> lnk = strus::LinkMap::getLinkParts( lexem.value);
-				std::string link = lnk.first;
-				std::string anchorid;
-				if (lnk.second.size() > 80)
-				{
-					doc.setLinkDescription( lnk.second);
-				}
-				else
-				{
-					anchorid = lnk.second;
-				}
-
-				std::string prefix = getLinkDomainPrefix( link, 12);
-				if (strus::caseInsensitiveEquals( prefix, "wikipedia"))
-				{
-					link = strus::string_conv::trim( link.c_str() + prefix.size()+1);
-				}
-				if (strus::caseInsensitiveEquals( prefix, "file")
-				||  strus::caseInsensitiveEquals( prefix, "image")
-				||  strus::caseInsensitiveEquals( prefix, "category"))
-				{
-					doc.openPageLink( link, anchorid);
-				}
-				else
-				{
-					if (g_linkmap)
-					{
-						const char* val = g_linkmap->get( link);
-						if (val)
-						{
-							doc.openPageLink( val, anchorid);
-							if (!doc.hasLinkText())
-							{
-								doc.setLinkText( link);
-							}
-						}
-						else
-						{
-							doc.addUnresolved( link);
-							doc.openPageLink( link, anchorid);
-						}
-					}
-					else
-					{
-						doc.openPageLink( link, anchorid);
-					}
-				}
-				break;
-			}
-			case strus::WikimediaLexem::ClosePageLink:
-				doc.closePageLink();
-				break;
-			case strus::WikimediaLexem::OpenTable:
-				doc.openTable();
-				break;
-			case strus::WikimediaLexem::CloseTable:
-				doc.closeOpenEolnItem();
-				doc.closeTable();
-				break;
-			case strus::WikimediaLexem::TableTitle:
-				doc.closeOpenEolnItem();
-				doc.implicitOpenTableIfUndefined();
-				doc.addTableTitle();
-				break;
-			case strus::WikimediaLexem::TableHeadDelim:
-			{
-				doc.closeOpenEolnItem();
-				doc.implicitOpenTableIfUndefined();
-				int colspan = lexem.colspan();
-				if (colspan <= 0)
-				{
-					doc.addError( "invalid colspan attribute value");
-					colspan = 0;
-				}
-				int rowspan = lexem.rowspan();
-				if (rowspan <= 0)
-				{
-					doc.addError( "invalid colspan attribute value");
-					rowspan = 0;
-				}
-				doc.addTableHead( rowspan, colspan);
-				break;
-			}
-			case strus::WikimediaLexem::TableRowDelim:
-				doc.closeOpenEolnItem();
-				doc.implicitOpenTableIfUndefined();
-				doc.addTableRow();
-				break;
-			case strus::WikimediaLexem::TableColDelim:
-			{
-				doc.closeOpenEolnItem();
-				strus::Paragraph::StructType tp = doc.currentStructType();
-				if (tp == strus::Paragraph::StructPageLink
-				||  tp == strus::Paragraph::StructWebLink)
-				{
-					doc.clearOpenText();
-					//... ignore last text and restart structure
-				}
-				else
-				if (tp == strus::Paragraph::StructCitation
-				||  tp == strus::Paragraph::StructRef
-				||  tp == strus::Paragraph::StructAttribute)
-				{
-					doc.addAttribute( lexem.value);
-				}
-				else if (tp == strus::Paragraph::StructNone)
-				{
-					doc.openListItem( 1);
-				}
-				else
-				{
-					int colspan = lexem.colspan();
-					if (colspan <= 0)
-					{
-						doc.addError( "invalid colspan attribute value");
-						colspan = 0;
-					}
-					int rowspan = lexem.rowspan();
-					if (rowspan <= 0)
-					{
-						doc.addError( "invalid colspan attribute value");
-						rowspan = 0;
-					}
-					doc.addTableCell( rowspan, colspan);
-				}
-				break;
-			}
-			case strus::WikimediaLexem::ColDelim:
-			{
-				doc.closeOpenQuoteItems();
-				strus::Paragraph::StructType tp = doc.currentStructType();
-				if (tp == strus::Paragraph::StructPageLink
-				||  tp == strus::Paragraph::StructWebLink)
-				{
-					doc.clearOpenText();
-					//... ignore last text and restart structure
-				}
-				else if (tp == strus::Paragraph::StructList)
-				{
-					doc.addText( " |");
-					//... ignore
-				}
-				else if (tp == strus::Paragraph::StructTableTitle)
-				{
-					doc.addTableTitle();
-				}
-				else if (tp == strus::Paragraph::StructTableHead
-					|| tp == strus::Paragraph::StructTableCell)
-				{
-					int colspan = lexem.colspan();
-					if (colspan <= 0)
-					{
-						doc.addError( "invalid colspan attribute value");
-						colspan = 0;
-					}
-					int rowspan = lexem.rowspan();
-					if (rowspan <= 0)
-					{
-						doc.addError( "invalid colspan attribute value");
-						rowspan = 0;
-					}
-					doc.repeatTableCell( rowspan, colspan);
-				}
-				else
-				{
-					doc.addAttribute( lexem.value);
-				}
-				break;
-			}
-			case strus::WikimediaLexem::DoubleColDelimNewLine:
-			case strus::WikimediaLexem::DoubleColDelim:
-			{
-				doc.disableOpenFormatAndQuotes();
-				strus::Paragraph::StructType tp = doc.currentStructType();
-				if (tp == strus::Paragraph::StructList && lexem.id == strus::WikimediaLexem::DoubleColDelimNewLine)
-				{
-					doc.closeAutoCloseItem( strus::Paragraph::ListItemStart);
-					tp = doc.currentStructType();
-				}
-				if (tp == strus::Paragraph::StructPageLink
-				||  tp == strus::Paragraph::StructWebLink)
-				{
-					doc.clearOpenText();
-					//... ignore last text and restart structure
-				}
-				else if (tp == strus::Paragraph::StructTableTitle)
-				{
-					doc.addTableTitle();
-				}
-				else if (tp == strus::Paragraph::StructTableHead
-					|| tp == strus::Paragraph::StructTableCell)
-				{
-					int colspan = lexem.colspan();
-					if (colspan <= 0)
-					{
-						doc.addError( "invalid colspan attribute value");
-						colspan = 0;
-					}
-					int rowspan = lexem.rowspan();
-					if (rowspan <= 0)
-					{
-						doc.addError( "invalid colspan attribute value");
-						rowspan = 0;
-					}
-					doc.repeatTableCell( rowspan, colspan);
-				}
-				else if (tp == strus::Paragraph::StructCitation || tp == strus::Paragraph::StructAttribute)
-				{
-					doc.addAttribute( lexem.value);
-				}
-				else if (tp == strus::Paragraph::StructTable)
-				{
-					int colspan = lexem.colspan();
-					if (colspan <= 0)
-					{
-						doc.addError( "invalid colspan attribute value");
-						colspan = 0;
-					}
-					int rowspan = lexem.rowspan();
-					if (rowspan <= 0)
-					{
-						doc.addError( "invalid colspan attribute value");
-						rowspan = 0;
-					}
-					doc.addTableCell( rowspan, colspan);
-				}
-				else if (tp == strus::Paragraph::StructList)
-				{
-					doc.addBreak();
-				}
-				else
-				{
-					doc.addError( "unexpected token '||'");
-				}
-				break;
-			}
-			case strus::WikimediaLexem::TextBreak:
-				// ... text break only splits text.
-				pendingTextBreak = true;
-				continue;
-			case strus::WikimediaLexem::Break:
-				doc.addBreak();
-				break;
-		}
-		pendingTextBreak = false;
-		if (doc.hasNewErrors())
+		std::string rt( strus::string_format(
+			"documents converted: %d\n"
+			"documents with errors: %d\n"
+			"errors: %d\n"
+			"documents with unresolved page links: %d\n"
+			"unresolved page links: %d\n"
+			"documents failed: %d\n",
+			m_nofDocuments.value(), m_nofDocumentsWithErrors.value(), m_nofErrors.value(),
+			m_nofDocumentsWithUnresolved.value(), m_nofUnresolved.value(), (int)m_failures.size()));
+		strus::unique_lock lock( m_mutex);
+		std::vector<std::string>::const_iterator fi = m_failures.begin(), fe = m_failures.end();
+		for (; fi != fe; ++fi)
 		{
-			doc.setErrorsSourceInfo( lexer.currentSourceExtract( 60));
+			rt.append( *fi);
+			rt.push_back( '\n');
 		}
-		
+		return rt;
 	}
-}
+
+private:
+	strus::AtomicCounter<int> m_nofDocuments;
+	strus::AtomicCounter<int> m_nofDocumentsWithErrors;
+	strus::AtomicCounter<int> m_nofErrors;
+	strus::AtomicCounter<int> m_nofDocumentsWithUnresolved;
+	strus::AtomicCounter<int> m_nofUnresolved;
+	strus::mutex m_mutex;
+	std::vector<std::string> m_failures;		///< documents failed with the error message
+};
+static DiagnosticsSummary* g_diagnosticsSummary = NULL;
+
 
 static void createOutputDir( int fileCounter)
 {
+	if (g_outputShards) return;
 	char dirnam[ 16];
 	std::snprintf( dirnam, sizeof(dirnam), "%04u", fileCounter / 1000);
 	std::string dirpath( strus::joinFilePath( g_outputdir, dirnam));
@@ -492,6 +159,13 @@ static std::string getFilenameFromDocid( int fileCounter, const std::string& doc
 	}
 }
 
+static std::string getWorkFilePath( int fileCounter, const std::string& docid, const std::string& extension)
+{
+	char dirnam[ 16];
+	std::snprintf( dirnam, sizeof(dirnam), "%04u", fileCounter / 1000);
+	return strus::joinFilePath( strus::joinFilePath( g_outputdir, dirnam), getFilenameFromDocid( fileCounter, docid) + extension);
+}
+
 static void writeWorkFile( int fileCounter, const std::string& docid, const std::string& extension, const std::string& content)
 {
 	char dirnam[ 16];
@@ -514,9 +188,33 @@ static void writeWorkFile( int fileCounter, const std::string& docid, const std:
 			g_testOutput.append( out.str());
 		}
 	}
+	else if (g_outputShards)
+	{
+		std::string filename( strus::joinFilePath( dirnam, getFilenameFromDocid( fileCounter, docid) + extension));
+		try
+		{
+			g_outputShards->write( fileCounter, filename, content);
+		}
+		catch (const std::runtime_error& err)
+		{
+			std::cerr << "error writing file " << filename << ": " << err.what() << std::endl;
+		}
+	}
+	else if (g_fileWriter)
+	{
+		std::string filename( getWorkFilePath( fileCounter, docid, extension));
+		try
+		{
+			g_fileWriter->write( fileCounter, filename, content);
+		}
+		catch (const std::runtime_error& err)
+		{
+			std::cerr << "error writing file " << filename << ": " << err.what() << std::endl;
+		}
+	}
 	else
 	{
-		std::string filename( strus::joinFilePath( strus::joinFilePath( g_outputdir, dirnam), getFilenameFromDocid( fileCounter, docid) + extension));
+		std::string filename( getWorkFilePath( fileCounter, docid, extension));
 		ec = strus::writeFile( filename, content);
 		if (ec) std::cerr << "error writing file " << filename << ": " << std::strerror(ec) << std::endl;
 	}
@@ -524,14 +222,22 @@ static void writeWorkFile( int fileCounter, const std::string& docid, const std:
 
 static void removeWorkFile( int fileCounter, const std::string& docid, const std::string& extension)
 {
-	if (g_dumpStdout || g_doTest) return;
-
-	char dirnam[ 16];
-	std::snprintf( dirnam, sizeof(dirnam), "%04u", fileCounter / 1000);
-	int ec;
+	if (g_dumpStdout || g_doTest || g_outputShards) return;
 
-	std::string filename( strus::joinFilePath( strus::joinFilePath( g_outputdir, dirnam), getFilenameFromDocid( fileCounter, docid) + extension));
-	ec = strus::removeFile( filename, false);
+	std::string filename( getWorkFilePath( fileCounter, docid, extension));
+	if (g_fileWriter)
+	{
+		try
+		{
+			g_fileWriter->remove( fileCounter, filename);
+		}
+		catch (const std::runtime_error& err)
+		{
+			std::cerr << "error removing file " << filename << ": " << err.what() << std::endl;
+		}
+		return;
+	}
+	int ec = strus::removeFile( filename, false);
 	if (ec) std::cerr << "error removing file " << filename << ": " << std::strerror(ec) << std::endl;
 }
 
@@ -558,10 +264,111 @@ static void writeLexerDumpFile( int fileCounter, const strus::DocumentStructure&
 	writeWorkFile( fileCounter, doc.fileId(), ".txt", doc.tostring());
 }
 
-static void writeOutputFiles( int fileCounter, const strus::DocumentStructure& doc)
+static void writeUnresolvedFile( int fileCounter, const std::string& docid, const std::vector<std::string>& unresolved)
+{
+	if (g_diagnosticsSummary)
+	{
+		g_diagnosticsSummary->addUnresolved( unresolved.size());
+		return;
+	}
+	std::ostringstream unresolvedtext;
+	std::vector<std::string>::const_iterator ei = unresolved.begin(), ee = unresolved.end();
+	for (int eidx=1; ei != ee; ++ei,++eidx)
+	{
+		unresolvedtext << "[" << eidx << "] " << *ei << "\n";
+	}
+	std::string unresolveddump( unresolvedtext.str());
+	writeWorkFile( fileCounter, docid, ".mis", unresolveddump);
+	if (g_verbosity >= 1) std::cerr << "got " << (int)unresolved.size() << " unresolved page links:" << std::endl;
+}
+
+/// \brief Output sink passing the chunks to another sink, measuring the time of writing them and counting their bytes if statistics are collected (option --stats)
+class MeasuredOutputSink
+	:public strus::OutputSinkInterface
+{
+public:
+	MeasuredOutputSink( strus::OutputSinkInterface& sink_, strus::ThreadStatistics* stats_)
+		:m_sink(sink_),m_stats(stats_),m_ticks(0),m_size(0){}
+	virtual ~MeasuredOutputSink(){}
+
+	virtual void write( const char* ptr, std::size_t size)
+	{
+		if (!m_stats)
+		{
+			m_sink.write( ptr, size);
+			return;
+		}
+		strus::StatisticsTicks start = strus::getStatisticsTicks();
+		m_sink.write( ptr, size);
+		strus::StatisticsTicks elapsed = strus::getStatisticsTicks() - start;
+		m_stats->addTicks( strus::StageOutput, elapsed);
+		m_ticks += elapsed;
+		m_size += size;
+	}
+
+	/// \brief Get the time spent in writing the chunks
+	strus::StatisticsTicks ticks() const		{return m_ticks;}
+	/// \brief Get the number of bytes written
+	std::size_t size() const			{return m_size;}
+
+private:
+	strus::OutputSinkInterface& m_sink;
+	strus::ThreadStatistics* m_stats;
+	strus::StatisticsTicks m_ticks;
+	std::size_t m_size;
+};
+
+static void writeOutputFiles( int fileCounter, const strus::DocumentStructure& doc, strus::ThreadStatistics* stats)
 {
-	writeWorkFile( fileCounter, doc.fileId(), ".xml", doc.toxml( g_beautified, g_singleIdAttribute));
-	std::string strange = doc.reportStrangeFeatures();
+	if (g_dumpStdout || g_doTest || g_outputShards || g_fileWriter)
+	{
+		strus::StageTimer toxmlTimer( stats, strus::StageToXml);
+		std::string xml( doc.toxml( g_beautified, g_singleIdAttribute));
+		toxmlTimer.stop();
+
+		strus::StageTimer outputTimer( stats, strus::StageOutput);
+		writeWorkFile( fileCounter, doc.fileId(), ".xml", xml);
+		if (stats) stats->addOutputBytes( xml.size());
+	}
+	else
+	{
+		//... write the XML to the file in chunks as it is printed instead of building it in memory
+		strus::StageTimer openTimer( stats, strus::StageOutput);
+		strus::FileOutputSink fileSink( getWorkFilePath( fileCounter, doc.fileId(), ".xml"));
+		openTimer.stop();
+
+		MeasuredOutputSink sink( fileSink, stats);
+		strus::StageTimer toxmlTimer( stats, strus::StageToXml);
+		try
+		{
+			doc.toxml( sink, g_beautified, g_singleIdAttribute);
+		}
+		catch (...)
+		{
+			fileSink.discard();
+			throw;
+		}
+		toxmlTimer.stop( sink.ticks()/*time of writing the chunks is output*/);
+
+		strus::StageTimer closeTimer( stats, strus::StageOutput);
+		int ec = fileSink.close();
+		closeTimer.stop();
+		if (ec) std::cerr << "error writing file " << fileSink.filename() << ": " << std::strerror(ec) << std::endl;
+		if (stats) stats->addOutputBytes( sink.size());
+	}
+	strus::StageTimer diagnosticsTimer( stats, strus::StageDiagnostics);
+	if (g_deferLinks && !g_outputShards)
+	{
+		strus::unique_lock lock( g_convertedDocsMutex);
+		g_convertedDocs.push_back( std::pair<int,std::string>( fileCounter, doc.fileId()));
+	}
+	if (g_diagnosticsSummary)
+	{
+		//... production mode, no side files written or removed
+		g_diagnosticsSummary->addDocument( doc);
+		return;
+	}
+	std::string strange = g_strangeFeatureMatcher ? doc.reportStrangeFeatures( *g_strangeFeatureMatcher) : doc.reportStrangeFeatures();
 	if (strange.empty())
 	{
 		removeWorkFile( fileCounter, doc.fileId(), ".wtf");
@@ -593,227 +400,1287 @@ static void writeOutputFiles( int fileCounter, const strus::DocumentStructure& d
 	}
 	else
 	{
-		std::ostringstream unresolvedtext;
-		std::vector<std::string>::const_iterator ei = unresolved.begin(), ee = unresolved.end();
-		for (int eidx=1; ei != ee; ++ei,++eidx)
-		{
-			unresolvedtext << "[" << eidx << "] " << *ei << "\n";
-		}
-		std::string unresolveddump( unresolvedtext.str());
-		writeWorkFile( fileCounter, doc.fileId(), ".mis", unresolveddump);
-		if (g_verbosity >= 1) std::cerr << "got " << (int)unresolved.size() << " unresolved page links:" << std::endl;
+		writeUnresolvedFile( fileCounter, doc.fileId(), unresolved);
 	}
 }
 
-class Work
+class WorkScheduler;
+
+/// \brief Progress of the conversion reported in the status file (option --status), counted by the scanner and the conversion threads
+class ConversionProgress
+	:public strus::ConversionStatusSourceInterface
 {
 public:
-	Work()
-		:m_writeDumpsAlways(false),m_fileindex(-1),m_title(),m_content(){}
-	Work( int fileindex_, const std::string& title_, const std::string& content_, bool writeDumpsAlways_)
-		:m_writeDumpsAlways(writeDumpsAlways_),m_fileindex(fileindex_),m_title(title_),m_content(content_){}
-	Work( const Work& o)
-		:m_writeDumpsAlways(o.m_writeDumpsAlways),m_fileindex(o.m_fileindex),m_title(o.m_title),m_content(o.m_content){}
+	/// \param[in] scheduler_ scheduler of the conversion threads or NULL if the documents are converted in the calling thread
+	/// \param[in] inputSize_ size of the input file or 0 if not known
+	ConversionProgress( WorkScheduler* scheduler_, uint64_t inputSize_)
+		:m_scheduler(scheduler_),m_compressedInput(0),m_compressedInputPosition(0),m_compressed(false),m_inputSize(inputSize_)
+		,m_scannedBytes(0),m_nofPages(0),m_nofDocuments(0),m_nofInflight(0),m_mutex(){}
+	virtual ~ConversionProgress(){}
 
-	bool empty() const
+	/// \brief Set the compressed input the position in the input file is taken from, instead of the bytes scanned
+	void setCompressedInput( const strus::DecompressingInputStream* input)
 	{
-		return m_content.empty();
+		strus::unique_lock lock( m_mutex);
+		m_compressedInput = input;
+		m_compressed = true;
 	}
-	int fileindex() const				{return m_fileindex;}
-	const std::string& title() const		{return m_title;}
-	const std::string& content() const		{return m_content;}
+	/// \brief Release the compressed input before it is closed, keeping its last position
+	void releaseCompressedInput()
+	{
+		strus::unique_lock lock( m_mutex);
+		if (m_compressedInput) m_compressedInputPosition = m_compressedInput->position();
+		m_compressedInput = 0;
+	}
+	void addScannedBytes( std::size_t size)		{m_scannedBytes.increment( size);}
+	void addPage()					{m_nofPages.increment();}
+	void startDocument()				{m_nofInflight.increment();}
+	void finishDocument()
+	{
+		m_nofInflight.decrement();
+		m_nofDocuments.increment();
+	}
+
+	virtual void getStatus( strus::ConversionStatus& status) const;
+
+private:
+	WorkScheduler* m_scheduler;
+	const strus::DecompressingInputStream* m_compressedInput;
+	uint64_t m_compressedInputPosition;		///< last position of the compressed input released
+	bool m_compressed;
+	uint64_t m_inputSize;
+	strus::AtomicCounter<uint64_t> m_scannedBytes;
+	strus::AtomicCounter<int> m_nofPages;
+	strus::AtomicCounter<int> m_nofDocuments;
+	strus::AtomicCounter<int> m_nofInflight;
+	mutable strus::mutex m_mutex;
+};
+static ConversionProgress* g_progress = NULL;
 
-	void process()
+/// \brief Counts a document as in conversion for the status file (option --status) during its lifetime
+class InflightDocument
+{
+public:
+	InflightDocument()
 	{
-		bool inputFileWritten = false;
-		strus::DocumentStructure doc;
-		doc.setTitle( m_title);
-		try
-		{
-			parseDocumentText( doc, m_content.c_str(), m_content.size());
-			doc.finish();
-			writeOutputFiles( m_fileindex, doc);
-			if (m_writeDumpsAlways || !doc.errors().empty())
-			{
+		if (g_progress) g_progress->startDocument();
+	}
+	~InflightDocument()
+	{
+		if (g_progress) g_progress->finishDocument();
+	}
+};
+
+/// \brief Releases all strings of a document in the string arena of a thread when the document has been processed
+class StringArenaReset
+{
+public:
+	explicit StringArenaReset( strus::StringArena& arena_)
+		:m_arena(arena_){}
+	~StringArenaReset()
+	{
+		m_arena.reset();
+	}
+
+private:
+	strus::StringArena& m_arena;
+};
+
+/// \brief Document to convert
+/// \note Not copyable, passed by pointer with ownership from the XML scanner to the conversion threads. The content is referenced in a shared chunk and not copied.
+class Work
+{
+public:
+	Work( int fileindex_, const std::string& title_, const strus::ContentRef& content_, bool writeDumpsAlways_)
+		:m_writeDumpsAlways(writeDumpsAlways_),m_fileindex(fileindex_),m_title(title_),m_content(content_){}
+
+	bool empty() const
+	{
+		return m_content.empty();
+	}
+	int fileindex() const				{return m_fileindex;}
+	const std::string& title() const		{return m_title;}
+	const strus::ContentRef& content() const	{return m_content;}
+	std::size_t size() const			{return m_title.size() + m_content.size();}
+
+	/// \brief Convert the document
+	/// \param[in] arena string arena of the calling thread, reset after the conversion for the next document
+	/// \param[in] stats statistics of the calling thread or NULL if not collected (option --stats)
+	void process( strus::StringArena& arena, strus::ThreadStatistics* stats)
+	{
+		InflightDocument inflight;
+		strus::StatisticsTicks start = stats ? strus::getStatisticsTicks() : 0;
+		convert( arena, stats);
+		if (stats) stats->addDocument( m_title, m_content.size(), strus::getStatisticsTicks() - start);
+	}
+
+private:
+	void convert( strus::StringArena& arena, strus::ThreadStatistics* stats)
+	{
+		bool inputFileWritten = false;
+		StringArenaReset arenaReset( arena);
+		strus::DocumentStructure doc( &arena);
+		doc.setTitle( m_title);
+		try
+		{
+			strus::parseDocumentText( doc, m_content.ptr(), m_content.size(), g_linkmap, g_deferLinks, g_verbosity >= 2, stats);
+			{
+				strus::StageTimer finishTimer( stats, strus::StageFinish);
+				doc.finish();
+			}
+			writeOutputFiles( m_fileindex, doc, stats);
+			if (g_diagnosticsSummary) return;
+			if (m_writeDumpsAlways || !doc.errors().empty())
+			{
+				strus::StageTimer diagnosticsTimer( stats, strus::StageDiagnostics);
 				writeLexerDumpFile( m_fileindex, doc);
 				if (!inputFileWritten)
 				{
-					writeInputFile( m_fileindex, doc.fileId(), m_title, m_content);
+					writeInputFile( m_fileindex, doc.fileId(), m_title, m_content.tostring());
 					inputFileWritten = true;
 				}
 			}
 		}
 		catch (const std::runtime_error& err)
 		{
+			if (g_diagnosticsSummary)
+			{
+				g_diagnosticsSummary->addFailure( m_title, err.what());
+				return;
+			}
+			strus::StageTimer diagnosticsTimer( stats, strus::StageDiagnostics);
 			writeLexerDumpFile( m_fileindex, doc);
 			writeErrorFile( m_fileindex, doc.fileId(), err.what());
 			writeFatalErrorFile( m_fileindex, doc.fileId(), std::string(err.what()) + "\n");
 			if (!inputFileWritten)
 			{
-				writeInputFile( m_fileindex, doc.fileId(), m_title, m_content);
+				writeInputFile( m_fileindex, doc.fileId(), m_title, m_content.tostring());
 				inputFileWritten = true;
 			}
 		}
 	}
 
+private:
+	Work( const Work&){}			//... non copyable
+	void operator=( const Work&){}		//... non copyable
+
 private:
 	bool m_writeDumpsAlways;
 	int m_fileindex;
 	std::string m_title;
-	std::string m_content;
+	strus::ContentRef m_content;
 };
 
-class Worker
+static double getTimeSeconds()
+{
+	struct timespec ts;
+	::clock_gettime( CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/// \brief Deque of documents assigned to one worker thread.
+/// \note The owner takes work from the front, other threads steal from the back.
+/// \note The deque owns the work queued, ownership is passed to the caller on pop.
+class WorkDeque
+{
+public:
+	WorkDeque(){}
+	~WorkDeque()
+	{
+		std::deque<Work*>::iterator wi = m_deque.begin(), we = m_deque.end();
+		for (; wi != we; ++wi) delete *wi;
+	}
+
+	void pushBack( Work* work)
+	{
+		strus::unique_lock lock( m_mutex);
+		m_deque.push_back( work);
+	}
+	Work* popFront()
+	{
+		strus::unique_lock lock( m_mutex);
+		if (m_deque.empty()) return NULL;
+		Work* rt = m_deque.front();
+		m_deque.pop_front();
+		return rt;
+	}
+	Work* popBack()
+	{
+		strus::unique_lock lock( m_mutex);
+		if (m_deque.empty()) return NULL;
+		Work* rt = m_deque.back();
+		m_deque.pop_back();
+		return rt;
+	}
+	int size()
+	{
+		strus::unique_lock lock( m_mutex);
+		return m_deque.size();
+	}
+
+private:
+	strus::mutex m_mutex;
+	std::deque<Work*> m_deque;
+};
+
+/// \brief Scheduler distributing the documents to process on per thread deques.
+/// \note Threads running out of work steal documents from the deques of other threads, so that all threads stay busy until the end of the input.
+/// \note The scheduler is bounded by the number of bytes of content queued. The producer blocks in push if the limit is reached, consumers block in fetch if no work is available.
+class WorkScheduler
 {
 public:
-	enum {MaxQueueSize = 4000};
+	WorkScheduler( int nofThreads_, std::size_t capacity_)
+		:m_ar(new WorkDeque[ nofThreads_]),m_nofThreads(nofThreads_),m_nextidx(0)
+		,m_capacity(capacity_),m_nofQueued(0),m_queuedBytes(0),m_eof(false){}
+	~WorkScheduler()
+	{
+		delete [] m_ar;
+	}
+
+	/// \brief Queue a document for processing, block as long as the queued content would exceed the capacity
+	/// \note A document larger than the capacity is accepted when nothing else is queued
+	/// \note The ownership of the work is passed to the scheduler
+	void push( Work* work)
+	{
+		std::size_t worksize = work->size();
+		strus::unique_lock lock( m_mutex);
+		while (m_queuedBytes > 0 && m_queuedBytes + worksize > m_capacity)
+		{
+			m_cv_notFull.wait( lock);
+		}
+		m_ar[ m_nextidx].pushBack( work);
+		m_nextidx = (m_nextidx + 1) % m_nofThreads;
+		++m_nofQueued;
+		m_queuedBytes += worksize;
+		m_cv_notEmpty.notify_one();
+	}
+
+	/// \brief Fetch the next document to process for a thread, steal from other threads if the own deque is empty
+	/// \param[in] threadidx index of the thread starting with 0
+	/// \param[out] stolen true if the document has been taken from the deque of another thread
+	/// \return the document fetched with ownership passed to the caller or NULL if there is no more work to do
+	Work* fetch( int threadidx, bool& stolen)
+	{
+		for (;;)
+		{
+			Work* rt = tryFetch( threadidx, stolen);
+			if (rt)
+			{
+				strus::unique_lock lock( m_mutex);
+				--m_nofQueued;
+				m_queuedBytes -= rt->size();
+				m_cv_notFull.notify_one();
+				return rt;
+			}
+			strus::unique_lock lock( m_mutex);
+			if (m_nofQueued > 0) continue;
+			if (m_eof) return NULL;
+			m_cv_notEmpty.wait( lock);
+		}
+	}
 
+	void setEof()
+	{
+		strus::unique_lock lock( m_mutex);
+		m_eof = true;
+		m_cv_notEmpty.notify_all();
+	}
+
+	/// \brief Get the number of documents queued for every thread
+	std::vector<int> queueDepths()
+	{
+		std::vector<int> rt;
+		int ti = 0;
+		for (; ti < m_nofThreads; ++ti)
+		{
+			rt.push_back( m_ar[ ti].size());
+		}
+		return rt;
+	}
+
+private:
+	Work* tryFetch( int threadidx, bool& stolen)
+	{
+		stolen = false;
+		Work* rt = m_ar[ threadidx].popFront();
+		if (rt) return rt;
+		int ti = threadidx + 1;
+		for (; ti != threadidx + m_nofThreads; ++ti)
+		{
+			rt = m_ar[ ti % m_nofThreads].popBack();
+			if (rt)
+			{
+				stolen = true;
+				return rt;
+			}
+		}
+		return NULL;
+	}
+
+private:
+	WorkDeque* m_ar;
+	int m_nofThreads;
+	int m_nextidx;
+	std::size_t m_capacity;
+	int m_nofQueued;
+	std::size_t m_queuedBytes;
+	bool m_eof;
+	strus::mutex m_mutex;
+	strus::condition_variable m_cv_notEmpty;
+	strus::condition_variable m_cv_notFull;
+};
+
+void ConversionProgress::getStatus( strus::ConversionStatus& status) const
+{
+	status.scannedBytes = m_scannedBytes.value();
+	status.inputSize = m_inputSize;
+	status.nofPages = m_nofPages.value();
+	status.nofDocuments = m_nofDocuments.value();
+	status.nofInflight = m_nofInflight.value();
+	if (m_scheduler) status.queueDepths = m_scheduler->queueDepths();
+	strus::unique_lock lock( m_mutex);
+	if (m_compressedInput)
+	{
+		status.inputPosition = m_compressedInput->position();
+	}
+	else
+	{
+		status.inputPosition = m_compressed ? m_compressedInputPosition : status.scannedBytes;
+	}
+	//... the scanner may count the end of a part of the input scanned in parallel as a byte
+	if (m_inputSize && status.inputPosition > m_inputSize) status.inputPosition = m_inputSize;
+}
+
+class Worker
+{
+public:
 	Worker()
-		:m_thread(0),m_threadid(0),m_terminated(false),m_eof(false),m_writeDumpsAlways(g_dumps){}
+		:m_scheduler(0),m_thread(0),m_threadid(0),m_nofDocuments(0),m_nofStolen(0),m_busyTime(0.0),m_idleTime(0.0),m_arena(),m_statistics(0){}
 	~Worker()
 	{
 		waitTermination();
 	}
 
-	void push( int filecounter, const std::string& title, const std::string& content)
+	void waitTermination()
+	{
+		if (m_thread)
+		{
+			m_scheduler->setEof();
+			m_thread->join();
+			delete m_thread;
+			m_thread = 0;
+			if (g_verbosity >= 1) std::cerr << strus::string_format( "thread %d terminated\n", m_threadid) << std::flush;
+		}
+	}
+
+	void run()
+	{
+		if (g_verbosity >= 1) std::cerr << strus::string_format( "thread %d started\n", m_threadid) << std::flush;
+		double timestamp = getTimeSeconds();
+		bool stolen;
+		strus::local_ptr<Work> work( fetch( stolen));
+		while (work.get())
+		{
+			double now = getTimeSeconds();
+			m_idleTime += now - timestamp;
+			timestamp = now;
+
+			++m_nofDocuments;
+			if (stolen) ++m_nofStolen;
+			try
+			{
+				if (g_verbosity >= 1) std::cerr << strus::string_format( "thread %d process document '%s'\n", m_threadid, work->title().c_str()) << std::flush;
+				work->process( m_arena, m_statistics);
+			}
+			catch (const std::bad_alloc&)
+			{
+				std::cerr << "out of memory processing document " << work->title() << std::endl;
+			}
+			catch (const std::runtime_error& err)
+			{
+				std::cerr << "error processing document " << work->title() << ": " << err.what() << std::endl;
+			}
+			now = getTimeSeconds();
+			m_busyTime += now - timestamp;
+			timestamp = now;
+
+			work.reset( fetch( stolen));
+		}
+		m_idleTime += getTimeSeconds() - timestamp;
+	}
+	void start( WorkScheduler* scheduler_, int threadid_)
+	{
+		m_scheduler = scheduler_;
+		m_threadid = threadid_;
+		if (m_thread) throw std::runtime_error("start called twice");
+		if (g_statistics) m_statistics = g_statistics->createThreadStatistics( strus::string_format( "worker %d", m_threadid));
+		m_thread = new strus::thread( &Worker::run, this);
+	}
+
+	std::string statistics() const
+	{
+		return strus::string_format( "thread %d processed %d documents (%d stolen), busy %.3f seconds, idle %.3f seconds", m_threadid, m_nofDocuments, m_nofStolen, m_busyTime, m_idleTime);
+	}
+
+private:
+	Work* fetch( bool& stolen)
+	{
+		strus::StageTimer fetchTimer( m_statistics, strus::StageQueueFetch);
+		return m_scheduler->fetch( m_threadid-1, stolen);
+	}
+
+private:
+	WorkScheduler* m_scheduler;
+	strus::thread* m_thread;
+	int m_threadid;
+	int m_nofDocuments;
+	int m_nofStolen;
+	double m_busyTime;
+	double m_idleTime;
+	strus::StringArena m_arena;					///< string arena for the documents converted by this thread, reused for every document
+	strus::ThreadStatistics* m_statistics;				///< statistics of this thread if collected (option --stats) or NULL
+};
+
+class IStream
+	:public textwolf::IStream
+{
+public:
+	explicit IStream( const std::string& docpath)
+		:m_impl(docpath)
+	{
+		int ec = m_impl.error();
+		if (ec) throw std::runtime_error( strus::string_format("failed to read input file '%s': %s", docpath.c_str(), ::strerror(ec)));
+	}
+	virtual ~IStream(){}
+
+	virtual std::size_t read( void* buf, std::size_t bufsize)
+	{
+		return m_impl.read( (char*)buf, bufsize);
+	}
+
+	virtual int errorcode() const
+	{
+		return m_impl.error();
+	}
+
+private:
+	strus::InputStream m_impl;
+};
+
+static int getUIntOptionArg( int argi, int argc, const char* argv[])
+{
+	if (argv[argi+1])
+	{
+		return strus::numstring_conv::touint( argv[argi+1], std::numeric_limits<int>::max());
+	}
+	else
+	{
+		throw std::runtime_error( std::string("no argument given for option ") + argv[argi]);
+	}
+}
+
+/// \brief Elements of a Wikimedia dump selected by the dump reader
+enum DumpPath {PathPage=1,PathPageEnd,PathNs,PathTitle,PathRedirectTitle,PathTextStart,PathText};
+
+/// \brief Automaton selecting the elements of the pages of a Wikimedia dump needed, /mediawiki/page/{ns,title,redirect@title,revision/text}
+/// \note The name of the root element is not checked (the test documents have a root element <wikimedia>). The paths are also defined relative to a page as root element for the parts of a dump scanned in parallel, that start with a <page> tag
+class DumpPathAutomaton
+	:public textwolf::XMLPathSelectAutomaton<textwolf::charset::UTF8>
+{
+public:
+	DumpPathAutomaton()
+	{
+		PathElement root = **this;
+		definePagePaths( PathElement( root).selectTag( 0/*any root element*/).selectTag( "page"));
+		definePagePaths( PathElement( root).selectTag( "page"));
+	}
+
+private:
+	static void definePagePaths( const PathElement& page)
+	{
+		PathElement( page).assignType( PathPage);
+		PathElement( page).selectCloseTag().assignType( PathPageEnd);
+		PathElement( page).selectTag( "ns").selectContent().assignType( PathNs);
+		PathElement( page).selectTag( "title").selectContent().assignType( PathTitle);
+		PathElement( page).selectTag( "redirect").selectAttribute( "title").assignType( PathRedirectTitle);
+		//... redirect target as content of the redirect tag in older dumps
+		PathElement( page).selectTag( "redirect").selectContent().assignType( PathRedirectTitle);
+		PathElement( page).selectTag( "revision").selectTag( "text").assignType( PathTextStart);
+		PathElement( page).selectTag( "revision").selectTag( "text").selectContent().assignType( PathText);
+	}
+};
+
+static const DumpPathAutomaton g_dumpPathAutomaton;
+
+struct DocAttributes
+{
+	int ns;
+	std::string title;
+	std::string redirect_title;
+	strus::ContentRef content;
+	std::size_t contentSize;		///< size of the content, also set if the text of the page is skipped and the content not read
+
+	DocAttributes()
+		:ns(0),title(),redirect_title(),contentSize(0){}
+	void clear()
+	{
+		ns = 0;
+		title.clear();
+		redirect_title.clear();
+		content.clear();
+		contentSize = 0;
+	}
+};
+
+/// \brief Processing of the pages recognized by the XML scanner
+class PageProcessor
+{
+public:
+	/// \brief Constructor
+	/// \param[in] scheduler_ scheduler of the conversion threads or NULL if the documents are converted in the calling thread
+	/// \param[in] linkmapBuilder_ link map builder if redirects are collected (option -R) or NULL
+	/// \param[in] deferLinks_ true if the documents are converted while collecting redirects and their page links are patched at the end (option --onepass)
+	PageProcessor( WorkScheduler* scheduler_, strus::LinkMapBuilder* linkmapBuilder_, bool deferLinks_, const std::set<int>& namespacemap_, bool namespaceset_, const std::vector<std::string>& selectDocumentPattern_, const std::string& dumpfilename_, int counterMod_)
+		:m_scheduler(scheduler_),m_linkmapBuilder(linkmapBuilder_),m_deferLinks(deferLinks_),m_namespacemap(namespacemap_),m_namespaceset(namespaceset_)
+		,m_selectDocumentPattern(selectDocumentPattern_),m_dumpfilename(dumpfilename_),m_counterMod(counterMod_),m_docCounter(0),m_countOnly(false),m_arena(),m_statistics(0){}
+	/// \brief Constructor for processing a part of the input in parallel with the same configuration as another processor
+	/// \param[in] docCounterBase_ number of documents in the input before the part processed
+	/// \param[in] countOnly_ true if the documents are only counted and not processed
+	PageProcessor( const PageProcessor& o, int docCounterBase_, bool countOnly_)
+		:m_scheduler(o.m_scheduler),m_linkmapBuilder(o.m_linkmapBuilder),m_deferLinks(o.m_deferLinks),m_namespacemap(o.m_namespacemap),m_namespaceset(o.m_namespaceset)
+		,m_selectDocumentPattern(o.m_selectDocumentPattern),m_dumpfilename(o.m_dumpfilename),m_counterMod(o.m_counterMod),m_docCounter(docCounterBase_),m_countOnly(countOnly_),m_arena(),m_statistics(0){}
+	/// \brief Copy constructor, the copy gets a string arena and statistics of its own
+	PageProcessor( const PageProcessor& o)
+		:m_scheduler(o.m_scheduler),m_linkmapBuilder(o.m_linkmapBuilder),m_deferLinks(o.m_deferLinks),m_namespacemap(o.m_namespacemap),m_namespaceset(o.m_namespaceset)
+		,m_selectDocumentPattern(o.m_selectDocumentPattern),m_dumpfilename(o.m_dumpfilename),m_counterMod(o.m_counterMod),m_docCounter(o.m_docCounter),m_countOnly(o.m_countOnly),m_arena(),m_statistics(0){}
+
+	bool namespaceset() const			{return m_namespaceset;}
+	int docCounter() const				{return m_docCounter;}
+	bool countOnly() const				{return m_countOnly;}
+
+	/// \brief Get the statistics of the thread using this processor, created with the first call
+	/// \return the statistics or NULL if not collected (option --stats)
+	strus::ThreadStatistics* statistics()
+	{
+		if (!m_statistics && g_statistics)
+		{
+			m_statistics = g_statistics->createThreadStatistics( m_countOnly ? "counter" : "scanner");
+		}
+		return m_statistics;
+	}
+
+	/// \brief Decide with the attributes of a page preceding its text if the content of the text is needed or if its size is enough
+	/// \note The content is not needed for pages not selected and for pages only defining a link when collecting redirects (option -R without --onepass)
+	bool needsContent( const DocAttributes& docAttributes) const
+	{
+		if (!isSelected( docAttributes)) return false;
+		//... a redirect is classified by the size of the content with entities decoded, so the content is read
+		if (!docAttributes.redirect_title.empty()) return true;
+		return !m_countOnly && (!m_linkmapBuilder || m_deferLinks);
+	}
+
+	void openPage()
+	{
+		if (m_docCounter % 1000 == 0 && !m_countOnly && (!m_linkmapBuilder || m_deferLinks) && !g_dumpStdout && !g_doTest)
+		{
+			createOutputDir( m_docCounter);
+		}
+	}
+
+	void closePage( const DocAttributes& docAttributes)
+	{
+		PageClass pageClass = classifyPage( docAttributes);
+		if (m_countOnly)
+		{
+			if (pageClass == PageDocument || (pageClass == PageRedirect && m_linkmapBuilder && !m_deferLinks)) ++m_docCounter;
+			return;
+		}
+		if (g_progress) g_progress->addPage();
+		switch (pageClass)
+		{
+			case PageIgnored:
+				break;
+			case PageRedirect:
+				if (m_linkmapBuilder)
+				{
+					std::pair<std::string,std::string> redir_parts = strus::LinkMap::getLinkParts( docAttributes.redirect_title);
+					if (g_verbosity >= 1) std::cerr << strus::string_format( "%s => %s\n", docAttributes.title.c_str(), docAttributes.redirect_title.c_str());
+					m_linkmapBuilder->redirect( docAttributes.title, redir_parts.first);
+
+					if (!m_deferLinks)
+					{
+						++m_docCounter;
+						if (m_counterMod && g_verbosity == 0 && m_docCounter % m_counterMod == 0)
+						{
+							std::cerr << "processed " << m_docCounter << " documents" << std::endl;
+						}
+					}
+				}
+				break;
+			case PageDocument:
+				if (m_linkmapBuilder)
+				{
+					if (g_verbosity >= 1) std::cerr << strus::string_format( "link %s => %s\n", docAttributes.title.c_str(), docAttributes.title.c_str());
+					m_linkmapBuilder->define( docAttributes.title);
+				}
+				if (m_linkmapBuilder && !m_deferLinks)
+				{
+					++m_docCounter;
+					if (m_counterMod && g_verbosity == 0 && m_docCounter % m_counterMod == 0)
+					{
+						std::cerr << "processed " << m_docCounter << " documents" << std::endl;
+					}
+				}
+				else
+				{
+					if (!m_dumpfilename.empty())
+					{
+						int ec = strus::writeFile( m_dumpfilename, docAttributes.content.tostring());
+						if (ec) std::cerr << "failed to write dump file " << m_dumpfilename << ": " << ::strerror(ec) << std::endl;
+					}
+					++m_docCounter;
+					int docIndex = m_docCounter-1;
+					if (m_scheduler)
+					{
+						strus::StageTimer pushTimer( statistics(), strus::StageQueuePush);
+						m_scheduler->push( new Work( docIndex, docAttributes.title, docAttributes.content, g_dumps));
+					}
+					else
+					{
+						try
+						{
+							Work work( docIndex, docAttributes.title, docAttributes.content, g_dumps);
+							if (g_verbosity >= 1) std::cerr << strus::string_format( "process document '%s'\n", docAttributes.title.c_str()) << std::flush;
+							work.process( m_arena, statistics());
+						} 
+						catch (const std::bad_alloc&)
+						{
+							std::cerr << "out of memory processing document " << docAttributes.title << std::endl;
+						}
+						catch (const std::runtime_error& err)
+						{
+							std::cerr << "error processing document " << docAttributes.title << ": " << err.what() << std::endl;
+						}
+					}
+					if (m_counterMod && g_verbosity == 0 && m_docCounter % m_counterMod == 0)
+					{
+						std::cerr << "processed " << m_docCounter << " documents" << std::endl;
+					}
+				}
+				break;
+			case PageEmpty:
+				std::cerr << "empty document '" << docAttributes.title << "'" << std::endl;
+				break;
+			case PageInvalid:
+				std::cerr << "invalid document '" << docAttributes.title << "'" << std::endl;
+				break;
+		}
+	}
+
+private:
+	enum PageClass {PageIgnored,PageRedirect,PageDocument,PageEmpty,PageInvalid};
+
+	bool isSelected( const DocAttributes& docAttributes) const
+	{
+		if (m_namespaceset && m_namespacemap.find( docAttributes.ns) == m_namespacemap.end())
+		{
+			//... ignore document but those with ns set to what is selected by option '-n'
+			return false;
+		}
+		if (!m_selectDocumentPattern.empty())
+		{
+			std::vector<std::string>::const_iterator si = m_selectDocumentPattern.begin(), se = m_selectDocumentPattern.end();
+			for (; si != se && 0==std::strstr( docAttributes.title.c_str(), si->c_str()); ++si){}
+			if (si == se) return false;
+		}
+		return true;
+	}
+
+	PageClass classifyPage( const DocAttributes& docAttributes) const
+	{
+		if (!isSelected( docAttributes))
+		{
+			return PageIgnored;
+		}
+		if (!docAttributes.redirect_title.empty() && docAttributes.contentSize < 1000)
+		{
+			return PageRedirect;
+		}
+		else if (!docAttributes.title.empty() && docAttributes.contentSize)
+		{
+			return PageDocument;
+		}
+		else if (!docAttributes.contentSize)
+		{
+			return PageEmpty;
+		}
+		else
+		{
+			return PageInvalid;
+		}
+	}
+
+private:
+	WorkScheduler* m_scheduler;
+	strus::LinkMapBuilder* m_linkmapBuilder;
+	bool m_deferLinks;
+	std::set<int> m_namespacemap;
+	bool m_namespaceset;
+	std::vector<std::string> m_selectDocumentPattern;
+	std::string m_dumpfilename;
+	int m_counterMod;
+	int m_docCounter;
+	bool m_countOnly;
+	strus::StringArena m_arena;			///< string arena for documents converted in the calling thread
+	strus::ThreadStatistics* m_statistics;		///< statistics of the calling thread if collected (option --stats) or NULL
+};
+
+/// \brief Scan a Wikimedia XML dump and pass the pages found to a page processor
+/// \note Only the elements selected by the dump path automaton are processed. The subtrees without any element selected are skipped with a raw scan for their end tag, and so is the text of a page if the page processor does not need it, then only its size is taken. This relies on the elements describing a page preceding its text, as in the Wikimedia dumps.
+/// \param[in] inputiterator source iterator of the XML scanner
+/// \param[in] inplaceSource pointer to the start of the source if the source is in memory for the whole processing (memory mapped file) and the content can be referenced in place, NULL else
+template <class InputIterator>
+static void scanDump( const InputIterator& inputiterator, PageProcessor& processor, const char* inplaceSource)
+{
+	typedef textwolf::XMLScanner<InputIterator,textwolf::charset::UTF8,textwolf::charset::UTF8,std::string> XmlScanner;
+	typedef textwolf::XMLPathSelect<textwolf::charset::UTF8> XmlPathSelect;
+
+	XmlScanner xs( inputiterator);
+	XmlPathSelect pathSelect( &g_dumpPathAutomaton);
+	typename XmlScanner::iterator itr=xs.begin(),end=xs.end();
+	DocAttributes docAttributes;
+	strus::ContentAllocator contentAllocator;
+	bool terminated = false;
+	//... with verbosity >= 2 every element is scanned and printed, nothing is skipped
+	const bool skipSubtrees = (g_verbosity < 2);
+	//... mask of the elements returned with content, the content of other elements is skipped
+	const unsigned short readAllMask = 0xFFFF;
+	const unsigned short skipContentMask = skipSubtrees ? (unsigned short)~(1 << XmlScanner::Content) : readAllMask;
+	//... element types selected in a subtree that make it necessary to scan it (the close tag of the root of a subtree skipped is still returned)
+	const unsigned short subtreeSelectMask = ~((1 << XmlScanner::CloseTag) | (1 << XmlScanner::CloseTagIm));
+	unsigned short mask = readAllMask;
+	bool skipText = false;
+	//... the time of processing the pages found is measured by the stages of the conversion, not as scanning
+	strus::ThreadStatistics* stats = processor.statistics();
+	strus::StageTimer scanTimer( stats, strus::StageXmlScan);
+	strus::StatisticsTicks pageTicks = 0;
+	//... bytes scanned reported to the status file at the end of every page, not in the counting pass of a parallel scan
+	ConversionProgress* progress = processor.countOnly() ? NULL : g_progress;
+	std::size_t progressPosition = 0;
+
+	for (; !terminated && itr!=end; itr.skip( mask))
+	{
+		if (g_verbosity >= 2) std::cout << "XML " << itr->name() << " " << strus::outputLineString( itr->content(), itr->content()+itr->size(), 80) << std::endl;
+		switch (itr->type())
+		{
+			case XmlScanner::ErrorOccurred: throw std::runtime_error( "xml error");
+			case XmlScanner::Exit: terminated = true; break;
+			case XmlScanner::CloseTagIm:
+			case XmlScanner::CloseTag:
+				//... the elements with content selected have no child elements
+				mask = skipContentMask;
+				break;
+			default: break;
+		}
+		bool textStart = false;
+		typename XmlPathSelect::iterator pi = pathSelect.push( itr->type(), itr->content(), itr->size()), pe = pathSelect.end();
+		for (; pi != pe; ++pi)
+		{
+			switch ((DumpPath)*pi)
+			{
+				case PathPage:
+					docAttributes.clear();
+					processor.openPage();
+					break;
+				case PathPageEnd:
+				{
+					strus::StatisticsTicks pageStart = stats ? strus::getStatisticsTicks() : 0;
+					processor.closePage( docAttributes);
+					if (stats) pageTicks += strus::getStatisticsTicks() - pageStart;
+					if (progress)
+					{
+						std::size_t position = xs.getPosition();
+						progress->addScannedBytes( position - progressPosition);
+						progressPosition = position;
+					}
+					break;
+				}
+				case PathNs:
+				{
+					std::string contentstr( itr->content(), itr->size());
+					docAttributes.ns = strus::numstring_conv::toint( contentstr, 10000);
+					break;
+				}
+				case PathTitle:
+					docAttributes.title = std::string( itr->content(), itr->size());
+					break;
+				case PathRedirectTitle:
+					docAttributes.redirect_title = std::string( itr->content(), itr->size());
+					break;
+				case PathTextStart:
+					textStart = true;
+					skipText = !processor.needsContent( docAttributes);
+					break;
+				case PathText:
+				{
+					// ... the scanner position is after the '<' of the tag following the content
+					std::size_t rawsize = xs.getPosition() - xs.getTokenPosition() - 1;
+					if (skipText)
+					{
+						docAttributes.contentSize = rawsize;
+						break;
+					}
+					docAttributes.contentSize = itr->size();
+					if (inplaceSource && rawsize == itr->size())
+					{
+						// ... content without entities or other encodings is referenced in the source
+						docAttributes.content = strus::ContentRef( inplaceSource + xs.getTokenPosition(), itr->size());
+					}
+					else
+					{
+						docAttributes.content = contentAllocator.alloc( itr->content(), itr->size());
+					}
+					break;
+				}
+			}
+		}
+		if (itr->type() == XmlScanner::OpenTag)
+		{
+			if (skipSubtrees && ((textStart && skipText) || !pathSelect.scopeSelects( subtreeSelectMask)))
+			{
+				std::size_t rawsize;
+				if (!xs.skipElement( rawsize)) throw std::runtime_error( "xml error");
+				if (textStart) docAttributes.contentSize = rawsize;
+				mask = skipContentMask;
+			}
+			else
+			{
+				mask = pathSelect.scopeSelects( 1 << XmlScanner::Content) ? readAllMask : skipContentMask;
+			}
+		}
+	}
+	scanTimer.stop( pageTicks);
+	if (stats) stats->addScannedBytes( xs.getPosition());
+	if (progress) progress->addScannedBytes( xs.getPosition() - progressPosition);
+}
+
+
+/// \brief Get the start positions of the parts of an input scanned in parallel
+/// \note Every part but the first starts with a <page> tag. A raw "<page>" cannot appear in the content of a page, because it would be escaped there.
+static std::vector<std::size_t> getInputSplitPositions( const char* src, std::size_t size, int nofParts)
+{
+	static const char* pagetag = "<page>";
+	enum {PageTagLen = 6};
+	std::vector<std::size_t> rt;
+	rt.push_back( 0);
+	int pi = 1;
+	for (; pi < nofParts; ++pi)
+	{
+		std::size_t pos = (std::size_t)(((double)size * pi) / nofParts);
+		if (pos <= rt.back()) pos = rt.back() + 1;
+		const char* found = 0;
+		while (pos + PageTagLen <= size)
+		{
+			found = (const char*)std::memchr( src + pos, '<', size - pos);
+			if (!found) break;
+			pos = found - src;
+			if (pos + PageTagLen <= size && 0==std::memcmp( found, pagetag, PageTagLen)) break;
+			found = 0;
+			++pos;
+		}
+		if (!found) break;
+		rt.push_back( pos);
+	}
+	return rt;
+}
+
+/// \brief Thread scanning a part of a memory mapped input
+class PartScanner
+{
+public:
+	PartScanner()
+		:m_src(0),m_size(0),m_processor(0),m_thread(0),m_error(){}
+	~PartScanner()
+	{
+		join();
+	}
+
+	void start( const char* src_, std::size_t size_, PageProcessor* processor_)
+	{
+		m_src = src_;
+		m_size = size_;
+		m_processor = processor_;
+		if (m_thread) throw std::runtime_error("start called twice");
+		m_thread = new strus::thread( &PartScanner::run, this);
+	}
+	void join()
+	{
+		if (m_thread)
+		{
+			m_thread->join();
+			delete m_thread;
+			m_thread = 0;
+		}
+	}
+	const std::string& error() const
+	{
+		return m_error;
+	}
+
+	void run()
+	{
+		try
+		{
+			textwolf::SrcIterator inputiterator( m_src, m_size);
+			scanDump( inputiterator, *m_processor, m_src);
+		}
+		catch (const std::bad_alloc&)
+		{
+			m_error = "out of memory scanning input";
+		}
+		catch (const std::runtime_error& err)
+		{
+			m_error = err.what();
+		}
+	}
+
+private:
+	const char* m_src;
+	std::size_t m_size;
+	PageProcessor* m_processor;
+	strus::thread* m_thread;
+	std::string m_error;
+};
+
+/// \brief Scan the parts of a memory mapped input with one thread per part
+static void scanDumpParts( const strus::MemoryMappedFile& input, const std::vector<std::size_t>& splitpos, std::vector<PageProcessor>& processors)
+{
+	struct PartScannerArray
+	{
+		PartScannerArray( PartScanner* ar_)
+			:ar(ar_){}
+		~PartScannerArray()
+		{
+			delete [] ar;
+		}
+		PartScanner* ar;
+	};
+	std::size_t nofParts = splitpos.size();
+	PartScannerArray scanners( new PartScanner[ nofParts]);
+	std::size_t pi = 0;
+	for (; pi < nofParts; ++pi)
+	{
+		std::size_t end = (pi+1 == nofParts) ? input.size() : splitpos[ pi+1];
+		scanners.ar[ pi].start( input.ptr() + splitpos[ pi], end - splitpos[ pi], &processors[ pi]);
+		if (g_doTest)
+		{
+			//... the parts are scanned one after the other, so that the test output is in the order of a serial run
+			scanners.ar[ pi].join();
+		}
+	}
+	for (pi = 0; pi < nofParts; ++pi)
+	{
+		scanners.ar[ pi].join();
+	}
+	for (pi = 0; pi < nofParts; ++pi)
+	{
+		if (!scanners.ar[ pi].error().empty()) throw std::runtime_error( scanners.ar[ pi].error());
+	}
+}
+
+/// \brief Scan a memory mapped input split into parts at <page> tags in parallel
+/// \note A first pass counts the documents in each part, so that the numbering of the documents is the same as in a serial run
+/// \return the number of documents processed
+static int scanDumpParallel( const strus::MemoryMappedFile& input, const PageProcessor& processor, int nofParts)
+{
+	std::vector<std::size_t> splitpos = getInputSplitPositions( input.ptr(), input.size(), nofParts);
+	if (g_verbosity >= 1) std::cerr << strus::string_format( "scanning input in %d parts\n", (int)splitpos.size()) << std::flush;
+
+	std::vector<PageProcessor> counters;
+	std::size_t pi = 0;
+	for (; pi < splitpos.size(); ++pi)
+	{
+		counters.push_back( PageProcessor( processor, 0, true/*count only*/));
+	}
+	scanDumpParts( input, splitpos, counters);
+
+	std::vector<PageProcessor> processors;
+	int docCounterBase = 0;
+	for (pi = 0; pi < splitpos.size(); ++pi)
+	{
+		processors.push_back( PageProcessor( processor, docCounterBase, false/*count only*/));
+		if (docCounterBase % 1000 != 0 && !g_dumpStdout && !g_doTest)
+		{
+			//... the part may write its first documents before the preceeding part created the directory
+			createOutputDir( docCounterBase);
+		}
+		docCounterBase += counters[ pi].docCounter();
+	}
+	scanDumpParts( input, splitpos, processors);
+	return processors.back().docCounter();
+}
+
+/// \brief Get the default patterns of suspicious text reported in the .wtf files with the patterns of a file added (option --wtf)
+static std::vector<std::string> loadStrangeFeaturePatterns( const std::string& filename)
+{
+	std::vector<std::string> rt = strus::DocumentStructure::defaultStrangeFeaturePatterns();
+	std::string content;
+	int ec = strus::readFile( filename, content);
+	if (ec) throw std::runtime_error( strus::string_format( "error reading file %s: %s", filename.c_str(), std::strerror(ec)));
+	std::string::const_iterator ci = content.begin(), ce = content.end();
+	while (ci != ce)
+	{
+		std::string::const_iterator start = ci;
+		for (; ci != ce && *ci != '\n'; ++ci){}
+		std::string::const_iterator end = ci;
+		if (end != start && *(end-1) == '\r') --end;
+		if (end != start) rt.push_back( std::string( start, end));
+		if (ci != ce) ++ci;
+	}
+	return rt;
+}
+
+/// \brief Resolve the page links of a document converted with page links deferred (option --onepass) and write the links not resolved to its .mis file
+static void patchConvertedDocument( const strus::LinkMap& linkmap, int fileCounter, const std::string& docid)
+{
+	std::string filename( getWorkFilePath( fileCounter, docid, ".xml"));
+	std::string content;
+	int ec = strus::readFile( filename, content);
+	if (ec)
+	{
+		std::cerr << "error reading file " << filename << ": " << std::strerror(ec) << std::endl;
+		return;
+	}
+	std::set<std::string> unresolved;
+	if (strus::patchPageLinks( content, linkmap, unresolved))
+	{
+		ec = strus::writeFile( filename, content);
+		if (ec) std::cerr << "error writing file " << filename << ": " << std::strerror(ec) << std::endl;
+	}
+	if (!unresolved.empty())
+	{
+		writeUnresolvedFile( fileCounter, docid, std::vector<std::string>( unresolved.begin(), unresolved.end()));
+	}
+}
+
+/// \brief Resolve the page links of the documents in a shard written with page links deferred (option --onepass with --shards)
+/// \note The patched documents and their .mis files are appended to the shard, replacing the documents written before
+static void patchOutputShard( const strus::LinkMap& linkmap, strus::OutputShardWriter& shard)
+{
+	shard.flush();
+	strus::OutputShardReader reader( shard.path());
+	std::vector<strus::OutputShardReader::Entry>::const_iterator ei = reader.entries().begin(), ee = reader.entries().end();
+	for (; ei != ee; ++ei)
+	{
+		if (ei->name.size() < 4 || 0!=std::strcmp( ei->name.c_str() + ei->name.size() - 4, ".xml")) continue;
+
+		std::string content( reader.content( *ei), ei->size);
+		std::set<std::string> unresolved;
+		if (strus::patchPageLinks( content, linkmap, unresolved))
+		{
+			shard.write( ei->name, content);
+		}
+		if (!unresolved.empty() && g_diagnosticsSummary)
+		{
+			g_diagnosticsSummary->addUnresolved( unresolved.size());
+		}
+		else if (!unresolved.empty())
+		{
+			std::ostringstream unresolvedtext;
+			std::set<std::string>::const_iterator ui = unresolved.begin(), ue = unresolved.end();
+			for (int uidx=1; ui != ue; ++ui,++uidx)
+			{
+				unresolvedtext << "[" << uidx << "] " << *ui << "\n";
+			}
+			shard.write( std::string( ei->name, 0, ei->name.size() - 4) + ".mis", unresolvedtext.str());
+		}
+	}
+}
+
+/// \brief Thread resolving the page links of a part of the documents converted with page links deferred (option --onepass)
+/// \note A task is a document written to a file or a shard with all its documents
+class LinkPatcher
+{
+public:
+	LinkPatcher()
+		:m_linkmap(0),m_nofTasks(0),m_start(0),m_step(1),m_thread(0){}
+	~LinkPatcher()
 	{
-		bool do_sleep;
-		{
-			strus::unique_lock lock( m_queue_mutex);
-			m_queue.push( Work( filecounter, title, content, m_writeDumpsAlways));
-			do_sleep = (m_queue.size() > MaxQueueSize);
-			m_cv.notify_all();
-		}
-		if (do_sleep) strus::usleep( 100);
+		join();
 	}
-	void terminate()
+
+	void start( const strus::LinkMap* linkmap_, std::size_t nofTasks_, std::size_t start_, std::size_t step_)
 	{
-		m_terminated.set( true);
-		m_cv.notify_all();
+		m_linkmap = linkmap_;
+		m_nofTasks = nofTasks_;
+		m_start = start_;
+		m_step = step_;
+		if (m_thread) throw std::runtime_error("start called twice");
+		m_thread = new strus::thread( &LinkPatcher::run, this);
 	}
-	void waitTermination()
+	void join()
 	{
 		if (m_thread)
 		{
-			m_eof.set( true);
-			m_cv.notify_all();
 			m_thread->join();
 			delete m_thread;
 			m_thread = 0;
-			if (g_verbosity >= 1) std::cerr << strus::string_format( "thread %d terminated\n", m_threadid) << std::flush;
-		}
-	}
-	void waitSignal()
-	{
-		strus::unique_lock lock( m_cv_mutex);
-		m_cv.wait( lock);
-	}
-	bool fetch( Work& work)
-	{
-		strus::unique_lock lock( m_queue_mutex);
-		if (m_queue.empty())
-		{
-			if (m_eof.test())
-			{
-				m_terminated.set( true);
-			}
-			return false;
-		}
-		else
-		{
-			work = m_queue.front();
-			m_queue.pop();
-			return true;
 		}
 	}
 
 	void run()
 	{
-		if (g_verbosity >= 1) std::cerr << strus::string_format( "thread %d started\n", m_threadid) << std::flush;
-		while (!m_terminated.test())
+		std::size_t ti = m_start;
+		for (; ti < m_nofTasks; ti += m_step)
 		{
-			std::string title;
 			try
 			{
-				waitSignal();
-				Work work;
-				while (fetch( work))
+				if (g_outputShards)
+				{
+					patchOutputShard( *m_linkmap, (*g_outputShards)[ ti]);
+				}
+				else
 				{
-					title = work.title();
-					if (g_verbosity >= 1) std::cerr << strus::string_format( "thread %d process document '%s'\n", m_threadid, title.c_str()) << std::flush;
-					work.process();
+					patchConvertedDocument( *m_linkmap, g_convertedDocs[ ti].first, g_convertedDocs[ ti].second);
 				}
 			}
 			catch (const std::bad_alloc&)
 			{
-				std::cerr << "out of memory processing document " << title << std::endl;
+				std::cerr << "out of memory patching page links" << std::endl;
 			}
 			catch (const std::runtime_error& err)
 			{
-				std::cerr << "error processing document " << title << ": " << err.what() << std::endl;
+				std::cerr << "error patching page links: " << err.what() << std::endl;
 			}
 		}
 	}
-	void start( int threadid_)
-	{
-		m_threadid = threadid_;
-		if (m_thread) throw std::runtime_error("start called twice");
-		m_thread = new strus::thread( &Worker::run, this);
-	}
 
 private:
-	strus::condition_variable m_cv;
-	strus::mutex m_cv_mutex;
-	strus::mutex m_queue_mutex;
-	std::queue<Work> m_queue;
+	const strus::LinkMap* m_linkmap;
+	std::size_t m_nofTasks;
+	std::size_t m_start;
+	std::size_t m_step;
 	strus::thread* m_thread;
-	int m_threadid;
-	strus::AtomicFlag m_terminated;
-	strus::AtomicFlag m_eof;
-	bool m_writeDumpsAlways;
 };
 
-class IStream
-	:public textwolf::IStream
+/// \brief Resolve the page links of all documents converted with page links deferred (option --onepass) with one thread per conversion thread
+/// \return the number of tasks (documents or shards) processed
+static std::size_t patchConvertedDocuments( const strus::LinkMap& linkmap, int nofThreads)
 {
-public:
-	explicit IStream( const std::string& docpath)
-		:m_impl(docpath)
+	struct LinkPatcherArray
 	{
-		int ec = m_impl.error();
-		if (ec) throw std::runtime_error( strus::string_format("failed to read input file '%s': %s", docpath.c_str(), ::strerror(ec)));
+		LinkPatcherArray( LinkPatcher* ar_)
+			:ar(ar_){}
+		~LinkPatcherArray()
+		{
+			delete [] ar;
+		}
+		LinkPatcher* ar;
+	};
+	std::size_t nofTasks = g_outputShards ? g_outputShards->size() : g_convertedDocs.size();
+	if (nofThreads < 1) nofThreads = 1;
+	LinkPatcherArray patchers( new LinkPatcher[ nofThreads]);
+	int ti = 0;
+	for (; ti < nofThreads; ++ti)
+	{
+		patchers.ar[ ti].start( &linkmap, nofTasks, ti, nofThreads);
 	}
-	virtual ~IStream(){}
-
-	virtual std::size_t read( void* buf, std::size_t bufsize)
+	for (ti = 0; ti < nofThreads; ++ti)
 	{
-		return m_impl.read( (char*)buf, bufsize);
+		patchers.ar[ ti].join();
 	}
+	return nofTasks;
+}
 
-	virtual int errorcode() const
+/// \brief Resolve the page links of the documents in the output of a test (option --test with --onepass)
+/// \note The .mis section of a document is inserted after its .wtf and .err sections, as written by writeOutputFiles
+static void patchTestOutput( const strus::LinkMap& linkmap)
+{
+	std::string output;
+	std::size_t pos = 0;
+	while (pos < g_testOutput.size())
 	{
-		return m_impl.error();
-	}
+		// ... a section starts with a line "## <filename>" and ends with an empty line before the next section
+		std::size_t next = g_testOutput.find( "\n\n## ", pos);
+		next = (next == std::string::npos) ? g_testOutput.size() : next + 2;
+		std::string section( g_testOutput, pos, next - pos);
+		pos = next;
 
-private:
-	strus::InputStream m_impl;
-};
+		std::size_t eoln = section.find( '\n');
+		std::string filename( section, 3, eoln == std::string::npos ? std::string::npos : eoln - 3);
+		if (filename.size() < 4 || 0!=std::strcmp( filename.c_str() + filename.size() - 4, ".xml"))
+		{
+			output.append( section);
+			continue;
+		}
+		std::set<std::string> unresolved;
+		strus::patchPageLinks( section, linkmap, unresolved);
+		output.append( section);
 
-static int getUIntOptionArg( int argi, int argc, const char* argv[])
+		std::string basename( filename, 0, filename.size() - 4);
+		while (pos < g_testOutput.size())
+		{
+			std::size_t lineend = g_testOutput.find( '\n', pos);
+			std::string nextname( g_testOutput, pos + 3, lineend == std::string::npos ? std::string::npos : lineend - pos - 3);
+			if (nextname != basename + ".wtf" && nextname != basename + ".err") break;
+			next = g_testOutput.find( "\n\n## ", pos);
+			next = (next == std::string::npos) ? g_testOutput.size() : next + 2;
+			output.append( g_testOutput, pos, next - pos);
+			pos = next;
+		}
+		if (!unresolved.empty() && g_diagnosticsSummary)
+		{
+			g_diagnosticsSummary->addUnresolved( unresolved.size());
+		}
+		else if (!unresolved.empty())
+		{
+			output.append( "## " + basename + ".mis\n");
+			std::set<std::string>::const_iterator ui = unresolved.begin(), ue = unresolved.end();
+			for (int uidx=1; ui != ue; ++ui,++uidx)
+			{
+				output.append( strus::string_format( "[%d] %s\n", uidx, ui->c_str()));
+			}
+			output.append( "\n\n");
+		}
+	}
+	g_testOutput.swap( output);
+}
+
+/// \brief Write a list of links not resolved by the link map builder (option -R) to a file or to the output of the test or stdout
+static void writeLinkList( const char* section, const char* description, const std::vector<const char*>& links, const std::string& filename)
 {
-	if (argv[argi+1])
+	if (links.empty()) return;
+	std::string linksstr;
+	std::vector<const char*>::const_iterator li = links.begin(), le = links.end();
+	for (; li != le; ++li)
 	{
-		return strus::numstring_conv::touint( argv[argi+1], std::numeric_limits<int>::max());
+		linksstr.append( *li);
+		linksstr.push_back( '\n');
+	}
+	if (g_dumpStdout)
+	{
+		std::cout << "## " << section << std::endl << linksstr << std::endl << std::endl;
+	}
+	else if (g_doTest)
+	{
+		std::ostringstream out;
+		out << "## " << section << std::endl << linksstr << std::endl << std::endl;
+		g_testOutput.append( out.str());
 	}
 	else
 	{
-		throw std::runtime_error( std::string("no argument given for option ") + argv[argi]);
+		int ec = strus::writeFile( filename, linksstr);
+		if (ec)
+		{
+			std::cerr << "error writing " << description << " file: " << std::strerror(ec) << std::endl;
+		}
+		else
+		{
+			std::cerr << description << " written to " << filename << std::endl;
+		}
 	}
 }
 
-enum TagId {TagIgnored,TagPage,TagNs,TagTitle,TagText,TagRedirect};
-
-
 int main( int argc, const char* argv[])
 {
 	int rt = 0;
@@ -821,12 +1688,27 @@ int main( int argc, const char* argv[])
 	{
 		int argi = 1;
 		int nofThreads = 0;
+		int queueCapacityMB = 256;
 		int counterMod = 0;
 		std::set<int> namespacemap;
 		bool namespaceset = false;
 		bool printusage = false;
 		bool collectRedirects = false;
 		bool loadRedirects = false;
+		bool useMmap = false;
+		bool textLinkMap = false;
+		bool onePass = false;
+		int nofShards = 0;
+		int nofWriterThreads = 0;
+		bool syncFiles = false;
+		int nofDecompressThreads = 0;
+		int nofSplitParts = 0;
+		std::string indexfilename;
+		std::string wtfPatternsFilename;
+		std::string summaryFilename;
+		std::string statisticsFilename;
+		std::string statusFilename;
+		int statusInterval = 10;
 		std::string linkmapfilename;
 		std::string dumpfilename;
 		std::vector<std::string> selectDocumentPattern;
@@ -904,6 +1786,92 @@ int main( int argc, const char* argv[])
 				nofThreads = getUIntOptionArg( argi, argc, argv);
 				++argi;
 			}
+			else if (0==std::memcmp(argv[argi],"-Q",2))
+			{
+				queueCapacityMB = getUIntOptionArg( argi, argc, argv);
+				if (!queueCapacityMB) throw std::runtime_error( "option -Q requires positive integer as argument");
+				++argi;
+			}
+			else if (0==std::memcmp(argv[argi],"-W",2))
+			{
+				nofWriterThreads = getUIntOptionArg( argi, argc, argv);
+				++argi;
+			}
+			else if (0==std::strcmp(argv[argi],"--fsync"))
+			{
+				syncFiles = true;
+			}
+			else if (0==std::memcmp(argv[argi],"-Z",2))
+			{
+				nofDecompressThreads = getUIntOptionArg( argi, argc, argv);
+				if (!nofDecompressThreads) throw std::runtime_error( "option -Z requires positive integer as argument");
+				++argi;
+			}
+			else if (0==std::strcmp(argv[argi],"--index"))
+			{
+				if (!indexfilename.empty()) throw std::runtime_error( "duplicated option --index <indexfile>");
+				++argi;
+				if (argi == argc || (argv[argi][0] == '-' && argv[argi][1] != '\0')) throw std::runtime_error( "option --index without argument");
+				indexfilename = argv[ argi];
+			}
+			else if (0==std::strcmp(argv[argi],"--wtf"))
+			{
+				if (!wtfPatternsFilename.empty()) throw std::runtime_error( "duplicated option --wtf <patternfile>");
+				++argi;
+				if (argi == argc || (argv[argi][0] == '-' && argv[argi][1] != '\0')) throw std::runtime_error( "option --wtf without argument");
+				wtfPatternsFilename = argv[ argi];
+			}
+			else if (0==std::strcmp(argv[argi],"--production"))
+			{
+				if (!summaryFilename.empty()) throw std::runtime_error( "duplicated option --production <summaryfile>");
+				++argi;
+				if (argi == argc || (argv[argi][0] == '-' && argv[argi][1] != '\0')) throw std::runtime_error( "option --production without argument");
+				summaryFilename = argv[ argi];
+			}
+			else if (0==std::strcmp(argv[argi],"--stats"))
+			{
+				if (!statisticsFilename.empty()) throw std::runtime_error( "duplicated option --stats <statsfile>");
+				++argi;
+				if (argi == argc || (argv[argi][0] == '-' && argv[argi][1] != '\0')) throw std::runtime_error( "option --stats without argument");
+				statisticsFilename = argv[ argi];
+			}
+			else if (0==std::strcmp(argv[argi],"--status"))
+			{
+				if (!statusFilename.empty()) throw std::runtime_error( "duplicated option --status <statusfile>");
+				++argi;
+				if (argi == argc || (argv[argi][0] == '-' && argv[argi][1] != '\0')) throw std::runtime_error( "option --status without argument");
+				statusFilename = argv[ argi];
+			}
+			else if (0==std::strcmp(argv[argi],"--status-interval"))
+			{
+				statusInterval = getUIntOptionArg( argi, argc, argv);
+				if (!statusInterval) throw std::runtime_error( "option --status-interval requires positive integer as argument");
+				++argi;
+			}
+			else if (0==std::strcmp(argv[argi],"--split"))
+			{
+				nofSplitParts = getUIntOptionArg( argi, argc, argv);
+				if (!nofSplitParts) throw std::runtime_error( "option --split requires positive integer as argument");
+				++argi;
+			}
+			else if (0==std::strcmp(argv[argi],"--shards"))
+			{
+				nofShards = getUIntOptionArg( argi, argc, argv);
+				if (!nofShards) throw std::runtime_error( "option --shards requires positive integer as argument");
+				++argi;
+			}
+			else if (0==std::strcmp(argv[argi],"--mmap"))
+			{
+				useMmap = true;
+			}
+			else if (0==std::strcmp(argv[argi],"--textlinks"))
+			{
+				textLinkMap = true;
+			}
+			else if (0==std::strcmp(argv[argi],"--onepass"))
+			{
+				onePass = true;
+			}
 			else if (0==std::strcmp(argv[argi],"--stdout"))
 			{
 				g_dumpStdout = true;
@@ -942,6 +1910,7 @@ int main( int argc, const char* argv[])
 		{
 			std::cerr << "Usage: strusWikimediaToXml [options] <inputfile> [<outputdir>]" << std::endl;
 			std::cerr << "<inputfile>   :File to process or '-' for stdin" << std::endl;
+			std::cerr << "               Files compressed with bzip2 or zstd are decompressed" << std::endl;
 			std::cerr << "<outputdir>   :Directory where output files and directories are written to." << std::endl;
 			std::cerr << "options:" << std::endl;
 			std::cerr << "    -h           :Print this usage" << std::endl;
@@ -955,11 +1924,65 @@ int main( int argc, const char* argv[])
 			std::cerr << "    -t <threads> :Number of conversion threads to use is <threads>" << std::endl;
 			std::cerr << "                  Total number of threads is <threads> +1" << std::endl;
 			std::cerr << "                  (conversion threads + main thread)" << std::endl;
+			std::cerr << "                  Documents are distributed with work stealing, the busy" << std::endl;
+			std::cerr << "                  and idle time of each thread is printed at the end." << std::endl;
+			std::cerr << "    -Q <mb>      :Limit the content of documents queued for conversion" << std::endl;
+			std::cerr << "                  threads and of files queued for writer threads (option -W)" << std::endl;
+			std::cerr << "                  to <mb> megabytes each (default 256)" << std::endl;
+			std::cerr << "    -W <threads> :Write the output files asynchronously with <threads> writer" << std::endl;
+			std::cerr << "                  threads in batches, instead of writing them in the" << std::endl;
+			std::cerr << "                  conversion threads (default 0)" << std::endl;
+			std::cerr << "    --fsync      :Synchronize the files written by the writer threads of" << std::endl;
+			std::cerr << "                  option -W to disk, together for the files of a batch" << std::endl;
 			std::cerr << "    -n <ns>      :Reduce output to namespace <ns> (0=article)" << std::endl;
 			std::cerr << "    -I           :Produce one 'id' attribute per table cell reference," << std::endl;
 			std::cerr << "                  instead of one with the ids separated by commas (e.g. id='C1,R2')." << std::endl;
 			std::cerr << "    -R <lnkfile> :Collect redirects only and write them to <lnkfile>" << std::endl;
-			std::cerr << "    -L <lnkfile> :Load link file <lnkfile> for verifying page links" << std::endl;
+			std::cerr << "                  in the binary format mapped into memory by option -L" << std::endl;
+			std::cerr << "                  Redirects are resolved by <threads> threads of option -t." << std::endl;
+			std::cerr << "                  Links not resolved are written to <lnkfile>.mis, links" << std::endl;
+			std::cerr << "                  leading into a cycle of redirects to <lnkfile>.cyc and" << std::endl;
+			std::cerr << "                  links with too long chains of redirects to <lnkfile>.dep" << std::endl;
+			std::cerr << "    --textlinks  :Write the link file of option -R as text, a line with" << std::endl;
+			std::cerr << "                  the key and the value separated by a tab per link" << std::endl;
+			std::cerr << "    --onepass    :Convert the documents while collecting the redirects with" << std::endl;
+			std::cerr << "                  option -R, instead of running a second pass with option -L" << std::endl;
+			std::cerr << "                  The page links in the output are resolved at the end" << std::endl;
+			std::cerr << "    -L <lnkfile> :Load link file <lnkfile> (binary or text) for verifying page links" << std::endl;
+			std::cerr << "    -Z <threads> :Number of threads for decompressing the input in parallel" << std::endl;
+			std::cerr << "                  (default: number of conversion threads or 1)" << std::endl;
+			std::cerr << "    --index <idx>:Index file <idx> of a bzip2 multistream input file for" << std::endl;
+			std::cerr << "                  decompressing it in parallel (plain or bzip2 compressed)" << std::endl;
+			std::cerr << "    --mmap       :Map the input file into memory instead of reading it" << std::endl;
+			std::cerr << "                  through a stream buffer (not for input from stdin)" << std::endl;
+			std::cerr << "    --split <n>  :Split the input into <n> parts at page boundaries and scan" << std::endl;
+			std::cerr << "                  them in parallel (requires option --mmap)" << std::endl;
+			std::cerr << "                  The document numbering is the same as in a serial run" << std::endl;
+			std::cerr << "    --shards <n> :Append the output files to <n> container files (shards)" << std::endl;
+			std::cerr << "                  in <outputdir> instead of writing a file per output file" << std::endl;
+			std::cerr << "                  A shard consists of a data file shard<i>.dat and an index" << std::endl;
+			std::cerr << "                  file shard<i>.idx, read with the program readOutputShards" << std::endl;
+			std::cerr << "    --wtf <file> :Load additional patterns of suspicious text reported in the" << std::endl;
+			std::cerr << "                  .wtf files from <file> (one pattern per line)" << std::endl;
+			std::cerr << "    --production <file>" << std::endl;
+			std::cerr << "                 :Write only the .xml files and no diagnostic files (.wtf," << std::endl;
+			std::cerr << "                  .err, .mis, .ftl, .org, .txt). The diagnostics are counted" << std::endl;
+			std::cerr << "                  and written as summary to <file> at the end" << std::endl;
+			std::cerr << "    --stats <file>" << std::endl;
+			std::cerr << "                 :Measure the time of the stages of the conversion (XML scan," << std::endl;
+			std::cerr << "                  lexer, parser, finish, toxml, output, diagnostics and the" << std::endl;
+			std::cerr << "                  waiting for the queue) in every thread and write it at the" << std::endl;
+			std::cerr << "                  end as JSON to <file>, together with the bytes scanned, read" << std::endl;
+			std::cerr << "                  and written, the lexems per second and the slowest documents" << std::endl;
+			std::cerr << "                  The time of a stage is summed up over all threads" << std::endl;
+			std::cerr << "    --status <file>" << std::endl;
+			std::cerr << "                 :Rewrite the status file <file> periodically while running" << std::endl;
+			std::cerr << "                  with the progress as JSON: bytes of input consumed, documents" << std::endl;
+			std::cerr << "                  and megabytes per second, estimated time to completion," << std::endl;
+			std::cerr << "                  documents queued per conversion thread, documents in" << std::endl;
+			std::cerr << "                  conversion and resident memory (RSS) of the process" << std::endl;
+			std::cerr << "    --status-interval <sec>" << std::endl;
+			std::cerr << "                 :Seconds between two updates of the status file (default 10)" << std::endl;
 			std::cerr << "    --stdout     :Write all output to stdout" << std::endl;
 			std::cerr << "    --test <EXP> :Write all output to a string and compare it with the content" << std::endl;
 			std::cerr << "                  of the file <EXP> (single threaded only)" << std::endl;
@@ -1019,26 +2042,100 @@ int main( int argc, const char* argv[])
 			std::cerr << std::endl;
 			return rt;
 		}
-		IStream input( argv[argi]);
+		std::string inputfilename( argv[argi]);
+		strus::CompressionType compression = strus::CompressionNone;
+		if (inputfilename != "-")
+		{
+			compression = strus::getFileCompressionType( inputfilename);
+		}
+		if (compression == strus::CompressionNone && !indexfilename.empty())
+		{
+			throw std::runtime_error( "option --index requires a bzip2 compressed input file");
+		}
+		strus::local_ptr<strus::MemoryMappedFile> mappedInput;
+		if (useMmap)
+		{
+			if (inputfilename == "-") throw std::runtime_error( "option --mmap cannot be used with input from stdin");
+			if (compression != strus::CompressionNone) throw std::runtime_error( "option --mmap cannot be used with compressed input");
+			mappedInput.reset( new strus::MemoryMappedFile( inputfilename));
+		}
 		if (argi+1 < argc)
 		{
-			if (collectRedirects) std::cerr << "output directory ignored if option -R is specified" << std::endl;
+			if (collectRedirects && !onePass) std::cerr << "output directory ignored if option -R is specified without option --onepass" << std::endl;
 			g_outputdir = argv[argi+1];
 		}
+		//... the link map is built with the threads requested also in a test, its result does not depend on the order of the documents processed
+		int nofLinkMapThreads = nofThreads;
 		if (g_doTest)
 		{
-			if (nofThreads != 0) std::cerr << "number of threads (option -t) ignored if option --test is specified" << std::endl;
+			if (nofThreads != 0) std::cerr << "number of threads (option -t) ignored for the conversion if option --test is specified" << std::endl;
 			nofThreads = 0;
 		}
+		if (nofSplitParts > 1 && !useMmap) throw std::runtime_error( "option --split requires option --mmap");
+		if (onePass)
+		{
+			if (!collectRedirects) throw std::runtime_error( "option --onepass requires option -R <lnkfile>");
+			if (g_dumpStdout) throw std::runtime_error( "option --onepass cannot be used with option --stdout");
+			if (g_outputdir.empty() && !g_doTest) throw std::runtime_error( "option --onepass requires an output directory");
+			g_deferLinks = true;
+		}
+		if (nofShards)
+		{
+			if (g_dumpStdout || g_doTest) throw std::runtime_error( "option --shards cannot be used with option --stdout or --test");
+			if (g_outputdir.empty()) throw std::runtime_error( "option --shards requires an output directory");
+			if (collectRedirects && !onePass) std::cerr << "writing shards (option --shards) ignored if option -R is specified without option --onepass" << std::endl;
+		}
 		if (collectRedirects)
 		{
-			if (nofThreads != 0) std::cerr << "number of threads (option -t) ignored if option -R is specified" << std::endl;
-			if (g_beautified) std::cerr << "beautyfication (option -B) ignored if option -R is specified" << std::endl;
-			if (g_dumps) std::cerr << "write dumps allways (option -D) ignored if option -R is specified" << std::endl;
+			if (g_beautified && !onePass) std::cerr << "beautyfication (option -B) ignored if option -R is specified without option --onepass" << std::endl;
+			if (g_dumps && !onePass) std::cerr << "write dumps allways (option -D) ignored if option -R is specified without option --onepass" << std::endl;
 			if (loadRedirects) std::cerr << "option -L not compatiple with option -R" << std::endl;
+			if (!summaryFilename.empty() && !onePass)
+			{
+				std::cerr << "production mode (option --production) ignored if option -R is specified without option --onepass" << std::endl;
+				summaryFilename.clear();
+			}
+			if (nofSplitParts > 1) std::cerr << "splitting the input (option --split) ignored if option -R is specified" << std::endl;
+			nofSplitParts = 0;
 		}
-		textwolf::IStreamIterator inputiterator( &input, 1<<16/*buffer size*/);
+		if (g_dumps && !summaryFilename.empty()) throw std::runtime_error( "option -D not compatible with option --production");
 		if (nofThreads <= 0) nofThreads = 0;
+		if (nofWriterThreads && (g_dumpStdout || g_doTest || nofShards || (collectRedirects && !onePass)))
+		{
+			std::cerr << "writer threads (option -W) ignored if there are no output files written" << std::endl;
+			nofWriterThreads = 0;
+		}
+		if (syncFiles && !nofWriterThreads) std::cerr << "synchronizing files (option --fsync) ignored without writer threads (option -W)" << std::endl;
+		strus::local_ptr<strus::AsyncFileWriter> fileWriter;
+		if (nofWriterThreads)
+		{
+			fileWriter.reset( new strus::AsyncFileWriter( nofWriterThreads, (std::size_t)queueCapacityMB << 20, syncFiles));
+			g_fileWriter = fileWriter.get();
+		}
+		strus::local_ptr<strus::MultiPatternMatcher> strangeFeatureMatcher;
+		if (!wtfPatternsFilename.empty())
+		{
+			strangeFeatureMatcher.reset( new strus::MultiPatternMatcher( loadStrangeFeaturePatterns( wtfPatternsFilename)));
+			g_strangeFeatureMatcher = strangeFeatureMatcher.get();
+		}
+		strus::local_ptr<DiagnosticsSummary> diagnosticsSummary;
+		if (!summaryFilename.empty())
+		{
+			diagnosticsSummary.reset( new DiagnosticsSummary());
+			g_diagnosticsSummary = diagnosticsSummary.get();
+		}
+		strus::local_ptr<strus::ConversionStatistics> statistics;
+		if (!statisticsFilename.empty())
+		{
+			statistics.reset( new strus::ConversionStatistics( 20/*number of slowest documents reported*/));
+			g_statistics = statistics.get();
+		}
+		strus::local_ptr<strus::OutputShardSet> outputShards;
+		if (nofShards && (!collectRedirects || onePass))
+		{
+			outputShards.reset( new strus::OutputShardSet( g_outputdir, nofShards));
+			g_outputShards = outputShards.get();
+		}
 		g_errorhnd = strus::createErrorBuffer_standard( NULL/*logfilehandle*/, nofThreads+2, NULL/*debugTrace*/);
 		if (!g_errorhnd) throw std::runtime_error("failed to create error buffer");
 
@@ -1064,254 +2161,80 @@ int main( int argc, const char* argv[])
 			}
 			Worker* ar;
 		};
+		strus::local_ptr<WorkScheduler> scheduler( nofThreads ? new WorkScheduler( nofThreads, (std::size_t)queueCapacityMB << 20) : 0);
+		strus::local_ptr<ConversionProgress> progress;
+		strus::local_ptr<strus::StatusFileWriter> statusFileWriter;
+		if (!statusFilename.empty())
+		{
+			std::size_t inputSize = 0;
+			if (inputfilename == "-" || 0 != strus::readFileSize( inputfilename, inputSize)) inputSize = 0;
+			progress.reset( new ConversionProgress( scheduler.get(), inputSize));
+			g_progress = progress.get();
+			statusFileWriter.reset( new strus::StatusFileWriter( statusFilename, statusInterval, g_progress));
+			statusFileWriter->start();
+		}
 		WorkerArray workers( nofThreads ? new Worker[ nofThreads] : 0);
 		for (int wi=0; wi < nofThreads; ++wi)
 		{
-			workers.ar[ wi].start( wi+1);
+			workers.ar[ wi].start( scheduler.get(), wi+1);
 		}
 
-		bool terminated = false;
-		struct DocAttributes
+		PageProcessor processor( scheduler.get(), collectRedirects ? &linkmapBuilder : NULL, onePass, namespacemap, namespaceset, selectDocumentPattern, dumpfilename, counterMod);
+		int docCounter;
+		if (mappedInput.get() && nofSplitParts > 1)
 		{
-			int ns;
-			std::string title;
-			std::string redirect_title;
-			std::string content;
-
-			DocAttributes()
-				:ns(0),title(),redirect_title(){}
-			void clear()
+			docCounter = scanDumpParallel( *mappedInput, processor, nofSplitParts);
+		}
+		else if (mappedInput.get())
+		{
+			textwolf::SrcIterator inputiterator( mappedInput->ptr(), mappedInput->size());
+			scanDump( inputiterator, processor, mappedInput->ptr());
+			docCounter = processor.docCounter();
+		}
+		else if (compression != strus::CompressionNone)
+		{
+			if (!nofDecompressThreads) nofDecompressThreads = nofThreads ? nofThreads : 1;
+			strus::DecompressingInputStream input( inputfilename, indexfilename, nofDecompressThreads);
+			if (g_verbosity >= 1 && input.parallel()) std::cerr << strus::string_format( "decompressing %d blocks of input with %d threads\n", (int)input.nofBlocks(), nofDecompressThreads) << std::flush;
+			textwolf::IStreamIterator inputiterator( &input, 1<<16/*buffer size*/);
+			if (g_progress) g_progress->setCompressedInput( &input);
+			try
 			{
-				ns = 0;
-				title.clear();
-				redirect_title.clear();
-				content.clear();
+				scanDump( inputiterator, processor, NULL);
 			}
-		};
-
-		XmlScanner xs( inputiterator);
-		XmlScanner::iterator itr=xs.begin(),end=xs.end();
-		DocAttributes docAttributes;
-		int workeridx = 0;
-		int docCounter = 0;
-		TagId lastTag = TagIgnored;
-		std::vector<TagId> tagstack;
-
-		for (; !terminated && itr!=end; ++itr)
-		{
-			if (g_verbosity >= 2) std::cout << "XML " << itr->name() << " " << strus::outputLineString( itr->content(), itr->content()+itr->size(), 80) << std::endl;
-			switch (itr->type())
+			catch (...)
 			{
-				case XmlScanner::None: break;
-				case XmlScanner::ErrorOccurred: throw std::runtime_error( "xml error");
-				case XmlScanner::HeaderStart:/*no break!*/
-				case XmlScanner::HeaderAttribName:/*no break!*/
-				case XmlScanner::HeaderAttribValue:/*no break!*/
-				case XmlScanner::HeaderEnd:/*no break!*/
-				case XmlScanner::DocAttribValue:/*no break!*/
-				case XmlScanner::DocAttribEnd:/*no break!*/
-					break;
-				case XmlScanner::TagAttribName:
-				{
-					if (lastTag == TagRedirect)
-					{
-						if (itr->size() == 5 && 0==std::memcmp( itr->content(), "title", itr->size()))
-						{
-							++itr;
-							if (itr->type() == XmlScanner::TagAttribValue)
-							{
-								docAttributes.redirect_title = std::string( itr->content(), itr->size());
-							}
-						}
-					}
-					break;
-				}
-				case XmlScanner::TagAttribValue:
-				{
-					break;
-				}
-				case XmlScanner::OpenTag: 
-				{
-					lastTag = TagIgnored;
-					if (namespaceset && itr->size() == 2  && 0==std::memcmp( itr->content(), "ns", itr->size()))
-					{
-						lastTag = TagNs;
-					}
-					else if (itr->size() == 4 && 0==std::memcmp( itr->content(), "page", itr->size()))
-					{
-						lastTag = TagPage;
-						docAttributes.clear();
-						if (docCounter % 1000 == 0 && !collectRedirects && !g_dumpStdout && !g_doTest)
-						{
-							createOutputDir( docCounter);
-						}
-					}
-					else if (itr->size() == 5 && 0==std::memcmp( itr->content(), "title", itr->size()))
-					{
-						lastTag = TagTitle;
-					}
-					if (itr->size() == 4 && 0==std::memcmp( itr->content(), "text", itr->size()))
-					{
-						lastTag = TagText;
-					}
-					if (itr->size() == 8 && 0==std::memcmp( itr->content(), "redirect", itr->size()))
-					{
-						lastTag = TagRedirect;
-					}
-					tagstack.push_back( lastTag);
-					break;
-				}
-				case XmlScanner::CloseTagIm:
-				case XmlScanner::CloseTag:
-				{
-					lastTag = TagIgnored;
-					TagId closedTag = TagIgnored;
-					if (!tagstack.empty())
-					{
-						closedTag = tagstack.back();
-						tagstack.pop_back();
-					}
-					if (closedTag == TagPage)
-					{
-						if (namespaceset && namespacemap.find( docAttributes.ns) == namespacemap.end())
-						{
-							//... ignore document but those with ns set to what is selected by option '-n'
-							continue;
-						}
-						if (!selectDocumentPattern.empty())
-						{
-							std::vector<std::string>::const_iterator si = selectDocumentPattern.begin(), se = selectDocumentPattern.end();
-							for (; si != se && 0==std::strstr( docAttributes.title.c_str(), si->c_str()); ++si){}
-							if (si == se) continue;
-						}
-						if (!docAttributes.redirect_title.empty() && docAttributes.content.size() < 1000)
-						{
-							// ... is as Redirect
-							if (collectRedirects)
-							{
-								++docCounter;
-								std::pair<std::string,std::string> redir_parts = strus::LinkMap::getLinkParts( docAttributes.redirect_title);
-								if (g_verbosity >= 1) std::cerr << strus::string_format( "%s => %s\n", docAttributes.title.c_str(), docAttributes.redirect_title.c_str());
-								linkmapBuilder.redirect( docAttributes.title, redir_parts.first);
-
-								if (counterMod && g_verbosity == 0 && docCounter % counterMod == 0)
-								{
-									std::cerr << "processed " << docCounter << " documents" << std::endl;
-								}
-							}
-						}
-						else if (!docAttributes.title.empty() && !docAttributes.content.empty())
-						{
-							// ... is as Document
-							if (collectRedirects)
-							{
-								++docCounter;
-								if (g_verbosity >= 1) std::cerr << strus::string_format( "link %s => %s\n", docAttributes.title.c_str(), docAttributes.title.c_str());
-								linkmapBuilder.define( docAttributes.title);
-
-								if (counterMod && g_verbosity == 0 && docCounter % counterMod == 0)
-								{
-									std::cerr << "processed " << docCounter << " documents" << std::endl;
-								}
-							}
-							else
-							{
-								if (!dumpfilename.empty())
-								{
-									int ec = strus::writeFile( dumpfilename, docAttributes.content);
-									if (ec) std::cerr << "failed to write dump file " << dumpfilename << ": " << ::strerror(ec) << std::endl;
-								}
-								++docCounter;
-								int docIndex = docCounter-1;
-								if (nofThreads)
-								{
-									workeridx = docIndex % nofThreads;
-									workers.ar[ workeridx].push( docIndex, docAttributes.title, docAttributes.content);
-								}
-								else
-								{
-									try
-									{
-										Work work( docIndex, docAttributes.title, docAttributes.content, g_dumps);
-										if (g_verbosity >= 1) std::cerr << strus::string_format( "process document '%s'\n", docAttributes.title.c_str()) << std::flush;
-										work.process();
-									} 
-									catch (const std::bad_alloc&)
-									{
-										std::cerr << "out of memory processing document " << docAttributes.title << std::endl;
-									}
-									catch (const std::runtime_error& err)
-									{
-										std::cerr << "error processing document " << docAttributes.title << ": " << err.what() << std::endl;
-									}
-								}
-								if (counterMod && g_verbosity == 0 && docCounter % counterMod == 0)
-								{
-									std::cerr << "processed " << docCounter << " documents" << std::endl;
-								}
-							}
-						}
-						else if (docAttributes.content.empty())
-						{
-							std::cerr << "empty document '" << docAttributes.title << "'" << std::endl;
-						}
-						else
-						{
-							std::cerr << "invalid document '" << docAttributes.title << "'" << std::endl;
-						}
-					}
-					break;
-				}
-				case XmlScanner::Content:
-					switch (lastTag)
-					{
-						case TagIgnored:
-							break;
-						case TagPage:
-							break;
-						case TagNs:
-						{
-							std::string contentstr( itr->content(), itr->size());
-							docAttributes.ns = strus::numstring_conv::toint( contentstr, 10000);
-							break;
-						}
-						case TagTitle:
-						{
-							docAttributes.title = std::string( itr->content(), itr->size());
-							break;
-						}
-						case TagText:
-						{
-							docAttributes.content = std::string( itr->content(), itr->size());
-							break;
-						}
-						case TagRedirect:
-						{
-							docAttributes.redirect_title = std::string( itr->content(), itr->size());
-							break;
-						}
-					}
-					break;
-				case XmlScanner::Exit:
-					terminated = true;
-					break;
+				if (g_progress) g_progress->releaseCompressedInput();
+				throw;
 			}
+			if (g_progress) g_progress->releaseCompressedInput();
+			docCounter = processor.docCounter();
+		}
+		else
+		{
+			IStream input( inputfilename);
+			textwolf::IStreamIterator inputiterator( &input, 1<<16/*buffer size*/);
+			scanDump( inputiterator, processor, NULL);
+			docCounter = processor.docCounter();
 		}
 		for (int wi=0; wi < nofThreads; ++wi)
 		{
 			workers.ar[ wi].waitTermination();
 		}
+		for (int wi=0; wi < nofThreads; ++wi)
+		{
+			std::cerr << workers.ar[ wi].statistics() << std::endl;
+		}
 		if (g_verbosity == 0)
 		{
 			std::cerr << "processed " << docCounter << " documents" << std::endl;
 		}
 		if (collectRedirects)
 		{
-			std::string unresolved_outfilename = linkmapfilename + ".mis";
 			{
 				linkmap.reset( new strus::LinkMap( g_errorhnd));
 				if (!linkmap.get()) throw std::runtime_error("failed to create link map");
-				linkmapBuilder.build( *linkmap);
+				linkmapBuilder.build( *linkmap, nofLinkMapThreads);
 				if (g_dumpStdout || g_doTest)
 				{
 					if (g_dumpStdout)
@@ -1331,48 +2254,65 @@ int main( int argc, const char* argv[])
 				}
 				else
 				{
-					linkmap->write( linkmapfilename);
-					std::cerr << "links written to " << linkmapfilename << std::endl;
-				}
-			}{
-				std::string unresolvedstr;
-				std::vector<const char*> unresolved( linkmapBuilder.unresolved());
-				if (!unresolved.empty())
-				{
-					std::vector<const char*>::const_iterator ui = unresolved.begin(), ue = unresolved.end();
-					for (; ui != ue; ++ui)
-					{
-						unresolvedstr.append( *ui);
-						unresolvedstr.push_back( '\n');
-					}
-					if (g_dumpStdout || g_doTest)
+					if (textLinkMap)
 					{
-						if (g_dumpStdout)
-						{
-							std::cout << "## UNRESOLVED" << std::endl << unresolvedstr << std::endl << std::endl;
-						}
-						else
-						{
-							std::ostringstream out;
-							out << "## UNRESOLVED" << std::endl << unresolvedstr << std::endl << std::endl;
-							g_testOutput.append( out.str());
-						}
+						linkmap->write( linkmapfilename);
 					}
 					else
 					{
-						int ec = strus::writeFile( unresolved_outfilename, unresolvedstr);
-						if (ec)
-						{
-							std::cerr << "error writing unresolved links file: " << std::strerror(ec) << std::endl;
-						}
-						else
-						{
-							std::cerr << "unresolved links written to " << unresolved_outfilename << std::endl;
-						}
+						linkmap->writeBinary( linkmapfilename);
 					}
+					std::cerr << "links written to " << linkmapfilename << std::endl;
+				}
+			}
+			writeLinkList( "UNRESOLVED", "unresolved links", linkmapBuilder.unresolved(), linkmapfilename + ".mis");
+			writeLinkList( "CYCLES", "links leading into a cycle of redirects", linkmapBuilder.cycles(), linkmapfilename + ".cyc");
+			writeLinkList( "DEPTH EXCEEDED", "links with too long chains of redirects", linkmapBuilder.depthExceeded(), linkmapfilename + ".dep");
+			if (onePass)
+			{
+				if (g_fileWriter)
+				{
+					//... the documents to patch have to be written completely
+					g_fileWriter->flush();
+				}
+				if (g_doTest)
+				{
+					patchTestOutput( *linkmap);
+				}
+				else
+				{
+					std::size_t nofPatched = patchConvertedDocuments( *linkmap, nofThreads);
+					std::cerr << "page links of " << nofPatched << (g_outputShards ? " shards" : " documents") << " resolved" << std::endl;
 				}
 			}
 		}
+		if (g_fileWriter)
+		{
+			g_fileWriter->close();
+			std::cerr << g_fileWriter->statistics() << std::flush;
+		}
+		if (g_outputShards)
+		{
+			g_outputShards->close();
+			std::cerr << "output written to " << g_outputShards->size() << " shards in " << g_outputdir << std::endl;
+		}
+		if (g_diagnosticsSummary)
+		{
+			int ec = strus::writeFile( summaryFilename, g_diagnosticsSummary->tostring());
+			if (ec) throw std::runtime_error( strus::string_format( "error writing file %s: %s", summaryFilename.c_str(), std::strerror(ec)));
+			std::cerr << "summary of the diagnostics written to " << summaryFilename << std::endl;
+		}
+		if (statusFileWriter.get())
+		{
+			statusFileWriter->stop();
+			std::cerr << "status of the conversion written to " << statusFileWriter->filename() << std::endl;
+		}
+		if (g_statistics)
+		{
+			int ec = strus::writeFile( statisticsFilename, g_statistics->tojson());
+			if (ec) throw std::runtime_error( strus::string_format( "error writing file %s: %s", statisticsFilename.c_str(), std::strerror(ec)));
+			std::cerr << "statistics of the conversion written to " << statisticsFilename << std::endl;
+		}
 		if (g_doTest)
 		{
 			std::string expected;
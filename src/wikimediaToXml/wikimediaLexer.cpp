@@ -21,6 +21,10 @@
 #include <cstdio>
 #include <cstdarg>
 #include <limits>
+#include <stdint.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 /// \brief strus toplevel namespace
 using namespace strus;
@@ -1130,9 +1134,31 @@ bool WikimediaLexer::eatFollowChar( char expectChr)
 	return false;
 }
 
-static void parseAttributes( char const*& si, char const* se, char endMarker, char altEndMarker, std::map<std::string,std::string>& attributes)
+static std::vector<WikimediaLexem::Attribute>::iterator findAttribute( std::vector<WikimediaLexem::Attribute>::iterator ai, const std::vector<WikimediaLexem::Attribute>::iterator& ae, const StringRef& name)
+{
+	for (; ai != ae && ai->name != name; ++ai){}
+	return ai;
+}
+
+static void setAttribute( StringArena& arena, std::vector<WikimediaLexem::Attribute>& attributes, std::size_t base, const std::string& name, const std::string& value)
+{
+	std::vector<WikimediaLexem::Attribute>::iterator ai = findAttribute( attributes.begin() + base, attributes.end(), name);
+	if (ai == attributes.end())
+	{
+		attributes.push_back( WikimediaLexem::Attribute( arena.copy( name.c_str(), name.size()), arena.copy( value.c_str(), value.size())));
+	}
+	else
+	{
+		ai->value = arena.copy( value.c_str(), value.size());
+	}
+}
+
+/// \brief Parse attributes and append them to a list, an attribute defined twice gets the last value
+/// \note All attributes parsed are removed, if the parsing fails
+static void parseAttributes( char const*& si, char const* se, char endMarker, char altEndMarker, StringArena& arena, std::vector<WikimediaLexem::Attribute>& attributes)
 {
 	const char* start = si;
+	std::size_t base = attributes.size();
 	si = skipSpaces( si, se);
 	if (si == se || *si == endMarker || *si == altEndMarker) return;
 
@@ -1146,7 +1172,7 @@ static void parseAttributes( char const*& si, char const* se, char endMarker, ch
 		{
 			if (parseString( value, si, se, false/*tolerant*/))
 			{
-				attributes[ name] = value;
+				setAttribute( arena, attributes, base, name, value);
 				si = skipSpacesAndComments( si, se);
 				if (si == se || *si == endMarker || *si == altEndMarker) return;
 			}
@@ -1180,7 +1206,7 @@ static void parseAttributes( char const*& si, char const* se, char endMarker, ch
 				{
 					goto REWIND;
 				}
-				attributes[ name] = value;
+				setAttribute( arena, attributes, base, name, value);
 	
 				si = skipSpacesAndComments( si, se);
 				if (si == se || *si == endMarker || *si == altEndMarker) return;
@@ -1194,7 +1220,7 @@ static void parseAttributes( char const*& si, char const* se, char endMarker, ch
 	return;
 
 REWIND:
-	attributes.clear();
+	attributes.erase( attributes.begin() + base, attributes.end());
 	si = start;
 }
 
@@ -1250,14 +1276,157 @@ static bool compareFollowString( const char* si, const char* se, const char* str
 	return *xi == '\0';
 }
 
+#if defined(__SSE2__)
+/// \brief Bit masks of the character classes of a window of 64 bytes, bit i for byte i
+struct PlainTextMasks
+{
+	uint64_t special;	///< markup characters, digits, 'A' and 'I' (ISBN,ASIN) and non ASCII bytes
+	uint64_t hex;		///< hexadecimal digits
+	uint64_t ident;		///< characters of the identifier classes of charClassChangeCount
+	uint64_t alpha;		///< ASCII letters
+	uint64_t urlpath;	///< characters with isUrlPathChar or >= 127
+	uint64_t dash;		///< dash '-'
+	uint32_t rep;		///< bit i set if byte i and byte i+1 are equal to the bytes at the same distance 1, 2 or 3 after them
+};
+
+static inline uint64_t movemask64( __m128i m0, __m128i m1, __m128i m2, __m128i m3)
+{
+	return (uint64_t)(uint16_t)_mm_movemask_epi8( m0)
+		| ((uint64_t)(uint16_t)_mm_movemask_epi8( m1) << 16)
+		| ((uint64_t)(uint16_t)_mm_movemask_epi8( m2) << 32)
+		| ((uint64_t)(uint16_t)_mm_movemask_epi8( m3) << 48);
+}
+
+static inline __m128i inRange( __m128i ch, char lo, char hi)
+{
+	return _mm_and_si128( _mm_cmpgt_epi8( ch, _mm_set1_epi8( lo-1)), _mm_cmplt_epi8( ch, _mm_set1_epi8( hi+1)));
+}
+
+static inline __m128i equal( __m128i ch, char cmp)
+{
+	return _mm_cmpeq_epi8( ch, _mm_set1_epi8( cmp));
+}
+
+struct PlainTextChunkMasks
+{
+	__m128i special;
+	__m128i hex;
+	__m128i ident;
+	__m128i alpha;
+	__m128i urlpath;
+	__m128i dash;
+
+	explicit PlainTextChunkMasks( const char* si)
+	{
+		__m128i ch = _mm_loadu_si128( (const __m128i*)si);
+		__m128i lower = _mm_or_si128( ch, _mm_set1_epi8( 32));
+		__m128i high = _mm_cmplt_epi8( ch, _mm_setzero_si128());
+		__m128i digit = inRange( ch, '0', '9');
+		alpha = inRange( lower, 'a', 'z');
+		hex = _mm_or_si128( digit, inRange( lower, 'a', 'f'));
+		dash = equal( ch, '-');
+		special = _mm_or_si128( _mm_or_si128( _mm_or_si128( high, digit), _mm_or_si128( equal( ch, '='), equal( ch, '<'))),
+				_mm_or_si128( _mm_or_si128( equal( ch, '"'), equal( ch, '&')), _mm_or_si128( equal( ch, '#'), equal( ch, '\''))));
+		special = _mm_or_si128( special,
+				_mm_or_si128( _mm_or_si128( _mm_or_si128( equal( ch, '['), equal( ch, '{')), _mm_or_si128( equal( ch, '|'), equal( ch, '!'))),
+				_mm_or_si128( _mm_or_si128( equal( ch, '\n'), equal( ch, '}')), _mm_or_si128( equal( ch, ']'), equal( ch, ':')))));
+		special = _mm_or_si128( special, _mm_or_si128( equal( ch, '/'), _mm_or_si128( equal( ch, 'A'), equal( ch, 'I'))));
+		ident = _mm_or_si128( _mm_or_si128( alpha, digit), _mm_or_si128( high, equal( ch, '_')));
+		__m128i urlchr = _mm_or_si128( _mm_or_si128( _mm_or_si128( equal( ch, '/'), equal( ch, '%')), _mm_or_si128( equal( ch, '#'), equal( ch, '?'))),
+				_mm_or_si128( _mm_or_si128( equal( ch, '+'), equal( ch, '&')), _mm_or_si128( equal( ch, '='), equal( ch, '.'))));
+		urlchr = _mm_or_si128( urlchr, _mm_or_si128( _mm_or_si128( equal( ch, ';'), equal( ch, ',')), equal( ch, 127)));
+		urlpath = _mm_or_si128( _mm_or_si128( ident, dash), urlchr);
+	}
+};
+
+static inline uint32_t repMask( const char* si, int dist)
+{
+	__m128i e0 = _mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i*)si), _mm_loadu_si128( (const __m128i*)(si+dist)));
+	__m128i e1 = _mm_cmpeq_epi8( _mm_loadu_si128( (const __m128i*)(si+16)), _mm_loadu_si128( (const __m128i*)(si+16+dist)));
+	uint32_t eq = (uint32_t)(uint16_t)_mm_movemask_epi8( e0) | ((uint32_t)(uint16_t)_mm_movemask_epi8( e1) << 16);
+	return eq & (eq >> 1);
+}
+
+static void getPlainTextMasks( PlainTextMasks& res, const char* si)
+{
+	PlainTextChunkMasks c0( si), c1( si+16), c2( si+32), c3( si+48);
+	res.special = movemask64( c0.special, c1.special, c2.special, c3.special);
+	res.hex = movemask64( c0.hex, c1.hex, c2.hex, c3.hex);
+	res.ident = movemask64( c0.ident, c1.ident, c2.ident, c3.ident);
+	res.alpha = movemask64( c0.alpha, c1.alpha, c2.alpha, c3.alpha);
+	res.urlpath = movemask64( c0.urlpath, c1.urlpath, c2.urlpath, c3.urlpath);
+	res.dash = movemask64( c0.dash, c1.dash, c2.dash, c3.dash);
+	res.rep = repMask( si, 1) | repMask( si, 2) | repMask( si, 3);
+}
+
+/// \brief Get the positions in a window of 16 bytes, where WikimediaLexer::next() may do more than adding the byte to the current text
+/// \note The conditions are necessary conditions of all branches in WikimediaLexer::next() that do not just skip the byte
+/// \param[in] si start of the window, with 64 bytes readable from si and the byte before si readable
+/// \return bit i set for byte si[i]
+static unsigned int getPlainTextStops( const char* si)
+{
+	PlainTextMasks mk;
+	getPlainTextMasks( mk, si);
+	uint64_t rt = mk.special;
+	//... isBigHexNumCandidate: at least 7 hex digits following
+	rt |= (mk.hex >> 1) & (mk.hex >> 2) & (mk.hex >> 3) & (mk.hex >> 4) & (mk.hex >> 5) & (mk.hex >> 6) & (mk.hex >> 7);
+	//... isCodeCandidate: 12 characters of identifier classes
+	uint64_t id2 = mk.ident & (mk.ident >> 1);
+	uint64_t id4 = id2 & (id2 >> 2);
+	uint64_t id8 = id4 & (id4 >> 4);
+	rt |= id8 & (id4 >> 8);
+	//... isBibRefCandidate: hex digit with a dash at a distance less than twice the hex run length (run length < 8, otherwise isBigHexNumCandidate)
+	if ((mk.dash >> 1) & (((uint64_t)1 << 30) - 1)) rt |= mk.hex;
+	//... repPatternCandidateLength: repeating characters
+	rt |= mk.rep;
+	//... tryParsePlainURL at the start of a word
+	uint64_t prevUrlPath = ((unsigned char)si[-1] >= 127 || isUrlPathChar( si[-1])) ? 1:0;
+	rt |= mk.alpha & ~((mk.urlpath << 1) | prevUrlPath);
+	return (unsigned int)(rt & 0xffff);
+}
+
+const char* WikimediaLexer::skipPlainText( const char* si)
+{
+	for (;;)
+	{
+		if (si < m_plainTextWindow || si >= m_plainTextWindow + 16)
+		{
+			if (m_se - si < 64 + 4) return si;
+			m_plainTextWindow = si;
+			m_plainTextStops = getPlainTextStops( si);
+		}
+		unsigned int stops = m_plainTextStops >> (si - m_plainTextWindow);
+		if (stops)
+		{
+			while (!(stops & 1)) {stops >>= 1; ++si;}
+			return si;
+		}
+		si = m_plainTextWindow + 16;
+	}
+}
+#else
+const char* WikimediaLexer::skipPlainText( const char* si)
+{
+	//... without SSE2 every byte is inspected by the main loop of next()
+	return si;
+}
+#endif
+
 WikimediaLexem WikimediaLexer::next()
 {
+	m_arena.reset();
+	m_attributes.clear();
 	m_prev_si = m_si;
 	const char* start = m_si;
 	try
 	{
 	while (m_si < m_se)
 	{
+		if (m_si != start)
+		{
+			//... skip bytes that are just added to the current text
+			m_si = skipPlainText( m_si);
+		}
 		if ((unsigned char)*m_si >= 128)
 		{
 			int chlen = strus::utf8charlen( *m_si);
@@ -1267,7 +1436,7 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, m_si - start));
 			}
 			int tcnt = countAndSkip( m_si, m_se, '=', 7);
 			if (tcnt == m_curHeading)
@@ -1284,7 +1453,7 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, m_si - start));
 			}
 			if (m_si+8 < m_se && (0==std::memcmp( m_si, "<http://", 8) || 0==std::memcmp( m_si, "<https://", 9)))
 			{
@@ -1295,11 +1464,11 @@ WikimediaLexem WikimediaLexer::next()
 				{
 					std::string url( start+1, m_si-(start+1));
 					++m_si;
-					return WikimediaLexem( WikimediaLexem::Url, 0, url);
+					return WikimediaLexem( WikimediaLexem::Url, 0, stringValue( url));
 				}
 				else
 				{
-					return WikimediaLexem( WikimediaLexem::Error, 0, std::string("unknown tag ") + outputLineString( m_si-1, m_se, 40));
+					return WikimediaLexem( WikimediaLexem::Error, 0, stringValue( std::string("unknown tag ") + outputLineString( m_si-1, m_se, 40)));
 				}
 			}
 			if (m_si+1 < m_se && (isAlpha( m_si[1]) || m_si[1] == '/' || m_si[1] == '!'))
@@ -1307,56 +1476,56 @@ WikimediaLexem WikimediaLexer::next()
 				switch (parseTagType( m_si, m_se))
 				{
 					case UnknwownTagType:
-						return WikimediaLexem( WikimediaLexem::Error, 0, std::string("unknown tag ") + outputLineString( m_si-1, m_se, 40));
+						return WikimediaLexem( WikimediaLexem::Error, 0, stringValue( std::string("unknown tag ") + outputLineString( m_si-1, m_se, 40)));
 					case TagNoWikiOpen:
-						return WikimediaLexem( WikimediaLexem::NoWiki, 0, parseTagContent( "nowiki", m_si, m_se));
+						return WikimediaLexem( WikimediaLexem::NoWiki, 0, stringValue( parseTagContent( "nowiki", m_si, m_se)));
 					case TagNoWikiClose:
 						start = m_si;
 						break;
 					case TagTimestampOpen:
-						return WikimediaLexem( WikimediaLexem::Timestamp, 0, parseTagContent( "timestamp", m_si, m_se));
+						return WikimediaLexem( WikimediaLexem::Timestamp, 0, stringValue( parseTagContent( "timestamp", m_si, m_se)));
 					case TagTimestampClose:
 						start = m_si;
 						break;
 					case TagCodeOpen:
-						return WikimediaLexem( WikimediaLexem::NoWiki, 0, parseTagContent( "code", m_si, m_se));
+						return WikimediaLexem( WikimediaLexem::NoWiki, 0, stringValue( parseTagContent( "code", m_si, m_se)));
 					case TagCodeClose:
 						start = m_si;
 						break;
 					case TagVarOpen:
-						return WikimediaLexem( WikimediaLexem::NoWiki, 0, parseTagContent( "var", m_si, m_se));
+						return WikimediaLexem( WikimediaLexem::NoWiki, 0, stringValue( parseTagContent( "var", m_si, m_se)));
 					case TagVarClose:
 						start = m_si;
 						break;
 					case TagTtOpen:
-						return WikimediaLexem( WikimediaLexem::NoWiki, 0, parseTagContent( "tt", m_si, m_se));
+						return WikimediaLexem( WikimediaLexem::NoWiki, 0, stringValue( parseTagContent( "tt", m_si, m_se)));
 					case TagTtClose:
 						start = m_si;
 						break;
 					case TagSourceOpen:
-						return WikimediaLexem( WikimediaLexem::NoWiki, 0, parseTagContent( "source", m_si, m_se));
+						return WikimediaLexem( WikimediaLexem::NoWiki, 0, stringValue( parseTagContent( "source", m_si, m_se)));
 					case TagSourceClose:
 						start = m_si;
 						break;
 					case TagSyntaxHighlightOpen:
-						return WikimediaLexem( WikimediaLexem::NoWiki, 0, parseTagContent( "syntaxhighlight", m_si, m_se));
+						return WikimediaLexem( WikimediaLexem::NoWiki, 0, stringValue( parseTagContent( "syntaxhighlight", m_si, m_se)));
 					case TagSyntaxHighlightClose:
 						start = m_si;
 						break;
 					case TagMathOpen:
-						return WikimediaLexem( WikimediaLexem::Math, 0, parseTagContent( "math", m_si, m_se));
+						return WikimediaLexem( WikimediaLexem::Math, 0, stringValue( parseTagContent( "math", m_si, m_se)));
 					case TagMathClose:
 						break;
 					case TagChemOpen:
-						return WikimediaLexem( WikimediaLexem::Math, 0, parseTagContent( "chem", m_si, m_se));
+						return WikimediaLexem( WikimediaLexem::Math, 0, stringValue( parseTagContent( "chem", m_si, m_se)));
 					case TagChemClose:
 						break;
 					case TagSupOpen:
-						return WikimediaLexem( WikimediaLexem::Math, 0, parseTagContent( "sup", m_si, m_se));
+						return WikimediaLexem( WikimediaLexem::Math, 0, stringValue( parseTagContent( "sup", m_si, m_se)));
 					case TagSupClose:
 						break;
 					case TagSubOpen:
-						return WikimediaLexem( WikimediaLexem::Math, 0, parseTagContent( "sub", m_si, m_se));
+						return WikimediaLexem( WikimediaLexem::Math, 0, stringValue( parseTagContent( "sub", m_si, m_se)));
 					case TagSubClose:
 						break;
 					case TagGalleryOpen:
@@ -1466,7 +1635,7 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, m_si - start));
 			}
 			char eb = *m_si;
 			m_si += 1;
@@ -1479,11 +1648,11 @@ WikimediaLexem WikimediaLexer::next()
 				m_si = xi+1;
 				if (charClassChangeCount( value.c_str(), value.c_str() + value.size()) >= 4)
 				{
-					return WikimediaLexem( WikimediaLexem::Code, 0, value);
+					return WikimediaLexem( WikimediaLexem::Code, 0, stringValue( value));
 				}
 				else
 				{
-					return WikimediaLexem( WikimediaLexem::String, 0, value);
+					return WikimediaLexem( WikimediaLexem::String, 0, stringValue( value));
 				}
 			}
 			else
@@ -1495,7 +1664,7 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, m_si - start));
 			}
 			m_si += 6;
 			return WikimediaLexem( WikimediaLexem::QuotationMarker);
@@ -1513,16 +1682,16 @@ WikimediaLexem WikimediaLexer::next()
 				{
 					if (start != m_si)
 					{
-						return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+						return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, m_si - start));
 					}
 					m_si = si;
-					return WikimediaLexem( WikimediaLexem::Text, 0, entity_cnv);
+					return WikimediaLexem( WikimediaLexem::Text, 0, stringValue( entity_cnv));
 				}
 				else
 				{
 					if (start != m_si)
 					{
-						return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+						return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, m_si - start));
 					}
 					m_si = si;
 					return WikimediaLexem( WikimediaLexem::Text, 0, "-"/*unknown entity translated to a dash*/);
@@ -1534,7 +1703,7 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, m_si - start));
 			}
 			if (compareFollowString( m_si, m_se, "#REDIRECT"))
 			{
@@ -1550,7 +1719,7 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, m_si - start));
 			}
 			int sidx = 0;
 			if (m_si[2] == ']')
@@ -1563,13 +1732,13 @@ WikimediaLexem WikimediaLexer::next()
 					const char* tkstart = m_si+2;
 					int tksize = ci - tkstart;
 					m_si = ci + 2;
-					return WikimediaLexem( WikimediaLexem::Char, 0, std::string( tkstart, tksize));
+					return WikimediaLexem( WikimediaLexem::Char, 0, StringRef( tkstart, tksize));
 				}
 			}
 			for (; m_si < m_se && *m_si == '\''; ++sidx,++m_si){}
 			if (sidx >= 6)
 			{
-				return WikimediaLexem( WikimediaLexem::NoData, 0, std::string(start,sidx));
+				return WikimediaLexem( WikimediaLexem::NoData, 0, StringRef(start,sidx));
 			}
 			return WikimediaLexem( WikimediaLexem::MultiQuoteMarker, sidx, "");
 		}
@@ -1577,7 +1746,7 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, m_si - start));
 			}
 			++m_si;
 			if (m_si == m_se) break;
@@ -1598,7 +1767,7 @@ WikimediaLexem WikimediaLexer::next()
 				{
 					const char* chptr = m_si;
 					m_si += chlen+2;
-					return WikimediaLexem( WikimediaLexem::Char, 0, std::string(chptr,chlen));
+					return WikimediaLexem( WikimediaLexem::Char, 0, StringRef(chptr,chlen));
 				}
 				if (m_si < m_se && *m_si == '#')++m_si;
 				if (m_si < m_se && *m_si == ':')++m_si;
@@ -1606,7 +1775,7 @@ WikimediaLexem WikimediaLexer::next()
 				if (isUrlCandidate( m_si, m_se))
 				{
 					linkid = tryParseURL();
-					return WikimediaLexem( WikimediaLexem::OpenWWWLink, 0, linkid);
+					return WikimediaLexem( WikimediaLexem::OpenWWWLink, 0, stringValue( linkid));
 				}
 				else
 				{
@@ -1624,12 +1793,12 @@ WikimediaLexem WikimediaLexer::next()
 								m_si += 2;
 							}
 						}
-						return WikimediaLexem( WikimediaLexem::Text, 0, linkid);
+						return WikimediaLexem( WikimediaLexem::Text, 0, stringValue( linkid));
 					}
 					else if (!linkid.empty() && m_si < m_se && (*m_si == ']' || *m_si == '|'))
 					{
 						if (*m_si == '|') ++m_si;
-						return WikimediaLexem( WikimediaLexem::OpenPageLink, 0, linkid);
+						return WikimediaLexem( WikimediaLexem::OpenPageLink, 0, stringValue( linkid));
 					}
 					else
 					{
@@ -1670,7 +1839,7 @@ WikimediaLexem WikimediaLexer::next()
 				else if (m_si < m_se && (isTokenDelimiter(*m_si) || isSpace(*m_si)))
 				{
 					if (*m_si == '|') ++m_si;
-					return WikimediaLexem( WikimediaLexem::OpenWWWLink, 0, linkid);
+					return WikimediaLexem( WikimediaLexem::OpenWWWLink, 0, stringValue( linkid));
 				}
 				else
 				{
@@ -1688,7 +1857,7 @@ WikimediaLexem WikimediaLexer::next()
 				{
 					std::string value( m_si, xi-m_si);
 					m_si = ++xi;
-					return WikimediaLexem( WikimediaLexem::Char, 0, value);
+					return WikimediaLexem( WikimediaLexem::Char, 0, stringValue( value));
 				}
 				else
 				{
@@ -1700,7 +1869,7 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, m_si - start));
 			}
 			++m_si;
 			if (m_si == m_se) break;
@@ -1722,7 +1891,7 @@ WikimediaLexem WikimediaLexer::next()
 						{
 							std::string text = strus::string_conv::decodeXmlEntities( std::string( m_si+1, ti-m_si-1));
 							m_si = ti+2;
-							return WikimediaLexem( WikimediaLexem::Text, 0, text);
+							return WikimediaLexem( WikimediaLexem::Text, 0, stringValue( text));
 						}
 					}
 				}
@@ -1732,11 +1901,11 @@ WikimediaLexem WikimediaLexer::next()
 					m_si += 2;
 					if (title.size() > 300)
 					{
-						return WikimediaLexem( WikimediaLexem::Text, 0, title);
+						return WikimediaLexem( WikimediaLexem::Text, 0, stringValue( title));
 					}
 					else
 					{
-						return WikimediaLexem( WikimediaLexem::Markup, 0, title);
+						return WikimediaLexem( WikimediaLexem::Markup, 0, stringValue( title));
 					}
 				}
 				m_si = start;
@@ -1747,7 +1916,7 @@ WikimediaLexem WikimediaLexer::next()
 				if (m_si < m_se && (*m_si == '}' || *m_si == '|'))
 				{
 					std::string citid( strus::string_conv::trim( std::string( start, m_si - start)));
-					return WikimediaLexem( WikimediaLexem::OpenCitation, 0, citid);
+					return WikimediaLexem( WikimediaLexem::OpenCitation, 0, stringValue( citid));
 				}
 				else
 				{
@@ -1762,24 +1931,35 @@ WikimediaLexem WikimediaLexer::next()
 				m_si = skipSpaces( m_si, m_se);
 				if (*m_si == '!') ++m_si;
 
-				std::map<std::string,std::string> attributes;
-				std::map<std::string,std::string> aa;
 				bool more;
 				do
 				{
 					more = false;
-					parseAttributes( m_si, m_se,  '|', '\n', aa);
+					std::size_t base = m_attributes.size();
+					parseAttributes( m_si, m_se, '|', '\n', m_arena, m_attributes);
 					if (m_si < m_se && *m_si == '|') {more=true; ++m_si;}
-					attributes.insert( aa.begin(), aa.end());
+					//... attributes of a previous group are not overwritten
+					std::vector<WikimediaLexem::Attribute>::iterator ai = m_attributes.begin() + base;
+					while (ai != m_attributes.end())
+					{
+						if (findAttribute( m_attributes.begin(), m_attributes.begin() + base, ai->name) != m_attributes.begin() + base)
+						{
+							ai = m_attributes.erase( ai);
+						}
+						else
+						{
+							++ai;
+						}
+					}
 				} while (more);
-				return WikimediaLexem( WikimediaLexem::OpenTable, 0, "", attributes);
+				return attributesLexem( WikimediaLexem::OpenTable, StringRef());
 			}
 		}
 		else if (*m_si == '|')
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, m_si - start));
 			}
 			++m_si;
 			if (m_si == m_se) break;
@@ -1787,35 +1967,33 @@ WikimediaLexem WikimediaLexer::next()
 			if (*m_si == '|')
 			{
 				++m_si;
-				std::map<std::string,std::string> attributes;
-				parseAttributes( m_si, m_se,  '|', '\n', attributes);
+				parseAttributes( m_si, m_se, '|', '\n', m_arena, m_attributes);
 				if (m_si+2 < m_se && m_si[0] == '|' && m_si[1] != '|') ++m_si;
-				return WikimediaLexem( WikimediaLexem::DoubleColDelim, 0, "", attributes);
+				return attributesLexem( WikimediaLexem::DoubleColDelim, StringRef());
 			}
 			else
 			{
 				std::string name = tryParseIdentifier( '=');
-				return WikimediaLexem( WikimediaLexem::ColDelim, 0, name);
+				return WikimediaLexem( WikimediaLexem::ColDelim, 0, stringValue( name));
 			}
 		}
 		else if (*m_si == '!' && m_si+1 < m_se && m_si[1] == '!')
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, m_si - start));
 			}
 			m_si += 2;
-			std::map<std::string,std::string> attributes;
-			parseAttributes( m_si, m_se,  '|', '\n', attributes);
+			parseAttributes( m_si, m_se, '|', '\n', m_arena, m_attributes);
 			if (m_si < m_se && *m_si == '|') ++m_si;
-			return WikimediaLexem( WikimediaLexem::TableHeadDelim, 0, "", attributes);
+			return attributesLexem( WikimediaLexem::TableHeadDelim, StringRef());
 		}
 		else if (*m_si == '\n')
 		{
 			m_curHeading = 0;
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, m_si - start));
 			}
 			if (m_si+1 < m_se && m_si[1] == '\n')
 			{
@@ -1830,10 +2008,9 @@ WikimediaLexem WikimediaLexer::next()
 			else if (*m_si == '!')
 			{
 				++m_si;
-				std::map<std::string,std::string> attributes;
-				parseAttributes( m_si, m_se, '|', '\n', attributes);
+				parseAttributes( m_si, m_se, '|', '\n', m_arena, m_attributes);
 				if (m_si < m_se && *m_si == '|') ++m_si;
-				return WikimediaLexem( WikimediaLexem::TableHeadDelim, 0, "", attributes);
+				return attributesLexem( WikimediaLexem::TableHeadDelim, StringRef());
 			}
 			else if (*m_si == '|')
 			{
@@ -1845,26 +2022,23 @@ WikimediaLexem WikimediaLexer::next()
 					while (m_si < m_se && *m_si == '-') ++m_si;
 					m_si = skipSpaces( m_si, m_se);
 					if (*m_si == '!') ++m_si;
-					std::map<std::string,std::string> attributes;
-					parseAttributes( m_si, m_se,  '|', '\n', attributes);
+					parseAttributes( m_si, m_se, '|', '\n', m_arena, m_attributes);
 					if (m_si < m_se && *m_si == '|') ++m_si;
-					return WikimediaLexem( WikimediaLexem::TableRowDelim, 0, "", attributes);
+					return attributesLexem( WikimediaLexem::TableRowDelim, StringRef());
 				}
 				else if (*m_si == '+')
 				{
 					while (*m_si == '+') ++m_si;
-					std::map<std::string,std::string> attributes;
-					parseAttributes( m_si, m_se,  '|', '\n', attributes);
+					parseAttributes( m_si, m_se, '|', '\n', m_arena, m_attributes);
 					if (m_si < m_se && *m_si == '|') ++m_si;
-					return WikimediaLexem( WikimediaLexem::TableTitle, 0, "", attributes);
+					return attributesLexem( WikimediaLexem::TableTitle, StringRef());
 				}
 				else if (*m_si == '!')
 				{
 					++m_si;
-					std::map<std::string,std::string> attributes;
-					parseAttributes( m_si, m_se, '|', '\n', attributes);
+					parseAttributes( m_si, m_se, '|', '\n', m_arena, m_attributes);
 					if (m_si < m_se && *m_si == '|') ++m_si;
-					return WikimediaLexem( WikimediaLexem::TableHeadDelim, 0, "", attributes);
+					return attributesLexem( WikimediaLexem::TableHeadDelim, StringRef());
 				}
 				else if (*m_si == '}')
 				{
@@ -1886,11 +2060,10 @@ WikimediaLexem WikimediaLexer::next()
 				}
 				else
 				{
-					std::map<std::string,std::string> attributes;
-					parseAttributes( m_si, m_se, '|', '\n', attributes);
+					parseAttributes( m_si, m_se, '|', '\n', m_arena, m_attributes);
 					if (m_si < m_se && *m_si == '|') ++m_si;
 					std::string name = tryParseIdentifier( '=');
-					return WikimediaLexem( WikimediaLexem::TableColDelim, 0, name, attributes);
+					return attributesLexem( WikimediaLexem::TableColDelim, stringValue( name));
 				}
 			}
 			else if (m_si+2 < m_se && m_si[0] == (char)0xE2 && m_si[1] == (char)0x80 && m_si[2] >= (char)0xA2 && m_si[2] <= (char)0xA7)
@@ -1945,7 +2118,7 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, m_si - start));
 			}
 			m_si += 2;
 			return WikimediaLexem( WikimediaLexem::CloseCitation);
@@ -1954,7 +2127,7 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, m_si - start));
 			}
 			++m_si;
 			if (m_si < m_se && *m_si == ']')
@@ -1977,7 +2150,7 @@ WikimediaLexem WikimediaLexer::next()
 					std::string url = tryParseURL();
 					if (!url.empty())
 					{
-						return WikimediaLexem( WikimediaLexem::Url, 0, url);
+						return WikimediaLexem( WikimediaLexem::Url, 0, stringValue( url));
 					}
 					else
 					{
@@ -1988,7 +2161,7 @@ WikimediaLexem WikimediaLexer::next()
 				else
 				{
 					m_si = ti;
-					return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+					return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, m_si - start));
 				}
 			}
 			else
@@ -2001,7 +2174,7 @@ WikimediaLexem WikimediaLexer::next()
 			std::string timestmp( tryParseTimestamp());
 			if (!timestmp.empty())
 			{
-				return WikimediaLexem( WikimediaLexem::Timestamp, 0, timestmp);
+				return WikimediaLexem( WikimediaLexem::Timestamp, 0, stringValue( timestmp));
 			}
 			else
 			{
@@ -2012,12 +2185,12 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, m_si - start));
 			}
 			std::string bibref = tryParseBibRef();
 			if (!bibref.empty())
 			{
-				return WikimediaLexem( WikimediaLexem::BibRef, 0, bibref);
+				return WikimediaLexem( WikimediaLexem::BibRef, 0, stringValue( bibref));
 			}
 			else
 			{
@@ -2028,12 +2201,12 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, m_si - start));
 			}
 			std::string bibref = tryParseBookRef();
 			if (!bibref.empty())
 			{
-				return WikimediaLexem( WikimediaLexem::BibRef, 0, bibref);
+				return WikimediaLexem( WikimediaLexem::BibRef, 0, stringValue( bibref));
 			}
 			else
 			{
@@ -2044,12 +2217,12 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, m_si - start));
 			}
 			std::string bibref = tryParseIsbnRef();
 			if (!bibref.empty())
 			{
-				return WikimediaLexem( WikimediaLexem::BibRef, 0, bibref);
+				return WikimediaLexem( WikimediaLexem::BibRef, 0, stringValue( bibref));
 			}
 			else
 			{
@@ -2060,12 +2233,12 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, m_si - start));
 			}
 			std::string bighexnum = tryParseBigHexNum();
 			if (!bighexnum.empty())
 			{
-				return WikimediaLexem( WikimediaLexem::Code, 0, bighexnum);
+				return WikimediaLexem( WikimediaLexem::Code, 0, stringValue( bighexnum));
 			}
 			else
 			{
@@ -2076,12 +2249,12 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, m_si - start));
 			}
 			std::string code = strus::string_conv::decodeXmlEntities( tryParseCode());
 			if (!code.empty())
 			{
-				return WikimediaLexem( WikimediaLexem::Code, 0, code);
+				return WikimediaLexem( WikimediaLexem::Code, 0, stringValue( code));
 			}
 			else
 			{
@@ -2104,11 +2277,11 @@ WikimediaLexem WikimediaLexer::next()
 				else if (ti > start)
 				{
 					m_si = ti;
-					return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, ti - start));
+					return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, ti - start));
 				}
 				else
 				{
-					return WikimediaLexem( WikimediaLexem::Url, 0, std::string("file:") + filepath);
+					return WikimediaLexem( WikimediaLexem::Url, 0, stringValue( std::string("file:") + filepath));
 				}
 			}
 			else
@@ -2120,14 +2293,14 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, m_si - start));
 			}
 			const char* paramend = skipUrlParameters( m_si, m_se);
 			if (paramend)
 			{
 				const char* paramstart = m_si;
 				m_si = paramend;
-				return WikimediaLexem( WikimediaLexem::NoData, 0, std::string( paramstart, paramend - paramstart));
+				return WikimediaLexem( WikimediaLexem::NoData, 0, StringRef( paramstart, paramend - paramstart));
 			}
 			else
 			{
@@ -2138,12 +2311,12 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, m_si - start));
 			}
 			std::string ptstr = tryParseRepPattern( 16);
 			if (!ptstr.empty())
 			{
-				return WikimediaLexem( WikimediaLexem::NoData, 0, ptstr);
+				return WikimediaLexem( WikimediaLexem::NoData, 0, stringValue( ptstr));
 			}
 			else
 			{
@@ -2154,7 +2327,7 @@ WikimediaLexem WikimediaLexer::next()
 		{
 			if (start != m_si)
 			{
-				return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+				return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, m_si - start));
 			}
 			else
 			{
@@ -2184,7 +2357,7 @@ WikimediaLexem WikimediaLexer::next()
 				}
 				else
 				{
-					return WikimediaLexem( WikimediaLexem::Text, 0, std::string( m_si-3, 3));
+					return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( m_si-3, 3));
 				}
 			}
 		}
@@ -2197,7 +2370,7 @@ WikimediaLexem WikimediaLexer::next()
 					std::string url = tryParsePlainURL();
 					if (!url.empty())
 					{
-						return WikimediaLexem( WikimediaLexem::Url, 0, url);
+						return WikimediaLexem( WikimediaLexem::Url, 0, stringValue( url));
 					}
 				}
 				else if (!isUrlPathChar(*(m_si-1)) && (unsigned char)*(m_si-1) < 127)
@@ -2206,7 +2379,7 @@ WikimediaLexem WikimediaLexer::next()
 					if (!tryParsePlainURL().empty())
 					{
 						m_si = si;
-						return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, si - start));
+						return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, si - start));
 					}
 				}
 			}
@@ -2228,12 +2401,12 @@ WikimediaLexem WikimediaLexer::next()
 		}
 		else
 		{
-			return WikimediaLexem( WikimediaLexem::Error, 0, err.what());
+			return WikimediaLexem( WikimediaLexem::Error, 0, stringValue( err.what()));
 		}
 	}
 	if (start != m_si)
 	{
-		return WikimediaLexem( WikimediaLexem::Text, 0, std::string( start, m_si - start));
+		return WikimediaLexem( WikimediaLexem::Text, 0, StringRef( start, m_si - start));
 	}
 	else
 	{
@@ -2243,7 +2416,8 @@ WikimediaLexem WikimediaLexer::next()
 
 std::string WikimediaLexer::currentSourceExtract( int maxlen) const
 {
-	return outputLineString( m_prev_si, m_si+maxlen, maxlen);
+	const char* end = (m_se - m_si > maxlen) ? (m_si + maxlen) : m_se;
+	return outputLineString( m_prev_si, end, maxlen);
 }
 
 std::string WikimediaLexer::rest() const
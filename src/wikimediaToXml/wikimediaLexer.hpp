@@ -12,9 +12,9 @@
 #define _STRUS_WIKIPEDIA_WIKIMEDIA_LEXER_HPP_INCLUDED
 #include "strus/base/numstring.hpp"
 #include "strus/base/string_conv.hpp"
+#include "stringArena.hpp"
 #include <string>
 #include <vector>
-#include <map>
 #include <utility>
 
 /// \brief strus toplevel namespace
@@ -92,22 +92,38 @@ struct WikimediaLexem
 		};
 		return ar[lexemId];
 	}
-	typedef std::map<std::string,std::string> AttributeMap;
+	struct Attribute
+	{
+		StringRef name;
+		StringRef value;
+
+		Attribute( const StringRef& name_, const StringRef& value_)
+			:name(name_),value(value_){}
+		Attribute( const Attribute& o)
+			:name(o.name),value(o.value){}
+	};
 
-	WikimediaLexem( Id id_, int idx_, const std::string& value_, const AttributeMap& attributes_=AttributeMap())
-		:id(id_),idx(idx_),value(value_),attributes(attributes_){}
+	/// \brief Constructor
+	/// \param[in] value_ reference to the source or to a string allocated by the lexer
+	/// \param[in] attributes_ pointer to the attributes allocated by the lexer
+	/// \param[in] nofAttributes_ number of attributes
+	WikimediaLexem( Id id_, int idx_, const StringRef& value_, const Attribute* attributes_=0, int nofAttributes_=0)
+		:id(id_),idx(idx_),value(value_),attributes(attributes_),nofAttributes(nofAttributes_){}
+	WikimediaLexem( Id id_, int idx_, const char* value_)
+		:id(id_),idx(idx_),value(value_),attributes(0),nofAttributes(0){}
 	WikimediaLexem( Id id_)
-		:id(id_),idx(0),value(),attributes(){}
+		:id(id_),idx(0),value(),attributes(0),nofAttributes(0){}
 	WikimediaLexem( const WikimediaLexem& o)
-		:id(o.id),idx(o.idx),value(o.value),attributes(o.attributes){}
+		:id(o.id),idx(o.idx),value(o.value),attributes(o.attributes),nofAttributes(o.nofAttributes){}
 
-	int attributeToInt( const std::string& name_) const
+	int attributeToInt( const char* name) const
 	{
-		std::string name( string_conv::tolower( name_));
-		AttributeMap::const_iterator ai = attributes.find( name);
-		if (ai == attributes.end()) return 1;
+		const Attribute* ai = attributes;
+		const Attribute* ae = attributes + nofAttributes;
+		for (; ai != ae && ai->name != name; ++ai){}
+		if (ai == ae) return 1;
 		strus::NumParseError err = NumParseOk;
-		int rt = strus::uintFromString( ai->second, 1<<15, err);
+		int rt = strus::uintFromString( ai->value, 1<<15, err);
 		return (err == NumParseOk) ? rt:-1;
 	}
 
@@ -122,8 +138,12 @@ struct WikimediaLexem
 
 	Id id;
 	int idx;
-	std::string value;
-	AttributeMap attributes;
+	StringRef value;			///< value, valid until the next call of WikimediaLexer::next()
+	const Attribute* attributes;		///< attributes, valid until the next call of WikimediaLexer::next()
+	int nofAttributes;
+
+private:
+	WikimediaLexem( Id id_, int idx_, const std::string& value_);	//... value has to be copied into the lexer, use WikimediaLexer::stringValue
 };
 
 class WikimediaLexer
@@ -131,7 +151,7 @@ class WikimediaLexer
 public:
 
 	WikimediaLexer( const char* src, std::size_t size)
-		:m_prev_si(src),m_si(src),m_se(src+size),m_curHeading(0){}
+		:m_prev_si(src),m_si(src),m_se(src+size),m_curHeading(0),m_arena(),m_attributes(),m_plainTextWindow(0),m_plainTextStops(0){}
 
 	WikimediaLexem next();
 	std::string rest() const;
@@ -154,12 +174,25 @@ private:
 	std::string tryParseRepPattern( int minlen);
 	std::string tryParseCode();
 	bool eatFollowChar( char expectChr);
+	const char* skipPlainText( const char* si);
+	StringRef stringValue( const std::string& str)
+	{
+		return m_arena.copy( str.c_str(), str.size());
+	}
+	WikimediaLexem attributesLexem( WikimediaLexem::Id id, const StringRef& value)
+	{
+		return WikimediaLexem( id, 0, value, m_attributes.empty() ? 0 : &m_attributes[0], m_attributes.size());
+	}
 
 private:
 	char const* m_prev_si;
 	char const* m_si;
 	const char* m_se;
 	int m_curHeading;
+	StringArena m_arena;					///< strings of the last lexem not referencing the source
+	std::vector<WikimediaLexem::Attribute> m_attributes;	///< attributes of the last lexem
+	const char* m_plainTextWindow;				///< start of the 16 bytes window of m_plainTextStops
+	unsigned int m_plainTextStops;				///< positions in the window that cannot be skipped as plain text
 };
 
 }//namespace
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Escaping of XML content and attribute values copying the spans not to escape in bulk
+/// \file xmlEscape.cpp
+#include "xmlEscape.hpp"
+#include "textwolf/xmlprinter.hpp"
+#include "textwolf/charset_utf8.hpp"
+#include <cstring>
+#if defined(__SSE2__) && defined(__GNUC__)
+#include <emmintrin.h>
+#define STRUS_XML_ESCAPE_SSE2
+#endif
+
+using namespace strus;
+
+typedef textwolf::XMLPrinter<textwolf::charset::UTF8,textwolf::charset::UTF8,std::string> XmlPrinterBase;
+
+namespace {
+/// \brief Classification of the bytes of the source for one escape mode
+struct EscapeTable
+{
+	enum Class {Copy=0,Escape=1,End=2,Sequence=3,Space=4};
+	enum {MaxSpecial=8};
+
+	unsigned char cls[ 256];		///< class of every byte value
+	const char* str[ 128];			///< substitute of every ASCII character of class Escape
+	unsigned char len[ 128];		///< length of the substitute
+	char special[ MaxSpecial];		///< printable ASCII characters of class Escape, checked in blocks
+	int nofSpecial;
+
+	EscapeTable( const char* echr, const char** estr, bool decodeUtf8, bool controlToSpace)
+		:nofSpecial(0)
+	{
+		std::memset( cls, Copy, sizeof(cls));
+		std::memset( str, 0, sizeof(str));
+		std::memset( len, 0, sizeof(len));
+		std::memset( special, 0, sizeof(special));
+		int ci = 1;
+		if (controlToSpace) for (; ci < 32; ++ci) cls[ ci] = Space;
+		if (decodeUtf8) for (ci = 128; ci < 256; ++ci) cls[ ci] = Sequence;
+		for (int ei=0; echr[ei]; ++ei)
+		{
+			unsigned char ch = echr[ ei];
+			cls[ ch] = Escape;
+			str[ ch] = estr[ ei];
+			len[ ch] = std::strlen( estr[ ei]);
+			if (ch >= 32 && nofSpecial < MaxSpecial) special[ nofSpecial++] = ch;
+		}
+		cls[ 0] = End;
+	}
+};
+}//anonymous namespace
+
+static const char* g_contentEscStr[] = {"&lt;", "&gt;", "&amp;", "&#8;"};
+static const char* g_attributeEscStr[] = {"&lt;", "&gt;", "&apos;", "&quot;", "&amp;", "&#8;", "&#9;", "&#10;", "&#13;"};
+static const char* g_textEscStr[] = {"&quot;", "&amp;", "&lt;", "&gt;"};
+
+static const EscapeTable g_escapeTables[] = {
+	EscapeTable( "<>&\b", g_contentEscStr, true/*decode UTF-8*/, false/*control to space*/),
+	EscapeTable( "<>'\"&\b\t\n\r", g_attributeEscStr, true/*decode UTF-8*/, false/*control to space*/),
+	EscapeTable( "\"&<>", g_textEscStr, false/*decode UTF-8*/, false/*control to space*/),
+	EscapeTable( "\"&<>", g_textEscStr, false/*decode UTF-8*/, true/*control to space*/)
+};
+
+/// \brief Get the length of a UTF-8 sequence the textwolf printer reproduces unchanged
+/// \return the length in bytes or 0 if the sequence is truncated, overlong or not a valid sequence
+static std::size_t regularUtf8SequenceLength( const unsigned char* si, const unsigned char* se)
+{
+	std::size_t rt;
+	if (si[0] < 0xC2) return 0;
+	else if (si[0] < 0xE0) rt = 2;
+	else if (si[0] < 0xF0) rt = 3;
+	else if (si[0] < 0xF8) rt = 4;
+	else return 0;
+	if ((std::size_t)(se - si) < rt) return 0;
+	std::size_t ii = 1;
+	for (; ii < rt; ++ii)
+	{
+		if ((si[ ii] & 0xC0) != 0x80) return 0;
+	}
+	if (si[0] == 0xE0 && si[1] < 0xA0) return 0;
+	if (si[0] == 0xF0 && si[1] < 0x90) return 0;
+	return rt;
+}
+
+/// \brief Print the rest of a source with an irregular UTF-8 sequence with the textwolf printer, that decodes and encodes every character
+static void printIrregular( std::string& buf, const char* src, std::size_t size, XmlEscapeMode mode)
+{
+	XmlPrinterBase printer;
+	if (mode == XmlEscapeContent)
+	{
+		printer.printToBufferContent( src, size, buf);
+	}
+	else
+	{
+		std::string value;
+		printer.printToBufferAttributeValue( src, size, value);
+		buf.append( value.c_str() + 1, value.size() - 2);
+	}
+}
+
+/// \brief Skip the bytes of class Copy
+static const unsigned char* skipCopy( const unsigned char* si, const unsigned char* se, const EscapeTable& table)
+{
+#ifdef STRUS_XML_ESCAPE_SSE2
+	const __m128i lowerbound = _mm_set1_epi8( 0x20);
+	for (;;)
+	{
+		for (; se - si >= 16; si += 16)
+		{
+			//... control characters and bytes with the high bit set are less than 0x20 in a signed comparison
+			__m128i block = _mm_loadu_si128( (const __m128i*)si);
+			__m128i hits = _mm_cmplt_epi8( block, lowerbound);
+			int ci = 0;
+			for (; ci < table.nofSpecial; ++ci)
+			{
+				hits = _mm_or_si128( hits, _mm_cmpeq_epi8( block, _mm_set1_epi8( table.special[ ci])));
+			}
+			int mask = _mm_movemask_epi8( hits);
+			if (mask)
+			{
+				si += __builtin_ctz( mask);
+				break;
+			}
+		}
+		if (se - si < 16) break;
+		if (table.cls[ *si] != EscapeTable::Copy) return si;
+		++si;
+	}
+#endif
+	for (; si != se && table.cls[ *si] == EscapeTable::Copy; ++si){}
+	return si;
+}
+
+void strus::appendXmlEscaped( std::string& buf, const char* src, std::size_t size, XmlEscapeMode mode)
+{
+	const EscapeTable& table = g_escapeTables[ mode];
+	if (buf.capacity() - buf.size() < size)
+	{
+		buf.reserve( buf.size() + size + (size >> 4));
+	}
+	const unsigned char* si = (const unsigned char*)src;
+	const unsigned char* se = si + size;
+	while (si != se)
+	{
+		const unsigned char* start = si;
+		si = skipCopy( si, se, table);
+		if (si != start) buf.append( (const char*)start, si - start);
+		if (si == se) break;
+
+		switch ((EscapeTable::Class)table.cls[ *si])
+		{
+			case EscapeTable::Copy:
+				break;
+			case EscapeTable::Escape:
+				buf.append( table.str[ *si], table.len[ *si]);
+				++si;
+				break;
+			case EscapeTable::End:
+				return;
+			case EscapeTable::Space:
+				buf.push_back( ' ');
+				++si;
+				break;
+			case EscapeTable::Sequence:
+			{
+				std::size_t seqlen = regularUtf8SequenceLength( si, se);
+				if (!seqlen)
+				{
+					printIrregular( buf, (const char*)si, se - si, mode);
+					return;
+				}
+				buf.append( (const char*)si, seqlen);
+				si += seqlen;
+				break;
+			}
+		}
+	}
+}
+
@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2018 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+/// \brief Escaping of XML content and attribute values copying the spans not to escape in bulk
+/// \file xmlEscape.hpp
+#ifndef _STRUS_WIKIPEDIA_XML_ESCAPE_HPP_INCLUDED
+#define _STRUS_WIKIPEDIA_XML_ESCAPE_HPP_INCLUDED
+#include <string>
+#include <cstddef>
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Set of characters escaped and how
+enum XmlEscapeMode
+{
+	XmlEscapeContent,		///< content as escaped by the textwolf XML printer (<>& and backspace)
+	XmlEscapeAttributeValue,	///< attribute value as escaped by the textwolf XML printer (<>'"& and backspace, tab, newline, carriage return)
+	XmlEscapeText,			///< text in the side files (<>"&), bytes not decoded as UTF-8
+	XmlEscapeTextLine		///< text in the side files on one line (<>"&), control characters replaced by a space
+};
+
+/// \brief Append a string escaped for XML
+/// \note The output is identical to the output of the textwolf XML printer with UTF-8 as input and output character set for the modes XmlEscapeContent and XmlEscapeAttributeValue. Like the textwolf printer, the output is terminated at the first null character of the source.
+/// \param[in,out] buf buffer to append the result to
+/// \param[in] src pointer to the string to escape
+/// \param[in] size size of src in bytes
+/// \param[in] mode set of characters escaped
+void appendXmlEscaped( std::string& buf, const char* src, std::size_t size, XmlEscapeMode mode);
+
+}//namespace
+#endif
+
@@ -0,0 +1,13 @@
+# - Check the fields of a report written by strusWikimediaToXml (e.g. option --stats or --status) that do not depend on timing
+#   Every line of the file EXPECTED is a regular expression that has to match a part of the file INPUT.
+#   Usage: cmake -DINPUT=<report file> -DEXPECTED=<file with one expression per line> -P checkFields.cmake
+#
+
+file( READ ${INPUT} content )
+file( STRINGS ${EXPECTED} expressions )
+foreach( expression ${expressions} )
+  string( REGEX MATCH "${expression}" found "${content}" )
+  if ( NOT found )
+    message( FATAL_ERROR "no match of '${expression}' in ${INPUT}" )
+  endif ( NOT found )
+endforeach( expression )
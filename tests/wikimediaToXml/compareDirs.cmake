@@ -0,0 +1,18 @@
+# - Compare the files written by strusWikimediaToXml into two output directories
+#   The test fails if a file exists in one directory only or if the contents of a file differ.
+#   Usage: cmake -DOUTPUT=<directory> -DEXPECTED=<directory> -P compareDirs.cmake
+#
+
+file( GLOB_RECURSE outputFiles RELATIVE ${OUTPUT} ${OUTPUT}/* )
+file( GLOB_RECURSE expectedFiles RELATIVE ${EXPECTED} ${EXPECTED}/* )
+list( SORT outputFiles )
+list( SORT expectedFiles )
+if ( NOT "${outputFiles}" STREQUAL "${expectedFiles}" )
+  message( FATAL_ERROR "files in ${OUTPUT} differ from the files in ${EXPECTED}" )
+endif ( NOT "${outputFiles}" STREQUAL "${expectedFiles}" )
+foreach( filename ${outputFiles} )
+  execute_process( COMMAND ${CMAKE_COMMAND} -E compare_files ${OUTPUT}/${filename} ${EXPECTED}/${filename} RESULT_VARIABLE differ )
+  if ( differ )
+    message( FATAL_ERROR "content of ${OUTPUT}/${filename} differs from ${EXPECTED}/${filename}" )
+  endif ( differ )
+endforeach( filename )